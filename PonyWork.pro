@@ -12,6 +12,13 @@ INCLUDEPATH += $$PWD/modules/user
 SOURCES += main.cpp \
            mainwindow.cpp \
            modules/core/database.cpp \
+           modules/core/persistenceworker.cpp \
+           modules/core/storagecodec.cpp \
+           modules/core/searchindex.cpp \
+           modules/core/synclogstore.cpp \
+           modules/core/reportengine.cpp \
+           modules/core/reportexporter.cpp \
+           modules/core/aistreamparser.cpp \
            modules/core/aiconfig.cpp \
            modules/core/logger.cpp \
            modules/core/applicationmanager.cpp \
@@ -30,6 +37,7 @@ SOURCES += main.cpp \
            modules/widgets/appcollectionupdater.cpp \
            modules/widgets/cloud_login_impl.cpp \
            modules/widgets/worklogwidget.cpp \
+           modules/widgets/tasktablemodel.cpp \
            modules/widgets/syncconflictdialog.cpp \
            modules/widgets/synclogwidget.cpp \
            modules/widgets/bottomappbar.cpp \
@@ -47,6 +55,13 @@ SOURCES += main.cpp \
 
 HEADERS  += mainwindow.h \
             modules/core/database.h \
+            modules/core/persistenceworker.h \
+            modules/core/storagecodec.h \
+            modules/core/searchindex.h \
+            modules/core/synclogstore.h \
+            modules/core/reportengine.h \
+            modules/core/reportexporter.h \
+            modules/core/aistreamparser.h \
             modules/core/aiconfig.h \
             modules/core/logger.h \
             modules/core/applicationmanager.h \
@@ -64,6 +79,7 @@ HEADERS  += mainwindow.h \
             modules/widgets/snapshotmanagerwidget.h \
             modules/widgets/appcollectionupdater.h \
             modules/widgets/worklogwidget.h \
+            modules/widgets/tasktablemodel.h \
             modules/widgets/syncconflictdialog.h \
             modules/widgets/synclogwidget.h \
             modules/widgets/bottomappbar.h \
@@ -84,6 +100,15 @@ HEADERS  += mainwindow.h \
             modules/widgets/widgets_module.h \
             modules/dialogs/dialogs_module.h
 
+# 同步基准（--sync-benchmark）和其中的模拟云端服务只在 qmake CONFIG+=sync_benchmark 时编入，发布版本不包含
+sync_benchmark {
+    DEFINES += PONYWORK_SYNC_BENCHMARK
+    SOURCES += modules/user/mockcloudserver.cpp \
+               modules/user/syncbenchmark.cpp
+    HEADERS += modules/user/mockcloudserver.h \
+               modules/user/syncbenchmark.h
+}
+
 FORMS += modules/ui/appmanagerwidget.ui \
          modules/ui/shutdownwidget.ui \
          modules/ui/settingswidget.ui \
@@ -1,4 +1,8 @@
 #include "mainwindow.h"
+#include "modules/core/storagecodec.h"
+#ifdef PONYWORK_SYNC_BENCHMARK
+#include "modules/user/syncbenchmark.h"
+#endif
 #include <QApplication>
 #include <QTextCodec>
 #include <QIcon>
@@ -9,6 +13,32 @@ int main(int argc, char *argv[])
     a.setApplicationName("小马办公");
     a.setOrganizationName("PonyWork");
     a.setApplicationVersion("1.0.2");
+
+    // 调试用：PonyWork --dump-storage <数据文件> [输出文件]，把二进制数据文件转成缩进 JSON
+    QStringList args = a.arguments();
+    int dumpIndex = args.indexOf("--dump-storage");
+    if (dumpIndex >= 0 && dumpIndex + 1 < args.size()) {
+        QString inputPath = args.at(dumpIndex + 1);
+        QString outputPath = dumpIndex + 2 < args.size() ? args.at(dumpIndex + 2) : inputPath + ".dump.json";
+        QString error;
+        if (!StorageCodec::dumpToJson(inputPath, outputPath, &error)) {
+            qWarning("Dump failed: %s", qPrintable(error));
+            return 1;
+        }
+        return 0;
+    }
+
+#ifdef PONYWORK_SYNC_BENCHMARK
+    // 调试用：PonyWork --sync-benchmark [--tasks 1000,10000,100000] [--profile local|lan|broadband|mobile|lossy]
+    //         [--output 结果.json] [--baseline 上次结果.json] [--tolerance 0.25]
+    // 在进程内模拟云端服务，测量同步耗时和传输量；有步骤失败或超出基线时返回 1。需要以 CONFIG+=sync_benchmark 构建
+    if (args.contains("--sync-benchmark")) {
+        // 使用单独的设置，登录状态等不写入正常使用的配置
+        a.setOrganizationName("PonyWorkBenchmark");
+        SyncBenchmark benchmark;
+        return benchmark.run(SyncBenchmark::parseArguments(args));
+    }
+#endif
     
     QIcon appIcon(":/img/icon.png");
     a.setWindowIcon(appIcon);
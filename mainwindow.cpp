@@ -14,6 +14,7 @@
 #include "modules/update/updateprogressdialog.h"
 #include "modules/widgets/remotedesktopwidget.h"
 #include "modules/core/frpcmanager.h"
+#include "modules/core/networkmonitor.h"
 #include <QApplication>
 #include <QStyle>
 #include <QStandardPaths>
@@ -28,6 +29,7 @@
 #include <QFile>
 #include <QRegExp>
 #include <QDebug>
+#include <QFileInfo>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -217,6 +219,12 @@ void MainWindow::setupUI()
     
     // 连接应用数据变化信号到底部快捷应用栏
     connect(db, &Database::appsChanged, bottomAppBar, &BottomAppBar::refreshApps);
+
+    // 后台保存失败时提示用户，数据仍在内存中，下次保存会重试
+    connect(db, &Database::saveFailed, this, [this](const QString &filePath, const QString &error) {
+        qWarning() << "[MainWindow] Save failed:" << filePath << error;
+        showStatusMessage(QString("数据保存失败: %1").arg(QFileInfo(filePath).fileName()), 5000);
+    });
     
     // 初始化动画指针
     m_bottomAppBarAnimation = nullptr;
@@ -255,12 +263,23 @@ void MainWindow::setupUI()
 
     statusBarLayout->addWidget(statusLabel);
 
+    // 待同步的任务修改数，没有待同步内容时隐藏
+    syncQueueLabel = new QLabel(this);
+    syncQueueLabel->setStyleSheet("color: #e67e22; font-size: 12px;");
+    syncQueueLabel->setToolTip("尚未上传到云端的工作日志修改，联网后自动同步");
+    syncQueueLabel->hide();
+    statusBarLayout->addWidget(syncQueueLabel);
+
     // 用户菜单组件
     userMenuWidget = new UserMenuWidget(this);
     userMenuWidget->setDatabase(db);
 
     // 连接用户菜单信号
     connect(userMenuWidget, &UserMenuWidget::statusMessageRequested, this, &MainWindow::showStatusMessage);
+    connect(userMenuWidget, &UserMenuWidget::syncQueueDepthChanged, this, [this](int depth) {
+        syncQueueLabel->setText(QString("待同步 %1 项").arg(depth));
+        syncQueueLabel->setVisible(depth > 0);
+    });
     connect(userMenuWidget, &UserMenuWidget::showBackupVersionsDialogRequested, this, [=]() {
         userWidget->showBackupVersionsDialog();
     });
@@ -503,6 +522,7 @@ void MainWindow::onExitApp()
         FRPCManager::instance()->detachProcess();
     }
 
+    db->flush();
     QApplication::quit();
 }
 
@@ -521,6 +541,10 @@ bool MainWindow::nativeEvent(const QByteArray &eventType, void *message, long *r
             return true;
         }
     }
+    // 从睡眠恢复后网络状态可能已经变化，不等离线退避结束
+    if (msg->message == WM_POWERBROADCAST && msg->wParam == PBT_APMRESUMEAUTOMATIC) {
+        NetworkMonitor::instance()->notifyNetworkChanged();
+    }
     return false;
 }
 #endif
@@ -671,16 +695,10 @@ void MainWindow::closeEvent(QCloseEvent *event)
             event->ignore();
         } else {
             shouldStopFRPC = true;
-            // 直接退出时保存并上传任务数据
-            if (UserManager::instance()->isLoggedIn()) {
-                db->saveTaskData();
-                QList<Task> tasks = db->getAllTasks();
-                QJsonArray tasksArray;
-                for (const Task &task : tasks) {
-                    tasksArray.append(db->taskToJson(task));
-                }
-                TaskSync::instance()->uploadTasks(tasksArray);
-            }
+            // 直接退出时保存任务数据；未上传的修改按版本号记录在本地，下次启动后增量上传
+            db->saveTaskData();
+            // 等待后台线程写完所有数据再退出
+            db->flush();
             event->accept();
         }
         return;
@@ -740,16 +758,10 @@ void MainWindow::closeEvent(QCloseEvent *event)
                 db->setShowClosePrompt(false);
             }
             shouldStopFRPC = true;
-            // 保存并上传当前用户任务数据
-            if (UserManager::instance()->isLoggedIn()) {
-                db->saveTaskData();
-                QList<Task> tasks = db->getAllTasks();
-                QJsonArray tasksArray;
-                for (const Task &task : tasks) {
-                    tasksArray.append(db->taskToJson(task));
-                }
-                TaskSync::instance()->uploadTasks(tasksArray);
-            }
+            // 保存当前用户任务数据；未上传的修改按版本号记录在本地，下次启动后增量上传
+            db->saveTaskData();
+            // 等待后台线程写完所有数据再退出
+            db->flush();
             event->accept();
         } else {
             event->ignore();
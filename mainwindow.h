@@ -116,6 +116,7 @@ private:
     QPropertyAnimation *m_bottomAppBarAnimation;
     BottomAppBar *bottomAppBar;
     QLabel *statusLabel;
+    QLabel *syncQueueLabel;
     QTimer *statusTimer;
     QString m_defaultStatusText;
     class UserMenuWidget *userMenuWidget;
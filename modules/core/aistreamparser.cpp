@@ -0,0 +1,179 @@
+#include "aistreamparser.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+AIStreamParser::AIStreamParser()
+    : mode(Unknown)
+    , payloadCount(0)
+    , done(false)
+{
+}
+
+QString AIStreamParser::feed(const QByteArray &data)
+{
+    raw.append(data);
+    buffer.append(data);
+
+    // 第一个非空白字符是 { 或 [ 说明服务端没有按流式返回
+    if (mode == Unknown) {
+        for (char c : buffer) {
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                continue;
+            }
+            mode = (c == '{' || c == '[') ? PlainJson : EventStream;
+            break;
+        }
+    }
+
+    if (mode != EventStream) {
+        return QString();
+    }
+    return takeLines();
+}
+
+QString AIStreamParser::finish()
+{
+    if (mode == EventStream) {
+        QString delta;
+        if (!buffer.isEmpty()) {
+            buffer.append('\n');
+            delta = takeLines();
+        }
+        return delta + dispatchEvent();
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(buffer);
+    buffer.clear();
+    if (!doc.isObject()) {
+        return QString();
+    }
+    payloadCount++;
+    done = true;
+    return handlePayload(doc.object(), false);
+}
+
+// 处理缓冲区中所有完整的行，空行表示一个事件结束
+QString AIStreamParser::takeLines()
+{
+    QString delta;
+    int start = 0;
+    int end;
+    while ((end = buffer.indexOf('\n', start)) >= 0) {
+        QByteArray line = buffer.mid(start, end - start);
+        start = end + 1;
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        if (line.isEmpty()) {
+            delta += dispatchEvent();
+            continue;
+        }
+        if (line.startsWith(':')) {
+            continue;
+        }
+
+        // 只关心 data 字段；event、id 等字段忽略，错误事件的内容同样在 data 中
+        int colon = line.indexOf(':');
+        if (colon < 0 || line.left(colon) != "data") {
+            continue;
+        }
+        QByteArray value = line.mid(colon + 1);
+        if (value.startsWith(' ')) {
+            value.remove(0, 1);
+        }
+        if (!eventData.isEmpty()) {
+            eventData.append('\n');
+        }
+        eventData.append(value);
+    }
+    buffer.remove(0, start);
+    return delta;
+}
+
+QString AIStreamParser::dispatchEvent()
+{
+    if (eventData.isEmpty()) {
+        return QString();
+    }
+    QByteArray data = eventData.trimmed();
+    eventData.clear();
+
+    if (data == "[DONE]") {
+        done = true;
+        return QString();
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (!doc.isObject()) {
+        qWarning("Cannot parse AI stream event: %s", qPrintable(parseError.errorString()));
+        return QString();
+    }
+    payloadCount++;
+    return handlePayload(doc.object(), true);
+}
+
+QString AIStreamParser::handlePayload(const QJsonObject &obj, bool streaming)
+{
+    if (obj.contains("error")) {
+        QJsonValue value = obj["error"];
+        error = value.isObject() ? value.toObject()["message"].toString() : value.toString();
+        if (error.isEmpty()) {
+            error = QString::fromUtf8(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        }
+        return QString();
+    }
+    if (obj.contains("base_resp") && obj["base_resp"].toObject()["status_code"].toInt() != 0) {
+        error = obj["base_resp"].toObject()["status_msg"].toString();
+        return QString();
+    }
+    // DashScope 的错误只有 code 和 message
+    if (obj.contains("code") && !obj.contains("output") && !obj.contains("choices")
+        && !obj["code"].toString().isEmpty()) {
+        error = obj["message"].toString();
+        if (error.isEmpty()) {
+            error = obj["code"].toString();
+        }
+        return QString();
+    }
+
+    QString text;
+    QString finishReason;
+    if (obj.contains("output")) {
+        // 通义千问：请求时设置了 incremental_output，每个事件只包含新增的部分
+        QJsonObject output = obj["output"].toObject();
+        QJsonArray choices = output["choices"].toArray();
+        if (!choices.isEmpty()) {
+            QJsonObject choice = choices.first().toObject();
+            text = choice["message"].toObject()["content"].toString();
+            finishReason = choice["finish_reason"].toString();
+        } else {
+            text = output["text"].toString();
+            finishReason = output["finish_reason"].toString();
+        }
+    } else {
+        QJsonArray choices = obj["choices"].toArray();
+        if (choices.isEmpty()) {
+            return QString();
+        }
+        QJsonObject choice = choices.first().toObject();
+        finishReason = choice["finish_reason"].toString();
+        if (streaming && choice.contains("delta")) {
+            text = choice["delta"].toObject()["content"].toString();
+        } else {
+            // 非流式响应，或部分接口在最后一个事件中给出完整内容：只取尚未收到的部分
+            QString message = choice["message"].toObject()["content"].toString();
+            if (message.startsWith(content)) {
+                text = message.mid(content.length());
+            }
+        }
+    }
+
+    if (!finishReason.isEmpty() && finishReason != "null") {
+        done = true;
+    }
+    content.append(text);
+    return text;
+}
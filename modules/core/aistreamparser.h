@@ -0,0 +1,52 @@
+#ifndef AISTREAMPARSER_H
+#define AISTREAMPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QJsonObject>
+
+// AI 接口流式响应（SSE）的增量解析。按 QNetworkReply::readyRead 收到的数据块调用 feed，
+// 数据块可以在任意字节处断开，返回本次新增的文本。支持两种格式：
+//   OpenAI 兼容接口（OpenAI、DeepSeek/硅基流动、智谱、MiniMax 等）："data: {"choices":[{"delta":{"content":...}}]}"，以 "data: [DONE]" 结束
+//   通义千问 DashScope（incremental_output=true）："data:{"output":{"choices":[{"message":{"content":...}}]}}"
+// 服务端不支持流式、直接返回整个 JSON 时，在 finish 中按普通响应解析
+class AIStreamParser
+{
+public:
+    AIStreamParser();
+
+    QString feed(const QByteArray &data);
+    // 响应结束时调用，处理缓冲区中剩余的数据
+    QString finish();
+
+    QString text() const { return content; }
+    // 接口在响应中返回的错误信息，没有错误时为空
+    QString errorString() const { return error; }
+    // 是否解析到了至少一个有效的 JSON
+    bool hasPayload() const { return payloadCount > 0; }
+    bool isDone() const { return done; }
+    // 收到的原始数据，用于写日志
+    QByteArray rawData() const { return raw; }
+
+private:
+    enum Mode {
+        Unknown,
+        EventStream,
+        PlainJson
+    };
+
+    QString takeLines();
+    QString dispatchEvent();
+    QString handlePayload(const QJsonObject &obj, bool streaming);
+
+    Mode mode;
+    QByteArray raw;
+    QByteArray buffer;          // 尚未处理的不完整行（EventStream）或整个响应（PlainJson）
+    QByteArray eventData;       // 当前事件已收到的 data 行
+    QString content;
+    QString error;
+    int payloadCount;
+    bool done;
+};
+
+#endif // AISTREAMPARSER_H
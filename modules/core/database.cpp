@@ -1,26 +1,102 @@
 #include "database.h"
+#include "persistenceworker.h"
 #include <QDir>
 #include <QStandardPaths>
 #include <QSettings>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QHostInfo>
+#include <QTimer>
 #include <algorithm>
 
-#ifdef QT_DEBUG
-static void runTaskFilterTests();
-#endif
+// 日志累计到一定条数后立即合并，否则在空闲一段时间后合并
+#define JOURNAL_MAX_RECORDS 200
+#define JOURNAL_IDLE_COMPACT_MS 30000
+
+// 日志操作：put/del 按 id 更新数组中的元素，set/unset 替换或移除顶层字段
+static QJsonObject journalPut(const QString &section, const QJsonObject &value)
+{
+    QJsonObject op;
+    op["o"] = "put";
+    op["s"] = section;
+    op["v"] = value;
+    return op;
+}
+
+static QJsonObject journalDel(const QString &section, int id)
+{
+    QJsonObject op;
+    op["o"] = "del";
+    op["s"] = section;
+    op["id"] = id;
+    return op;
+}
+
+static QJsonObject journalSet(const QString &key, const QJsonValue &value)
+{
+    QJsonObject op;
+    op["o"] = "set";
+    op["k"] = key;
+    op["v"] = value;
+    return op;
+}
+
+static QJsonObject journalUnset(const QString &key)
+{
+    QJsonObject op;
+    op["o"] = "unset";
+    op["k"] = key;
+    return op;
+}
 
 Database::Database(QObject *parent) : QObject(parent)
 {
     nextAppId = 1;
     nextCollectionId = 1;
     nextRemoteDesktopId = 1;
+    nextSnapshotId = 1;
     currentUserId = 0;
+
+    storageFormat = StorageCodec::Json;
+    journalSeq = 0;
+    journalRecordCount = 0;
+    journalEnabled = true;
+    compactTimer = new QTimer(this);
+    compactTimer->setSingleShot(true);
+    compactTimer->setInterval(JOURNAL_IDLE_COMPACT_MS);
+    connect(compactTimer, &QTimer::timeout, this, &Database::compactJournal);
+
+    // 快照与任务文件在后台线程写入，界面线程只负责生成快照
+    persistenceWorker = new PersistenceWorker(this);
+    connect(persistenceWorker, &PersistenceWorker::writeFinished, this, &Database::onPersistenceWriteFinished);
+    connect(persistenceWorker, &PersistenceWorker::writeFailed, this, &Database::saveFailed);
+    persistenceWorker->start();
+
+    dataSearchIndexValid = false;
+    taskSyncBasesDirty = false;
+
+    batchDepth = 0;
+    resetBatchState();
 }
 
 Database::~Database()
 {
+    // 退出前把日志合并进快照，下次启动无需回放
+    flush();
+    persistenceWorker->stop();
+}
+
+bool Database::flush()
+{
+    if (journalRecordCount > 0 && batchDepth == 0) {
+        saveData();
+    }
+
+    bool ok = persistenceWorker->flush();
+
+    // 写入完成的通知是排队投递的，这里立即处理，保证返回时日志已截断
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    return ok;
 }
 
 bool Database::init()
@@ -31,8 +107,13 @@ bool Database::init()
         dir.mkpath(".");
     }
 
-    dataFilePath = dataPath + "/data.json";
-    taskFilePath = dataPath + "/tasks.json";
+    QSettings settings;
+    storageFormat = StorageCodec::formatFromName(settings.value("storage/format", "json").toString());
+
+    dataFilePath = dataPath + "/data" + StorageCodec::suffix(storageFormat);
+    taskFilePath = dataPath + "/tasks" + StorageCodec::suffix(storageFormat);
+    // 日志本身是逐行 JSON，与快照格式无关，文件名保持不变
+    journalFilePath = dataPath + "/data.json.journal";
 
     if (!loadData()) {
         rootObject = QJsonObject();
@@ -61,20 +142,36 @@ bool Database::init()
 
 bool Database::loadData()
 {
-    QFile file(dataFilePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return false;
+    // 快照损坏或丢失时（如合并过程中崩溃），退回到上一次的备份快照，
+    // 日志中记录的是自上次合并以来的全部变更，回放后即可恢复到最新状态。
+    // 当前格式的文件不存在时读取另一种格式的文件，加载后按当前格式重写完成迁移
+    dataSearchIndexValid = false;
+
+    QString legacyFilePath = StorageCodec::counterpartPath(dataFilePath);
+    const QStringList candidates = { dataFilePath, dataFilePath + ".bak",
+                                     legacyFilePath, legacyFilePath + ".bak" };
+    QString loadedPath;
+    for (const QString &path : candidates) {
+        if (readStorageFile(path, &rootObject)) {
+            loadedPath = path;
+            break;
+        }
     }
-    
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) {
+
+    if (loadedPath.isEmpty()) {
         return false;
     }
-    
-    rootObject = doc.object();
+    if (loadedPath != dataFilePath) {
+        qWarning("Data file unavailable, loaded from: %s", qPrintable(loadedPath));
+    }
+
+    qint64 baseSeq = static_cast<qint64>(rootObject["journalSeq"].toDouble());
+    int replayed = replayJournal(baseSeq);
+    if (replayed > 0) {
+        qDebug() << "[Database] Replayed" << replayed << "journal records";
+        compactTimer->start();
+    }
+
     nextAppId = rootObject["nextAppId"].toInt(1);
     nextCollectionId = rootObject["nextCollectionId"].toInt(1);
     nextRemoteDesktopId = rootObject["nextRemoteDesktopId"].toInt(1);
@@ -88,64 +185,514 @@ bool Database::loadData()
         rootObject["tasks"] = QJsonArray();
     }
 
+    if (loadedPath.startsWith(legacyFilePath)) {
+        saveData();
+    }
+
+    return true;
+}
+
+bool Database::readStorageFile(const QString &filePath, QJsonObject *object)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    QString error;
+    if (!StorageCodec::decode(data, object, &error)) {
+        qWarning("Cannot parse %s: %s", qPrintable(filePath), qPrintable(error));
+        return false;
+    }
     return true;
 }
 
+void Database::setStorageFormat(StorageCodec::Format format)
+{
+    if (format == storageFormat) {
+        return;
+    }
+
+    // 先写完旧格式的待保存内容，避免旧路径的写入完成后误删新格式文件
+    flush();
+
+    QSettings settings;
+    settings.setValue("storage/format", StorageCodec::formatName(format));
+
+    // 分段文件需要在切换前按旧格式全部读入，再全部按新格式写出
+    ensureAllTaskSegments();
+    for (TaskSegment &segment : taskSegments) {
+        segment.dirty = true;
+    }
+    taskSyncBasesDirty = true;
+
+    storageFormat = format;
+    dataFilePath = StorageCodec::counterpartPath(dataFilePath);
+    taskFilePath = StorageCodec::counterpartPath(taskFilePath);
+
+    saveData();
+    saveTaskData();
+}
+
 bool Database::saveData()
 {
     rootObject["nextAppId"] = nextAppId;
     rootObject["nextCollectionId"] = nextCollectionId;
     rootObject["nextRemoteDesktopId"] = nextRemoteDesktopId;
     rootObject["nextSnapshotId"] = nextSnapshotId;
+    rootObject["journalSeq"] = static_cast<double>(journalSeq);
 
-    QJsonDocument doc(rootObject);
+    // 快照写入后台队列，写完后再截断日志；写入失败时日志仍保留全部变更
+    persistenceWorker->enqueue(dataFilePath, rootObject, storageFormat, journalSeq);
+    journalRecordCount = 0;
+    compactTimer->stop();
 
-    // 原子写入：先写临时文件，再重命名
-    QString tempFilePath = dataFilePath + ".tmp";
-    QFile tempFile(tempFilePath);
-    if (!tempFile.open(QIODevice::WriteOnly)) {
-        qWarning("Cannot create temp file: %s", qPrintable(tempFile.errorString()));
-        return false;
+    return true;
+}
+
+static SearchIndex::Fields snapshotSearchFields(const QJsonObject &obj)
+{
+    return { { obj["name"].toString(), 3 }, { obj["tags"].toString(), 2 },
+             { obj["description"].toString(), 1 }, { obj["path"].toString(), 1 } };
+}
+
+static SearchIndex::Fields remoteDesktopSearchFields(const QJsonObject &obj)
+{
+    return { { obj["name"].toString(), 3 }, { obj["hostAddress"].toString(), 2 },
+             { obj["username"].toString(), 2 }, { obj["category"].toString(), 1 },
+             { obj["notes"].toString(), 1 } };
+}
+
+void Database::updateDataSearchIndex(const QJsonArray &ops)
+{
+    if (!dataSearchIndexValid) {
+        return;
+    }
+
+    for (const QJsonValue &val : ops) {
+        QJsonObject op = val.toObject();
+        QString type = op["o"].toString();
+        QString section = (type == "put" || type == "del") ? op["s"].toString() : op["k"].toString();
+
+        SearchIndex *index = nullptr;
+        SearchIndex::Fields (*fields)(const QJsonObject &) = nullptr;
+        if (section == "snapshots") {
+            index = &snapshotSearchIndex;
+            fields = snapshotSearchFields;
+        } else if (section == "remoteDesktops") {
+            index = &remoteDesktopSearchIndex;
+            fields = remoteDesktopSearchFields;
+        } else {
+            continue;
+        }
+
+        if (type == "put") {
+            QJsonObject obj = op["v"].toObject();
+            index->setDocument(QString::number(obj["id"].toInt()), fields(obj));
+        } else if (type == "del") {
+            index->removeDocument(QString::number(op["id"].toInt()));
+        } else {
+            // 整个列表被替换，下次搜索时重建
+            dataSearchIndexValid = false;
+            return;
+        }
+    }
+}
+
+void Database::rebuildDataSearchIndex()
+{
+    snapshotSearchIndex.clear();
+    for (const QJsonValue &val : rootObject["snapshots"].toArray()) {
+        QJsonObject obj = val.toObject();
+        snapshotSearchIndex.setDocument(QString::number(obj["id"].toInt()), snapshotSearchFields(obj));
+    }
+
+    remoteDesktopSearchIndex.clear();
+    for (const QJsonValue &val : rootObject["remoteDesktops"].toArray()) {
+        QJsonObject obj = val.toObject();
+        remoteDesktopSearchIndex.setDocument(QString::number(obj["id"].toInt()), remoteDesktopSearchFields(obj));
+    }
+
+    dataSearchIndexValid = true;
+}
+
+void Database::onPersistenceWriteFinished(const QString &filePath, qint64 tag)
+{
+    if (filePath == dataFilePath) {
+        trimJournal(tag);
+    }
+
+    // 新格式文件已写入，删除迁移前的旧格式文件
+    if (filePath.endsWith(StorageCodec::suffix(storageFormat))) {
+        QString legacyFilePath = StorageCodec::counterpartPath(filePath);
+        if (QFile::exists(legacyFilePath)) {
+            QFile::remove(legacyFilePath);
+            QFile::remove(legacyFilePath + ".bak");
+        }
+    }
+}
+
+void Database::trimJournal(qint64 compactedSeq)
+{
+    if (compactedSeq >= journalSeq) {
+        QFile::remove(journalFilePath);
+        return;
+    }
+
+    // 快照写出期间又有新记录追加，只保留快照之后的部分
+    QFile file(journalFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
     }
+    QByteArray kept;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        QJsonObject record = QJsonDocument::fromJson(line).object();
+        if (static_cast<qint64>(record["seq"].toDouble()) > compactedSeq) {
+            kept.append(line);
+        }
+    }
+    file.close();
 
-    if (tempFile.write(doc.toJson(QJsonDocument::Indented)) == -1) {
-        qWarning("Failed to write temp file: %s", qPrintable(tempFile.errorString()));
+    QString tempFilePath = journalFilePath + ".tmp";
+    QFile tempFile(tempFilePath);
+    if (!tempFile.open(QIODevice::WriteOnly) || tempFile.write(kept) != kept.size()) {
+        qWarning("Failed to trim journal: %s", qPrintable(tempFile.errorString()));
         tempFile.close();
         QFile::remove(tempFilePath);
-        return false;
+        return;
     }
     tempFile.close();
 
-    // 先备份原文件
-    QString backupFilePath = dataFilePath + ".bak";
-    if (QFile::exists(dataFilePath)) {
-        QFile::remove(backupFilePath);
-        if (!QFile::copy(dataFilePath, backupFilePath)) {
-            qWarning("Failed to create backup, continuing anyway...");
+    QFile::remove(journalFilePath);
+    if (!QFile::rename(tempFilePath, journalFilePath)) {
+        qWarning("Failed to replace journal file: %s", qPrintable(tempFilePath));
+    }
+}
+
+bool Database::commitData(const QJsonArray &ops)
+{
+    if (ops.isEmpty()) {
+        return true;
+    }
+
+    updateDataSearchIndex(ops);
+
+    // 批量修改期间只收集操作，提交时作为一条日志记录整体写入
+    if (batchDepth > 0) {
+        for (const QJsonValue &op : ops) {
+            batchOps.append(op);
+        }
+        return true;
+    }
+
+    if (!journalEnabled) {
+        return saveData();
+    }
+
+    // 日志写入失败时退回到整文件写入，保证数据不丢失
+    if (!appendJournal(ops)) {
+        return saveData();
+    }
+
+    if (journalRecordCount >= JOURNAL_MAX_RECORDS) {
+        compactTimer->start(0);
+    } else {
+        compactTimer->start(JOURNAL_IDLE_COMPACT_MS);
+    }
+    return true;
+}
+
+bool Database::appendJournal(const QJsonArray &ops)
+{
+    QFile file(journalFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning("Cannot open journal file: %s", qPrintable(file.errorString()));
+        return false;
+    }
+
+    QJsonObject record;
+    record["seq"] = static_cast<double>(journalSeq + 1);
+    record["ops"] = ops;
+
+    // 每条记录占一行，回放时不完整的末行会被丢弃
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+
+    bool ok = file.write(line) == line.size() && file.flush();
+    file.close();
+    if (!ok) {
+        qWarning("Failed to append journal record: %s", qPrintable(file.errorString()));
+        return false;
+    }
+
+    journalSeq++;
+    journalRecordCount++;
+    return true;
+}
+
+int Database::replayJournal(qint64 baseSeq)
+{
+    journalSeq = baseSeq;
+    journalRecordCount = 0;
+
+    QFile file(journalFilePath);
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+        return 0;
+    }
+
+    int count = 0;
+    qint64 validSize = 0;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (!line.endsWith('\n')) {
+            break;
+        }
+
+        QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (!doc.isObject()) {
+            break;
+        }
+
+        // 已包含在快照中的记录（快照写完但日志尚未截断时崩溃）直接跳过
+        QJsonObject record = doc.object();
+        qint64 seq = static_cast<qint64>(record["seq"].toDouble());
+        if (seq > baseSeq) {
+            QJsonArray ops = record["ops"].toArray();
+            for (const QJsonValue &val : ops) {
+                applyJournalOp(val.toObject());
+            }
+            journalSeq = qMax(journalSeq, seq);
+            count++;
         }
+        validSize = file.pos();
     }
 
-    // 先删除已存在的目标文件（Windows上rename不能覆盖已存在的文件）
-    if (QFile::exists(dataFilePath)) {
-        QFile::remove(dataFilePath);
+    // 截掉崩溃时写了一半的记录，避免之后追加的记录被它挡住
+    if (validSize < file.size()) {
+        qWarning("Discarding %lld bytes of torn journal tail",
+                 static_cast<long long>(file.size() - validSize));
+        file.resize(validSize);
     }
+    file.close();
+
+    journalRecordCount = count;
+    return count;
+}
+
+void Database::applyJournalOp(const QJsonObject &op)
+{
+    QString type = op["o"].toString();
+
+    if (type == "put" || type == "del") {
+        QString section = op["s"].toString();
+        QJsonArray array = rootObject[section].toArray();
+        QJsonObject value = op["v"].toObject();
+        int id = (type == "put") ? value["id"].toInt() : op["id"].toInt();
 
-    // 重命名临时文件为目标文件
-    if (!QFile::rename(tempFilePath, dataFilePath)) {
-        qWarning("Failed to rename temp file: %s", qPrintable(tempFile.errorString()));
-        // 尝试恢复备份
-        if (QFile::exists(backupFilePath) && !QFile::exists(dataFilePath)) {
-            QFile::copy(backupFilePath, dataFilePath);
+        bool found = false;
+        for (int i = 0; i < array.size(); ++i) {
+            if (array[i].toObject()["id"].toInt() == id) {
+                if (type == "put") {
+                    array[i] = value;
+                } else {
+                    array.removeAt(i);
+                }
+                found = true;
+                break;
+            }
         }
+        if (!found && type == "put") {
+            array.append(value);
+        }
+        rootObject[section] = array;
+    } else if (type == "set") {
+        rootObject[op["k"].toString()] = op["v"];
+    } else if (type == "unset") {
+        rootObject.remove(op["k"].toString());
+    }
+}
+
+void Database::compactJournal()
+{
+    if (journalRecordCount > 0 && batchDepth == 0) {
+        saveData();
+    }
+}
+
+void Database::beginBatch()
+{
+    if (batchDepth++ > 0) {
+        return;
+    }
+
+    resetBatchState();
+    // Qt 容器为隐式共享，这里的快照在批量修改真正写入前不会产生深拷贝
+    batchDataSnapshot = takeDataSnapshot();
+    batchTaskSnapshot = takeTaskSnapshot();
+}
+
+bool Database::commitBatch()
+{
+    if (batchDepth == 0) {
+        qWarning("commitBatch() called without beginBatch()");
+        return false;
+    }
+
+    if (--batchDepth > 0) {
+        return !batchAborted;
+    }
+
+    if (batchAborted) {
+        restoreDataSnapshot(batchDataSnapshot);
+        restoreTaskSnapshot(batchTaskSnapshot);
+        resetBatchState();
         return false;
     }
 
-    // 写入成功后删除备份
-    QFile::remove(backupFilePath);
+    QJsonArray ops = batchOps;
+    bool tasksDirty = batchTasksDirty;
+    bool appsChanged = batchAppsChanged;
+    bool tasksChanged = batchTasksChanged;
+    resetBatchState();
+
+    // 文件在后台线程写入，写入失败时通过 saveFailed 通知，内存中的修改保留，下次保存时重写
+    commitData(ops);
+    if (tasksDirty) {
+        saveTaskData();
+    }
+
+    if (appsChanged) {
+        emit this->appsChanged();
+    }
+    if (tasksChanged) {
+        emit tasksReset();
+        emit this->tasksChanged();
+    }
 
     return true;
 }
 
+void Database::rollbackBatch()
+{
+    if (batchDepth == 0) {
+        return;
+    }
+
+    restoreDataSnapshot(batchDataSnapshot);
+    restoreTaskSnapshot(batchTaskSnapshot);
+
+    // 内层回滚使整个批量失效，外层提交时返回失败
+    if (--batchDepth > 0) {
+        batchAborted = true;
+        batchOps = QJsonArray();
+        batchTasksDirty = false;
+        return;
+    }
+
+    resetBatchState();
+}
+
+void Database::resetBatchState()
+{
+    batchAborted = false;
+    batchTasksDirty = false;
+    batchAppsChanged = false;
+    batchTasksChanged = false;
+    batchOps = QJsonArray();
+    batchDataSnapshot = DataSnapshot();
+    batchTaskSnapshot = TaskSnapshot();
+}
+
+Database::DataSnapshot Database::takeDataSnapshot() const
+{
+    DataSnapshot snapshot;
+    snapshot.rootObject = rootObject;
+    snapshot.nextAppId = nextAppId;
+    snapshot.nextCollectionId = nextCollectionId;
+    snapshot.nextRemoteDesktopId = nextRemoteDesktopId;
+    snapshot.nextSnapshotId = nextSnapshotId;
+    return snapshot;
+}
+
+void Database::restoreDataSnapshot(const DataSnapshot &snapshot)
+{
+    rootObject = snapshot.rootObject;
+    nextAppId = snapshot.nextAppId;
+    nextCollectionId = snapshot.nextCollectionId;
+    nextRemoteDesktopId = snapshot.nextRemoteDesktopId;
+    nextSnapshotId = snapshot.nextSnapshotId;
+    dataSearchIndexValid = false;
+}
+
+Database::TaskSnapshot Database::takeTaskSnapshot() const
+{
+    TaskSnapshot snapshot;
+    snapshot.taskRootObject = taskRootObject;
+    snapshot.taskStore = taskStore;
+    snapshot.taskIndex = taskIndex;
+    snapshot.tasksByDay = tasksByDay;
+    snapshot.finishedTasksByDay = finishedTasksByDay;
+    snapshot.openTaskIds = openTaskIds;
+    snapshot.overallTaskStats = overallTaskStats;
+    snapshot.statsByCreatedDay = statsByCreatedDay;
+    snapshot.statsByFinishedDay = statsByFinishedDay;
+    snapshot.taskSegments = taskSegments;
+    snapshot.taskSearchIndex = taskSearchIndex;
+    snapshot.taskIdSequences = taskIdSequences;
+    snapshot.taskIdsByVersion = taskIdsByVersion;
+    snapshot.taskTombstones = taskTombstones;
+    snapshot.taskSyncBases = taskSyncBases;
+    snapshot.taskSyncBasesDirty = taskSyncBasesDirty;
+    return snapshot;
+}
+
+void Database::restoreTaskSnapshot(const TaskSnapshot &snapshot)
+{
+    taskRootObject = snapshot.taskRootObject;
+    taskStore = snapshot.taskStore;
+    taskIndex = snapshot.taskIndex;
+    tasksByDay = snapshot.tasksByDay;
+    finishedTasksByDay = snapshot.finishedTasksByDay;
+    openTaskIds = snapshot.openTaskIds;
+    overallTaskStats = snapshot.overallTaskStats;
+    statsByCreatedDay = snapshot.statsByCreatedDay;
+    statsByFinishedDay = snapshot.statsByFinishedDay;
+    taskSegments = snapshot.taskSegments;
+    taskSearchIndex = snapshot.taskSearchIndex;
+    taskIdSequences = snapshot.taskIdSequences;
+    taskIdsByVersion = snapshot.taskIdsByVersion;
+    taskTombstones = snapshot.taskTombstones;
+    taskSyncBases = snapshot.taskSyncBases;
+    taskSyncBasesDirty = snapshot.taskSyncBasesDirty;
+}
+
+void Database::notifyAppsChanged()
+{
+    if (batchDepth > 0) {
+        batchAppsChanged = true;
+    } else {
+        emit appsChanged();
+    }
+}
+
+void Database::notifyTasksChanged(const QString &id)
+{
+    if (batchDepth > 0) {
+        // 批量修改可能回滚，提交时统一按整体刷新通知
+        batchTasksChanged = true;
+    } else {
+        if (id.isEmpty()) {
+            emit tasksReset();
+        } else {
+            emit taskChanged(id);
+        }
+        emit tasksChanged();
+    }
+}
+
 QJsonObject Database::appToJson(const AppInfo &app)
 {
     QJsonObject obj;
@@ -258,14 +805,15 @@ bool Database::addApp(const AppInfo &app)
 {
     AppInfo newApp = app;
     newApp.id = nextAppId++;
+    QJsonObject appObj = appToJson(newApp);
     
     QJsonArray appsArray = rootObject["apps"].toArray();
-    appsArray.append(appToJson(newApp));
+    appsArray.append(appObj);
     rootObject["apps"] = appsArray;
     
-    bool result = saveData();
+    bool result = commitData({ journalPut("apps", appObj), journalSet("nextAppId", nextAppId) });
     if (result) {
-        emit appsChanged();
+        notifyAppsChanged();
     }
     return result;
 }
@@ -273,19 +821,21 @@ bool Database::addApp(const AppInfo &app)
 bool Database::updateApp(const AppInfo &app)
 {
     QJsonArray appsArray = rootObject["apps"].toArray();
+    QJsonArray ops;
     
     for (int i = 0; i < appsArray.size(); ++i) {
         if (appsArray[i].toObject()["id"].toInt() == app.id) {
             appsArray[i] = appToJson(app);
+            ops.append(journalPut("apps", appsArray[i].toObject()));
             break;
         }
     }
     
     rootObject["apps"] = appsArray;
     
-    bool result = saveData();
+    bool result = commitData(ops);
     if (result) {
-        emit appsChanged();
+        notifyAppsChanged();
     }
     return result;
 }
@@ -318,9 +868,9 @@ bool Database::deleteApp(int id)
     }
     rootObject["collections"] = colsArray;
     
-    bool result = saveData();
+    bool result = commitData({ journalDel("apps", id), journalSet("collections", colsArray) });
     if (result) {
-        emit appsChanged();
+        notifyAppsChanged();
     }
     return result;
 }
@@ -406,29 +956,32 @@ bool Database::addCollection(const AppCollection &collection)
 {
     AppCollection newCol = collection;
     newCol.id = nextCollectionId++;
+    QJsonObject colObj = collectionToJson(newCol);
     
     QJsonArray colsArray = rootObject["collections"].toArray();
-    colsArray.append(collectionToJson(newCol));
+    colsArray.append(colObj);
     rootObject["collections"] = colsArray;
     
-    return saveData();
+    return commitData({ journalPut("collections", colObj), journalSet("nextCollectionId", nextCollectionId) });
 }
 
 bool Database::updateCollection(const AppCollection &collection)
 {
     QJsonArray colsArray = rootObject["collections"].toArray();
+    QJsonArray ops;
     
     for (int i = 0; i < colsArray.size(); ++i) {
         QJsonObject obj = colsArray[i].toObject();
         if (obj["id"].toInt() == collection.id) {
             colsArray[i] = collectionToJson(collection);
+            ops.append(journalPut("collections", colsArray[i].toObject()));
             break;
         }
     }
     
     rootObject["collections"] = colsArray;
     
-    return saveData();
+    return commitData(ops);
 }
 
 bool Database::deleteCollection(int id)
@@ -445,7 +998,7 @@ bool Database::deleteCollection(int id)
     
     rootObject["collections"] = colsArray;
     
-    return saveData();
+    return commitData({ journalDel("collections", id) });
 }
 
 QList<AppCollection> Database::getAllCollections()
@@ -493,7 +1046,7 @@ bool Database::setAutoStart(bool enabled)
     settingsObj["auto_start"] = enabled ? "1" : "0";
     rootObject["settings"] = settingsObj;
     
-    saveData();
+    commitData({ journalSet("settings", settingsObj) });
     
     return true;
 }
@@ -511,7 +1064,7 @@ bool Database::setMinimizeToTray(bool enabled)
     settingsObj["minimize_to_tray"] = enabled ? "1" : "0";
     rootObject["settings"] = settingsObj;
     
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 bool Database::getMinimizeToTray()
@@ -526,7 +1079,7 @@ bool Database::setShowClosePrompt(bool show)
     settingsObj["show_close_prompt"] = show ? "1" : "0";
     rootObject["settings"] = settingsObj;
     
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 bool Database::getShowClosePrompt()
@@ -541,7 +1094,7 @@ bool Database::setAutoCheckUpdate(bool enabled)
     settingsObj["auto_check_update"] = enabled ? "1" : "0";
     rootObject["settings"] = settingsObj;
     
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 bool Database::getAutoCheckUpdate()
@@ -556,7 +1109,7 @@ bool Database::setRemoteDesktopAutoStart(bool enabled)
     settingsObj["remote_desktop_auto_start"] = enabled ? "1" : "0";
     rootObject["settings"] = settingsObj;
 
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 bool Database::getRemoteDesktopAutoStart()
@@ -571,7 +1124,7 @@ bool Database::setRemoteDesktopAutoStop(bool enabled)
     settingsObj["remote_desktop_auto_stop"] = enabled ? "1" : "0";
     rootObject["settings"] = settingsObj;
 
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 bool Database::getRemoteDesktopAutoStop()
@@ -586,7 +1139,7 @@ bool Database::setShowBottomAppBar(bool show)
     settingsObj["show_bottom_app_bar"] = show ? "1" : "0";
     rootObject["settings"] = settingsObj;
     
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 bool Database::getShowBottomAppBar()
@@ -601,7 +1154,7 @@ bool Database::setShortcutKey(const QString &key)
     settingsObj["shortcut_key"] = key;
     rootObject["settings"] = settingsObj;
     
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 QString Database::getShortcutKey()
@@ -637,7 +1190,7 @@ bool Database::recordShortcutUsage(const QString &shortcut)
     }
     
     rootObject["shortcut_stats"] = statsArray;
-    return saveData();
+    return commitData({ journalSet("shortcut_stats", statsArray) });
 }
 
 QList<ShortcutStat> Database::getShortcutStats()
@@ -668,7 +1221,7 @@ QList<ShortcutStat> Database::getShortcutStats()
 bool Database::clearShortcutStats()
 {
     rootObject["shortcut_stats"] = QJsonArray();
-    return saveData();
+    return commitData({ journalSet("shortcut_stats", QJsonArray()) });
 }
 
 bool Database::setIgnoredVersion(const QString &version)
@@ -677,7 +1230,7 @@ bool Database::setIgnoredVersion(const QString &version)
     settingsObj["ignored_version"] = version;
     rootObject["settings"] = settingsObj;
     
-    return saveData();
+    return commitData({ journalSet("settings", settingsObj) });
 }
 
 QString Database::getIgnoredVersion()
@@ -781,27 +1334,30 @@ bool Database::addRemoteDesktop(const RemoteDesktopConnection &connection)
         newConn.sortOrder = rdsArray.count();
     }
     
-    rdsArray.append(remoteDesktopToJson(newConn));
+    QJsonObject rdObj = remoteDesktopToJson(newConn);
+    rdsArray.append(rdObj);
     rootObject["remoteDesktops"] = rdsArray;
     
-    return saveData();
+    return commitData({ journalPut("remoteDesktops", rdObj), journalSet("nextRemoteDesktopId", nextRemoteDesktopId) });
 }
 
 bool Database::updateRemoteDesktop(const RemoteDesktopConnection &connection)
 {
     QJsonArray rdsArray = rootObject["remoteDesktops"].toArray();
+    QJsonArray ops;
     
     for (int i = 0; i < rdsArray.size(); ++i) {
         QJsonObject obj = rdsArray[i].toObject();
         if (obj["id"].toInt() == connection.id) {
             rdsArray[i] = remoteDesktopToJson(connection);
+            ops.append(journalPut("remoteDesktops", rdsArray[i].toObject()));
             break;
         }
     }
     
     rootObject["remoteDesktops"] = rdsArray;
     
-    return saveData();
+    return commitData(ops);
 }
 
 bool Database::deleteRemoteDesktop(int id)
@@ -818,7 +1374,7 @@ bool Database::deleteRemoteDesktop(int id)
     
     rootObject["remoteDesktops"] = rdsArray;
     
-    return saveData();
+    return commitData({ journalDel("remoteDesktops", id) });
 }
 
 QList<RemoteDesktopConnection> Database::getAllRemoteDesktops()
@@ -903,29 +1459,32 @@ bool Database::addSnapshot(const SnapshotInfo &snapshot)
 {
     SnapshotInfo newSnapshot = snapshot;
     newSnapshot.id = nextSnapshotId++;
+    QJsonObject snapshotObj = snapshotToJson(newSnapshot);
     
     QJsonArray snapshotsArray = rootObject["snapshots"].toArray();
-    snapshotsArray.append(snapshotToJson(newSnapshot));
+    snapshotsArray.append(snapshotObj);
     rootObject["snapshots"] = snapshotsArray;
     
-    return saveData();
+    return commitData({ journalPut("snapshots", snapshotObj), journalSet("nextSnapshotId", nextSnapshotId) });
 }
 
 bool Database::updateSnapshot(const SnapshotInfo &snapshot)
 {
     QJsonArray snapshotsArray = rootObject["snapshots"].toArray();
+    QJsonArray ops;
     
     for (int i = 0; i < snapshotsArray.size(); ++i) {
         QJsonObject obj = snapshotsArray[i].toObject();
         if (obj["id"].toInt() == snapshot.id) {
             snapshotsArray[i] = snapshotToJson(snapshot);
+            ops.append(journalPut("snapshots", snapshotsArray[i].toObject()));
             break;
         }
     }
     
     rootObject["snapshots"] = snapshotsArray;
     
-    return saveData();
+    return commitData(ops);
 }
 
 bool Database::deleteSnapshot(int id)
@@ -942,7 +1501,7 @@ bool Database::deleteSnapshot(int id)
     
     rootObject["snapshots"] = snapshotsArray;
     
-    return saveData();
+    return commitData({ journalDel("snapshots", id) });
 }
 
 QList<SnapshotInfo> Database::getAllSnapshots()
@@ -1014,17 +1573,26 @@ SnapshotInfo Database::getSnapshotById(int id)
 
 QList<SnapshotInfo> Database::searchSnapshots(const QString &keyword)
 {
+    if (keyword.trimmed().isEmpty()) {
+        return getAllSnapshots();
+    }
+    if (!dataSearchIndexValid) {
+        rebuildDataSearchIndex();
+    }
+
+    QHash<int, QJsonObject> snapshotObjects;
+    for (const QJsonValue &val : rootObject["snapshots"].toArray()) {
+        QJsonObject obj = val.toObject();
+        snapshotObjects.insert(obj["id"].toInt(), obj);
+    }
+
+    // 按相关度排序
     QList<SnapshotInfo> snapshots;
-    QList<SnapshotInfo> allSnapshots = getAllSnapshots();
-    
-    QString lowerKeyword = keyword.toLower();
-    
-    for (const SnapshotInfo &snapshot : allSnapshots) {
-        if (snapshot.name.toLower().contains(lowerKeyword) ||
-            snapshot.description.toLower().contains(lowerKeyword) ||
-            snapshot.tags.toLower().contains(lowerKeyword) ||
-            snapshot.path.toLower().contains(lowerKeyword)) {
-            snapshots.append(snapshot);
+    const QStringList ids = snapshotSearchIndex.search(keyword);
+    for (const QString &id : ids) {
+        auto it = snapshotObjects.constFind(id.toInt());
+        if (it != snapshotObjects.constEnd()) {
+            snapshots.append(jsonToSnapshot(it.value()));
         }
     }
     
@@ -1075,21 +1643,29 @@ RemoteDesktopConnection Database::getRemoteDesktopById(int id)
 
 QList<RemoteDesktopConnection> Database::searchRemoteDesktops(const QString &keyword)
 {
-    QList<RemoteDesktopConnection> connections;
-    QList<RemoteDesktopConnection> allConnections = getAllRemoteDesktops();
-    
-    QString lowerKeyword = keyword.toLower();
-    
-    for (const RemoteDesktopConnection &conn : allConnections) {
-        if (conn.name.toLower().contains(lowerKeyword) ||
-            conn.hostAddress.toLower().contains(lowerKeyword) ||
-            conn.username.toLower().contains(lowerKeyword) ||
-            conn.category.toLower().contains(lowerKeyword) ||
-            conn.notes.toLower().contains(lowerKeyword)) {
-            connections.append(conn);
-        }
+    if (keyword.trimmed().isEmpty()) {
+        return getAllRemoteDesktops();
     }
-    
+    if (!dataSearchIndexValid) {
+        rebuildDataSearchIndex();
+    }
+
+    QHash<int, QJsonObject> rdObjects;
+    for (const QJsonValue &val : rootObject["remoteDesktops"].toArray()) {
+        QJsonObject obj = val.toObject();
+        rdObjects.insert(obj["id"].toInt(), obj);
+    }
+
+    // 按相关度排序
+    QList<RemoteDesktopConnection> connections;
+    const QStringList ids = remoteDesktopSearchIndex.search(keyword);
+    for (const QString &id : ids) {
+        auto it = rdObjects.constFind(id.toInt());
+        if (it != rdObjects.constEnd()) {
+            connections.append(jsonToRemoteDesktop(it.value()));
+        }
+    }
+    
     return connections;
 }
 
@@ -1133,7 +1709,7 @@ bool Database::saveFRPCConfig(const FRPCConfig &config)
         cfg.id = 1;  // 只有一个FRPC配置
     }
     rootObject["frpcConfig"] = frpcConfigToJson(cfg);
-    return saveData();
+    return commitData({ journalSet("frpcConfig", rootObject["frpcConfig"]) });
 }
 
 FRPCConfig Database::getFRPCConfig()
@@ -1157,7 +1733,7 @@ bool Database::deleteFRPCConfig()
 {
     if (rootObject.contains("frpcConfig")) {
         rootObject.remove("frpcConfig");
-        return saveData();
+        return commitData({ journalUnset("frpcConfig") });
     }
     return true;
 }
@@ -1226,19 +1802,516 @@ Task Database::jsonToTask(const QJsonObject &obj)
     return task;
 }
 
+// 用一份完整的任务列表替换当前存储（旧版单文件格式），所有分段都需要重新写出
+void Database::loadTaskStore(const QJsonArray &tasksArray)
+{
+    clearTaskStore();
+    taskStore.reserve(tasksArray.size());
+    for (const QJsonValue &val : tasksArray) {
+        Task task = jsonToTask(val.toObject());
+        storeTask(task);
+        markTaskSegmentDirty(task.id);
+    }
+}
+
+void Database::clearTaskStore()
+{
+    taskStore.clear();
+    taskIndex.clear();
+    tasksByDay.clear();
+    finishedTasksByDay.clear();
+    openTaskIds.clear();
+    overallTaskStats = TaskStats();
+    statsByCreatedDay.clear();
+    statsByFinishedDay.clear();
+    taskSegments.clear();
+    taskSearchIndex.clear();
+    taskIdSequences.clear();
+    taskIdsByVersion.clear();
+    taskTombstones.clear();
+    taskSyncBases.clear();
+    taskSyncBasesDirty = false;
+}
+
+// 任务ID前8位为创建日期（yyyyMMdd）
+QDate Database::taskCreationDate(const QString &taskId)
+{
+    if (taskId.length() < 8) {
+        return QDate();
+    }
+    return QDate::fromString(taskId.left(8), "yyyyMMdd");
+}
+
+// 任务所在分段：按创建月份划分，ID 中没有有效日期的任务归入单独的分段
+#define TASK_SEGMENT_UNDATED "undated"
+
+static QString taskSegmentKey(const QString &taskId)
+{
+    QDate created = Database::taskCreationDate(taskId);
+    return created.isValid() ? created.toString("yyyy-MM") : QString(TASK_SEGMENT_UNDATED);
+}
+
+static QJsonObject taskStatsToJson(const TaskStats &stats)
+{
+    QJsonObject obj;
+    obj["taskCount"] = stats.taskCount;
+    obj["completedCount"] = stats.completedCount;
+    obj["hours"] = stats.hours;
+    obj["completedHours"] = stats.completedHours;
+
+    QJsonObject categories;
+    for (auto it = stats.categories.constBegin(); it != stats.categories.constEnd(); ++it) {
+        QJsonObject cat;
+        cat["taskCount"] = it.value().taskCount;
+        cat["completedCount"] = it.value().completedCount;
+        cat["hours"] = it.value().hours;
+        cat["completedHours"] = it.value().completedHours;
+        categories[QString::number(it.key())] = cat;
+    }
+    obj["categories"] = categories;
+    return obj;
+}
+
+static TaskStats jsonToTaskStats(const QJsonObject &obj)
+{
+    TaskStats stats;
+    stats.taskCount = obj["taskCount"].toInt();
+    stats.completedCount = obj["completedCount"].toInt();
+    stats.hours = obj["hours"].toDouble();
+    stats.completedHours = obj["completedHours"].toDouble();
+
+    QJsonObject categories = obj["categories"].toObject();
+    for (auto it = categories.constBegin(); it != categories.constEnd(); ++it) {
+        QJsonObject catObj = it.value().toObject();
+        TaskCategoryStats &cat = stats.categories[it.key().toInt()];
+        cat.taskCount = catObj["taskCount"].toInt();
+        cat.completedCount = catObj["completedCount"].toInt();
+        cat.hours = catObj["hours"].toDouble();
+        cat.completedHours = catObj["completedHours"].toDouble();
+    }
+    return stats;
+}
+
+static void insertSortedId(QVector<QString> &ids, const QString &id)
+{
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id) {
+        ids.insert(it, id);
+    }
+}
+
+static void removeSortedId(QMap<QDate, QVector<QString>> &buckets, const QDate &day, const QString &id)
+{
+    auto bucket = buckets.find(day);
+    if (bucket == buckets.end()) {
+        return;
+    }
+
+    QVector<QString> &ids = bucket.value();
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id) {
+        ids.erase(it);
+    }
+    if (ids.isEmpty()) {
+        buckets.erase(bucket);
+    }
+}
+
+// sign 为 1 时计入汇总，为 -1 时从汇总中扣除
+static void accumulateTaskStats(TaskStats &stats, const Task &task, int sign)
+{
+    bool completed = (task.status == TaskStatus_Completed);
+
+    stats.taskCount += sign;
+    stats.hours += sign * task.workDuration;
+    if (completed) {
+        stats.completedCount += sign;
+        stats.completedHours += sign * task.workDuration;
+    }
+
+    TaskCategoryStats &cat = stats.categories[task.categoryId];
+    cat.taskCount += sign;
+    cat.hours += sign * task.workDuration;
+    if (completed) {
+        cat.completedCount += sign;
+        cat.completedHours += sign * task.workDuration;
+    }
+
+    // 计数归零时清掉浮点累计误差
+    if (cat.taskCount <= 0) {
+        stats.categories.remove(task.categoryId);
+    }
+    if (stats.taskCount <= 0) {
+        stats = TaskStats();
+    } else if (stats.completedCount <= 0) {
+        stats.completedHours = 0;
+    }
+}
+
+static void mergeTaskStats(TaskStats &into, const TaskStats &from)
+{
+    into.taskCount += from.taskCount;
+    into.completedCount += from.completedCount;
+    into.hours += from.hours;
+    into.completedHours += from.completedHours;
+
+    for (auto it = from.categories.constBegin(); it != from.categories.constEnd(); ++it) {
+        TaskCategoryStats &cat = into.categories[it.key()];
+        cat.taskCount += it.value().taskCount;
+        cat.completedCount += it.value().completedCount;
+        cat.hours += it.value().hours;
+        cat.completedHours += it.value().completedHours;
+    }
+}
+
+static void subtractDayStats(QMap<QDate, TaskStats> &statsByDay, const QDate &day, const Task &task)
+{
+    auto it = statsByDay.find(day);
+    if (it == statsByDay.end()) {
+        return;
+    }
+
+    accumulateTaskStats(it.value(), task, -1);
+    if (it.value().taskCount <= 0) {
+        statsByDay.erase(it);
+    }
+}
+
+void Database::indexTask(const Task &task)
+{
+    accumulateTaskStats(overallTaskStats, task, 1);
+    taskSearchIndex.setDocument(task.id, { { task.title, 3 }, { task.tags.join(' '), 2 }, { task.description, 1 } });
+    if (task.version > 0) {
+        taskIdsByVersion.insert(task.version, task.id);
+    }
+
+    if (task.completionTime.isValid()) {
+        QDate finished = task.completionTime.date();
+        insertSortedId(finishedTasksByDay[finished], task.id);
+        accumulateTaskStats(statsByFinishedDay[finished], task, 1);
+    }
+
+    QDate created = taskCreationDate(task.id);
+    if (!created.isValid()) {
+        return;
+    }
+
+    insertSortedId(tasksByDay[created], task.id);
+    accumulateTaskStats(statsByCreatedDay[created], task, 1);
+
+    // 同步下发的任务也经过这里，生成新ID时不会与之冲突
+    int &maxSequence = taskIdSequences[task.id.left(8)];
+    maxSequence = qMax(maxSequence, task.id.mid(8).toInt());
+    if (task.status != TaskStatus_Completed || !task.completionTime.isValid()) {
+        openTaskIds.insert(task.id);
+    }
+}
+
+void Database::unindexTask(const Task &task)
+{
+    accumulateTaskStats(overallTaskStats, task, -1);
+    taskSearchIndex.removeDocument(task.id);
+    if (task.version > 0) {
+        taskIdsByVersion.remove(task.version, task.id);
+    }
+
+    if (task.completionTime.isValid()) {
+        QDate finished = task.completionTime.date();
+        removeSortedId(finishedTasksByDay, finished, task.id);
+        subtractDayStats(statsByFinishedDay, finished, task);
+    }
+
+    QDate created = taskCreationDate(task.id);
+    if (!created.isValid()) {
+        return;
+    }
+
+    removeSortedId(tasksByDay, created, task.id);
+    subtractDayStats(statsByCreatedDay, created, task);
+    openTaskIds.remove(task.id);
+}
+
+// 插入或覆盖任务，返回其在 taskStore 中的下标
+int Database::storeTask(const Task &task)
+{
+    auto it = taskIndex.constFind(task.id);
+    if (it != taskIndex.constEnd()) {
+        unindexTask(taskStore.at(it.value()));
+        taskStore[it.value()] = task;
+        indexTask(task);
+        return it.value();
+    }
+
+    taskStore.append(task);
+    int index = taskStore.size() - 1;
+    taskIndex.insert(task.id, index);
+    indexTask(task);
+    return index;
+}
+
+// 用末尾元素填补空位，删除为 O(1)；任务顺序不作保证，需要有序时由调用方排序
+void Database::removeStoredTask(int index)
+{
+    int lastIndex = taskStore.size() - 1;
+    unindexTask(taskStore.at(index));
+    taskIndex.remove(taskStore[index].id);
+    if (index != lastIndex) {
+        taskStore[index] = taskStore[lastIndex];
+        taskIndex[taskStore[index].id] = index;
+    }
+    taskStore.removeLast();
+}
+
+// 分段文件放在任务文件旁的同名目录中，如 user_1/tasks.segments/2026-03.json
+QString Database::taskSegmentPath(const QString &key) const
+{
+    QString base = taskFilePath.left(taskFilePath.lastIndexOf('.'));
+    return base + ".segments/" + key + StorageCodec::suffix(storageFormat);
+}
+
+// 同步基准文件与分段目录同名，如 user_1/tasks.syncbases.json
+QString Database::taskSyncBasePath() const
+{
+    QString base = taskFilePath.left(taskFilePath.lastIndexOf('.'));
+    return base + ".syncbases" + StorageCodec::suffix(storageFormat);
+}
+
+void Database::loadTaskSyncBases()
+{
+    taskSyncBases.clear();
+    taskSyncBasesDirty = false;
+
+    // 当前格式的文件不存在时读取另一种格式，下次保存时按当前格式重写
+    QString path = taskSyncBasePath();
+    if (!QFile::exists(path)) {
+        path = StorageCodec::counterpartPath(path);
+        if (!QFile::exists(path)) {
+            return;
+        }
+        taskSyncBasesDirty = true;
+    }
+
+    QJsonObject basesObject;
+    if (!readStorageFile(path, &basesObject)) {
+        return;
+    }
+    for (auto it = basesObject.constBegin(); it != basesObject.constEnd(); ++it) {
+        taskSyncBases.insert(it.key(), it.value().toObject());
+    }
+}
+
+// 依次尝试读取的文件：当前格式的文件、写完但未来得及重命名的临时文件、写入前的备份，
+// 之后是另一种格式的同名文件。后台写入在删除旧文件和重命名临时文件之间中断时主文件不存在
+static QStringList storageFileCandidates(const QString &filePath)
+{
+    QString counterpart = StorageCodec::counterpartPath(filePath);
+    return { filePath, filePath + ".tmp", filePath + ".bak",
+             counterpart, counterpart + ".tmp", counterpart + ".bak" };
+}
+
+bool Database::readTaskSegmentFile(const QString &path, QJsonObject *object)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Cannot open task segment %s: %s", qPrintable(path), qPrintable(file.errorString()));
+        return false;
+    }
+
+    // 映射文件后直接在映射内存上解码，解码结果不引用映射区，解码后即可解除映射
+    qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    QByteArray data = mapped ? QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), static_cast<int>(size))
+                             : file.readAll();
+
+    QString error;
+    bool ok = StorageCodec::decode(data, object, &error);
+    data = QByteArray();
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    file.close();
+
+    if (!ok) {
+        qWarning("Cannot parse task segment %s: %s", qPrintable(path), qPrintable(error));
+    }
+    return ok;
+}
+
+bool Database::loadTaskSegment(const QString &key)
+{
+    auto it = taskSegments.find(key);
+    if (it == taskSegments.end() || it.value().loaded) {
+        return true;
+    }
+
+    // 不是从当前格式的主文件读到的分段，下次保存时按当前格式重写
+    QString primaryPath = taskSegmentPath(key);
+    QString loadedPath;
+    bool found = false;
+    QJsonObject segmentObject;
+    for (const QString &path : storageFileCandidates(primaryPath)) {
+        if (!QFile::exists(path)) {
+            continue;
+        }
+        found = true;
+        if (readTaskSegmentFile(path, &segmentObject)) {
+            loadedPath = path;
+            break;
+        }
+    }
+
+    // 读不出来时保持未加载状态，避免之后的保存用不完整的数据覆盖它。
+    // 文件都不存在时，只有索引中也没有任务才按空分段处理
+    if (loadedPath.isEmpty()) {
+        if (found || it.value().stats.taskCount > 0) {
+            qWarning("Task segment %s could not be loaded (%d tasks in index)",
+                     qPrintable(key), it.value().stats.taskCount);
+            return false;
+        }
+        qWarning("Task segment %s is missing", qPrintable(key));
+        it.value() = TaskSegment();
+        it.value().loaded = true;
+        return true;
+    }
+    if (loadedPath != primaryPath) {
+        qWarning("Task segment %s unavailable, loaded from: %s", qPrintable(key), qPrintable(loadedPath));
+    }
+
+    it.value().loaded = true;
+    it.value().dirty = loadedPath != primaryPath;
+
+    const QJsonArray tasksArray = segmentObject["tasks"].toArray();
+    taskStore.reserve(taskStore.size() + tasksArray.size());
+    for (const QJsonValue &val : tasksArray) {
+        storeTask(jsonToTask(val.toObject()));
+    }
+    return true;
+}
+
+// 任务主文件丢失而分段目录还在时，分段索引无从得知，按目录中的文件重新登记并全部加载，
+// 否则之后的保存会把同月份的新任务写成只含新任务的分段，覆盖原有文件
+void Database::recoverTaskSegments()
+{
+    QString base = taskFilePath.left(taskFilePath.lastIndexOf('.'));
+    QDir segmentDir(base + ".segments");
+    if (!segmentDir.exists()) {
+        return;
+    }
+
+    const QStringList files = segmentDir.entryList({ "*.json", "*.cbor", "*.tmp", "*.bak" }, QDir::Files);
+    for (QString key : files) {
+        for (const QString &suffix : { QString(".tmp"), QString(".bak") }) {
+            if (key.endsWith(suffix)) {
+                key.chop(suffix.length());
+            }
+        }
+        key = QFileInfo(key).completeBaseName();
+        if (!key.isEmpty() && !taskSegments.contains(key)) {
+            taskSegments.insert(key, TaskSegment());
+        }
+    }
+
+    for (auto it = taskSegments.begin(); it != taskSegments.end(); ++it) {
+        if (loadTaskSegment(it.key())) {
+            it.value().dirty = true;
+        }
+    }
+    if (!taskSegments.isEmpty()) {
+        qWarning("Task index file missing, recovered %d segments from %s",
+                 taskSegments.size(), qPrintable(segmentDir.absolutePath()));
+    }
+}
+
+void Database::ensureTaskSegmentFor(const QString &taskId)
+{
+    loadTaskSegment(taskSegmentKey(taskId));
+}
+
+void Database::ensureAllTaskSegments()
+{
+    for (const QString &key : taskSegments.keys()) {
+        loadTaskSegment(key);
+    }
+}
+
+void Database::ensureTaskSegmentsCreatedBetween(const QDate &startDate, const QDate &endDate)
+{
+    QString startKey = startDate.toString("yyyy-MM");
+    QString endKey = endDate.toString("yyyy-MM");
+    for (const QString &key : taskSegments.keys()) {
+        if (key == TASK_SEGMENT_UNDATED || (key >= startKey && key <= endKey)) {
+            loadTaskSegment(key);
+        }
+    }
+}
+
+// 创建于 until 所在月份及之前、且有任务在 finishedFrom 之后完成（或仍未完成）的分段
+// 分段索引记录了段内最大版本号，只需加载含有新修改的分段
+void Database::ensureTaskSegmentsChangedSince(qint64 version)
+{
+    const QStringList keys = taskSegments.keys();
+    for (const QString &key : keys) {
+        const TaskSegment &segment = taskSegments[key];
+        if (!segment.loaded && segment.maxVersion > version) {
+            loadTaskSegment(key);
+        }
+    }
+}
+
+void Database::ensureTaskSegmentsFinishedSince(const QDate &until, const QDate &finishedFrom, bool includeOpen)
+{
+    QString untilKey = until.toString("yyyy-MM");
+    QStringList keys;
+    for (auto it = taskSegments.constBegin(); it != taskSegments.constEnd(); ++it) {
+        const TaskSegment &segment = it.value();
+        if (segment.loaded) {
+            continue;
+        }
+        if (it.key() != TASK_SEGMENT_UNDATED) {
+            if (it.key() > untilKey) {
+                continue;
+            }
+            bool touched = (includeOpen && segment.openCount > 0) ||
+                           (segment.lastFinished.isValid() && segment.lastFinished >= finishedFrom);
+            if (!touched) {
+                continue;
+            }
+        }
+        keys.append(it.key());
+    }
+
+    for (const QString &key : keys) {
+        loadTaskSegment(key);
+    }
+}
+
+// 修改任务前须先加载其所在分段，否则保存时会用不完整的数据覆盖分段文件
+void Database::markTaskSegmentDirty(const QString &taskId)
+{
+    // 分段只在能确认内容（文件读出，或文件和索引中都没有任务）时才算加载
+    QString key = taskSegmentKey(taskId);
+    if (!loadTaskSegment(key)) {
+        qWarning("Task segment for %s could not be loaded, change will not be saved", qPrintable(taskId));
+        return;
+    }
+    TaskSegment &segment = taskSegments[key];
+    segment.loaded = true;
+    segment.dirty = true;
+}
+
 bool Database::addTask(const Task &task)
 {
     Task newTask = task;
     newTask.id = generateTaskId();
     newTask.updatedAt = QDateTime::currentDateTime();
+    newTask.version = allocateTaskVersion();
 
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    tasksArray.append(taskToJson(newTask));
-    taskRootObject["tasks"] = tasksArray;
+    storeTask(newTask);
+    markTaskSegmentDirty(newTask.id);
 
     bool result = saveTaskData();
     if (result) {
-        emit tasksChanged();
+        notifyTasksChanged(newTask.id);
     }
     return result;
 }
@@ -1247,15 +2320,22 @@ bool Database::addTask(const Task &task)
 bool Database::addTaskWithId(const Task &task)
 {
     Task newTask = task;
-    newTask.updatedAt = QDateTime::currentDateTime();
+    // 保留云端的更新时间，否则本地副本会显得比云端新
+    if (!newTask.updatedAt.isValid()) {
+        newTask.updatedAt = QDateTime::currentDateTime();
+    }
+    // 来自云端的任务已经同步，不分配版本号，避免下次又上传回去
+    newTask.version = 0;
 
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    tasksArray.append(taskToJson(newTask));
-    taskRootObject["tasks"] = tasksArray;
+    // 同一ID已存在时覆盖，避免同步重复下发造成重复任务
+    ensureTaskSegmentFor(newTask.id);
+    storeTask(newTask);
+    markTaskSegmentDirty(newTask.id);
+    taskTombstones.remove(newTask.id);
 
     bool result = saveTaskData();
     if (result) {
-        emit tasksChanged();
+        notifyTasksChanged(newTask.id);
     }
     return result;
 }
@@ -1265,71 +2345,65 @@ bool Database::updateTask(const Task &task)
     Task updatedTask = task;
     updatedTask.updatedAt = QDateTime::currentDateTime();
 
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-
-    for (int i = 0; i < tasksArray.size(); ++i) {
-        QJsonObject obj = tasksArray[i].toObject();
-        if (obj["id"].toString() == task.id) {
-            tasksArray[i] = taskToJson(updatedTask);
-            break;
-        }
+    ensureTaskSegmentFor(task.id);
+    if (taskIndex.contains(task.id)) {
+        updatedTask.version = allocateTaskVersion();
+        storeTask(updatedTask);
+        markTaskSegmentDirty(task.id);
     }
 
-    taskRootObject["tasks"] = tasksArray;
-
     bool result = saveTaskData();
     if (result) {
-        emit tasksChanged();
+        notifyTasksChanged(task.id);
     }
     return result;
 }
 
 bool Database::deleteTask(const QString &id)
 {
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-
-    for (int i = 0; i < tasksArray.size(); ++i) {
-        QJsonObject obj = tasksArray[i].toObject();
-        if (obj["id"].toString() == id) {
-            tasksArray.removeAt(i);
-            break;
-        }
+    ensureTaskSegmentFor(id);
+    int index = taskIndex.value(id, -1);
+    if (index >= 0) {
+        removeStoredTask(index);
+        markTaskSegmentDirty(id);
+        taskTombstones.insert(id, allocateTaskVersion());
     }
 
-    taskRootObject["tasks"] = tasksArray;
-
     bool result = saveTaskData();
     if (result) {
-        emit tasksChanged();
+        notifyTasksChanged(id);
     }
     return result;
 }
 
+// 分配新的任务版本号，由调用方负责保存
+qint64 Database::allocateTaskVersion()
+{
+    qint64 newVersion = currentTaskVersion() + 1;
+    taskRootObject["taskVersion"] = newVersion;
+    return newVersion;
+}
+
 // 获取下一个任务版本号
 qint64 Database::getNextTaskVersion()
 {
-    qint64 currentVersion = taskRootObject["taskVersion"].toVariant().toLongLong();
-    qint64 newVersion = currentVersion + 1;
-    taskRootObject["taskVersion"] = newVersion;
+    qint64 newVersion = allocateTaskVersion();
     saveTaskData();
     return newVersion;
 }
 
-// 更新任务的版本号
+// 更新任务的版本号，新版本号与任务一起保存一次
 bool Database::updateTaskVersion(const QString& id)
 {
-    qint64 newVersion = getNextTaskVersion();
-
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    for (int i = 0; i < tasksArray.size(); ++i) {
-        QJsonObject obj = tasksArray[i].toObject();
-        if (obj["id"].toString() == id) {
-            obj["version"] = newVersion;
-            tasksArray[i] = obj;
-            break;
-        }
+    ensureTaskSegmentFor(id);
+    int index = taskIndex.value(id, -1);
+    if (index >= 0) {
+        Task &task = taskStore[index];
+        unindexTask(task);
+        task.version = allocateTaskVersion();
+        indexTask(task);
+        markTaskSegmentDirty(id);
     }
-    taskRootObject["tasks"] = tasksArray;
     return saveTaskData();
 }
 
@@ -1337,10 +2411,9 @@ bool Database::updateTaskVersion(const QString& id)
 QList<Task> Database::getTasksModifiedSince(const QDateTime& since)
 {
     QList<Task> result;
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
+    ensureAllTaskSegments();
 
-    for (const QJsonValue &val : tasksArray) {
-        Task task = jsonToTask(val.toObject());
+    for (const Task &task : taskStore) {
         if (task.updatedAt.isValid() && task.updatedAt > since) {
             result.append(task);
         }
@@ -1348,6 +2421,107 @@ QList<Task> Database::getTasksModifiedSince(const QDateTime& since)
     return result;
 }
 
+qint64 Database::currentTaskVersion() const
+{
+    return taskRootObject["taskVersion"].toVariant().toLongLong();
+}
+
+QList<Task> Database::getTasksChangedSince(qint64 version)
+{
+    ensureTaskSegmentsChangedSince(version);
+
+    QList<Task> result;
+    for (auto it = taskIdsByVersion.upperBound(version); it != taskIdsByVersion.constEnd(); ++it) {
+        result.append(taskStore.at(taskIndex.value(it.value())));
+    }
+    return result;
+}
+
+QStringList Database::getDeletedTaskIdsSince(qint64 version) const
+{
+    QStringList result;
+    for (auto it = taskTombstones.constBegin(); it != taskTombstones.constEnd(); ++it) {
+        if (it.value() > version) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+int Database::getPendingTaskSyncCount()
+{
+    qint64 version = getTaskSyncState().lastSyncVersion;
+    ensureTaskSegmentsChangedSince(version);
+
+    int count = 0;
+    for (auto it = taskIdsByVersion.upperBound(version); it != taskIdsByVersion.constEnd(); ++it) {
+        count++;
+    }
+    for (auto it = taskTombstones.constBegin(); it != taskTombstones.constEnd(); ++it) {
+        if (it.value() > version) {
+            count++;
+        }
+    }
+    return count;
+}
+
+QJsonObject Database::getTaskSyncBase(const QString& id) const
+{
+    return taskSyncBases.value(id);
+}
+
+void Database::setTaskSyncBase(const QString& id, const QJsonObject& base)
+{
+    if (base.isEmpty()) {
+        if (taskSyncBases.remove(id) > 0) {
+            taskSyncBasesDirty = true;
+        }
+        return;
+    }
+    taskSyncBases.insert(id, base);
+    taskSyncBasesDirty = true;
+}
+
+bool Database::hasTaskTombstone(const QString& id) const
+{
+    return taskTombstones.contains(id);
+}
+
+SyncState Database::getTaskSyncState()
+{
+    return getSyncState("task", "all");
+}
+
+bool Database::markTasksSynced(qint64 version)
+{
+    // 已上传的删除记录及其同步基准不再需要
+    for (auto it = taskTombstones.begin(); it != taskTombstones.end();) {
+        if (it.value() <= version) {
+            if (taskSyncBases.remove(it.key()) > 0) {
+                taskSyncBasesDirty = true;
+            }
+            it = taskTombstones.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return updateLastSyncTime("task", "all", version);
+}
+
+qint64 Database::getTaskDownloadCursor() const
+{
+    return taskRootObject["downloadCursor"].toVariant().toLongLong();
+}
+
+bool Database::setTaskDownloadCursor(qint64 cursor)
+{
+    if (cursor == getTaskDownloadCursor()) {
+        return true;
+    }
+    taskRootObject["downloadCursor"] = cursor;
+    return saveTaskData();
+}
+
 // 保存同步状态
 bool Database::saveSyncState(const SyncState& state)
 {
@@ -1400,73 +2574,86 @@ bool Database::updateLastSyncTime(const QString& entityType, const QString& enti
     return saveSyncState(state);
 }
 
-// 添加同步日志
+// 添加同步日志，直接写入日志文件，不随批量修改回滚
 bool Database::addSyncLog(const SyncLog& log)
 {
-    QJsonObject logObj;
-    logObj["id"] = log.id;
-    logObj["entityType"] = log.entityType;
-    logObj["entityId"] = log.entityId;
-    logObj["action"] = log.action;
-    logObj["beforeData"] = log.beforeData;
-    logObj["afterData"] = log.afterData;
-    logObj["resolution"] = log.resolution;
-    logObj["timestamp"] = log.timestamp.toString(Qt::ISODate);
-
-    QJsonArray logsArray = taskRootObject["syncLogs"].toArray();
-    logsArray.append(logObj);
+    QJsonObject payload;
+    payload["entityId"] = log.entityId;
+    payload["action"] = log.action;
+    payload["beforeData"] = log.beforeData;
+    payload["afterData"] = log.afterData;
+    payload["resolution"] = log.resolution;
 
-    // 只保留最近1000条日志
-    while (logsArray.size() > 1000) {
-        logsArray.removeAt(0);
-    }
-
-    taskRootObject["syncLogs"] = logsArray;
-    return saveTaskData();
+    QDateTime timestamp = log.timestamp.isValid() ? log.timestamp : QDateTime::currentDateTime();
+    return syncLogStore.append(log.entityType, timestamp, payload) >= 0;
 }
 
-// 获取同步日志
-QList<SyncLog> Database::getSyncLogs(const QString& entityType, int limit)
+// 获取同步日志，只读取请求的这一页
+QList<SyncLog> Database::getSyncLogs(const QString& entityType, int limit, int offset, const QDateTime& before)
 {
     QList<SyncLog> result;
-    QJsonArray logsArray = taskRootObject["syncLogs"].toArray();
-
-    int count = 0;
-    // 从最新到最旧遍历
-    for (int i = logsArray.size() - 1; i >= 0 && count < limit; --i) {
-        QJsonObject obj = logsArray[i].toObject();
-        if (entityType.isEmpty() || obj["entityType"].toString() == entityType) {
-            SyncLog log;
-            log.id = obj["id"].toInt();
-            log.entityType = obj["entityType"].toString();
-            log.entityId = obj["entityId"].toString();
-            log.action = obj["action"].toString();
-            log.beforeData = obj["beforeData"].toString();
-            log.afterData = obj["afterData"].toString();
-            log.resolution = obj["resolution"].toString();
-            log.timestamp = QDateTime::fromString(obj["timestamp"].toString(), Qt::ISODate);
-            result.append(log);
-            count++;
-        }
+    const QVector<SyncLogStore::Record> records = syncLogStore.read(entityType, before, offset, limit);
+    result.reserve(records.size());
+    for (const SyncLogStore::Record &record : records) {
+        SyncLog log;
+        log.id = record.id;
+        log.entityType = record.entityType;
+        log.entityId = record.payload["entityId"].toString();
+        log.action = record.payload["action"].toString();
+        log.beforeData = record.payload["beforeData"].toString();
+        log.afterData = record.payload["afterData"].toString();
+        log.resolution = record.payload["resolution"].toString();
+        log.timestamp = record.timestamp;
+        result.append(log);
     }
-
     return result;
 }
 
-// 清空同步日志
+int Database::getSyncLogCount(const QString& entityType, const QDateTime& before) const
+{
+    return syncLogStore.count(entityType, before);
+}
+
 bool Database::clearSyncLogs()
 {
-    taskRootObject["syncLogs"] = QJsonArray();
-    return saveTaskData();
+    return syncLogStore.clear();
+}
+
+// 同步日志文件与分段目录同名，如 user_1/tasks.synclog
+QString Database::taskSyncLogPath() const
+{
+    return taskFilePath.left(taskFilePath.lastIndexOf('.')) + ".synclog";
+}
+
+// 旧版把同步日志保存在任务文件的 syncLogs 数组中，加载时移入日志文件
+void Database::migrateSyncLogs()
+{
+    const QJsonArray logsArray = taskRootObject["syncLogs"].toArray();
+    for (const QJsonValue &value : logsArray) {
+        QJsonObject obj = value.toObject();
+        SyncLog log;
+        log.id = obj["id"].toInt();
+        log.entityType = obj["entityType"].toString();
+        log.entityId = obj["entityId"].toString();
+        log.action = obj["action"].toString();
+        log.beforeData = obj["beforeData"].toString();
+        log.afterData = obj["afterData"].toString();
+        log.resolution = obj["resolution"].toString();
+        log.timestamp = QDateTime::fromString(obj["timestamp"].toString(), Qt::ISODate);
+        addSyncLog(log);
+    }
+    taskRootObject.remove("syncLogs");
 }
 
 QList<Task> Database::getAllTasks()
 {
+    ensureAllTaskSegments();
+
     QList<Task> tasks;
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
+    tasks.reserve(taskStore.size());
     
-    for (const QJsonValue &val : tasksArray) {
-        tasks.append(jsonToTask(val.toObject()));
+    for (const Task &task : taskStore) {
+        tasks.append(task);
     }
     
     std::sort(tasks.begin(), tasks.end(), [](const Task &a, const Task &b) {
@@ -1476,6 +2663,8 @@ QList<Task> Database::getAllTasks()
     return tasks;
 }
 
+#ifdef QT_DEBUG
+// 逐个任务判断的参考实现，供调试自检使用；运行时由 getTasksForDate 的索引遍历实现同样的规则
 static QList<Task> filterTasksForDateInternal(const QList<Task> &allTasks, const QDate &viewDate)
 {
     QList<Task> result;
@@ -1510,8 +2699,7 @@ static QList<Task> filterTasksForDateInternal(const QList<Task> &allTasks, const
     return result;
 }
 
-#ifdef QT_DEBUG
-static void runTaskFilterTests()
+void Database::runTaskFilterTests()
 {
     QList<Task> tasks;
     QDate viewDate(2026, 3, 4);
@@ -1599,24 +2787,107 @@ static void runTaskFilterTests()
 
     // 3月4日0点完成的任务，根据新逻辑应该显示
     // 如果旧逻辑则不显示，现在新逻辑允许显示
+
+    // 跨多天的任务：3月1日创建，3月6日完成，应显示在这几天中的每一天
+    Task multiDay;
+    multiDay.id = viewDate.addDays(-3).toString("yyyyMMdd") + "0009";
+    multiDay.status = TaskStatus_Completed;
+    multiDay.completionTime = QDateTime(nextDate.addDays(1)).addSecs(9 * 3600);
+    tasks.append(multiDay);
+
+    // 有完成时间但重新打开的任务
+    Task reopened;
+    reopened.id = prevDate.toString("yyyyMMdd") + "0010";
+    reopened.status = TaskStatus_InProgress;
+    reopened.completionTime = QDateTime(prevDate).addSecs(15 * 3600);
+    tasks.append(reopened);
+
+    // 已删除的任务不应出现在任何一天
+    Task deletedOpen;
+    deletedOpen.id = prevDate.toString("yyyyMMdd") + "0011";
+    deletedOpen.status = TaskStatus_Todo;
+    Task deletedCompleted;
+    deletedCompleted.id = viewDate.toString("yyyyMMdd") + "0012";
+    deletedCompleted.status = TaskStatus_Completed;
+    deletedCompleted.completionTime = QDateTime(nextDate).addSecs(8 * 3600);
+
+    // 在空的任务数据上用索引实现（getTasksForDate）逐日对照参考实现，结束后恢复原有数据；
+    // 清空后没有分段，不会读取或写入磁盘上的文件
+    TaskSnapshot saved = takeTaskSnapshot();
+    clearTaskStore();
+    for (const Task &task : tasks) {
+        storeTask(task);
+    }
+    storeTask(deletedOpen);
+    storeTask(deletedCompleted);
+    removeStoredTask(taskIndex.value(deletedOpen.id));
+    removeStoredTask(taskIndex.value(deletedCompleted.id));
+
+    for (QDate date = viewDate.addDays(-5); date <= viewDate.addDays(5); date = date.addDays(1)) {
+        QList<Task> expected = filterTasksForDateInternal(tasks, date);
+        std::sort(expected.begin(), expected.end(), [](const Task &a, const Task &b) {
+            return a.id < b.id;
+        });
+        QList<Task> actual = getTasksForDate(date);
+
+        QStringList expectedIds;
+        for (const Task &task : expected) {
+            expectedIds.append(task.id);
+        }
+        QStringList actualIds;
+        for (const Task &task : actual) {
+            actualIds.append(task.id);
+            Q_ASSERT(task.id != deletedOpen.id && task.id != deletedCompleted.id);
+        }
+        if (actualIds != expectedIds) {
+            qWarning("getTasksForDate(%s) differs from reference: %s vs %s",
+                     qPrintable(date.toString(Qt::ISODate)),
+                     qPrintable(actualIds.join(',')), qPrintable(expectedIds.join(',')));
+        }
+        Q_ASSERT(actualIds == expectedIds);
+    }
+
+    restoreTaskSnapshot(saved);
 }
 #endif
 
 QList<Task> Database::getTasksForDate(const QDate &date)
 {
-    QList<Task> allTasks = getAllTasks();
-    return filterTasksForDateInternal(allTasks, date);
+    QList<Task> result;
+    ensureTaskSegmentsFinishedSince(date, date, true);
+
+    // 未完成的任务从创建当天起一直顺延显示
+    for (const QString &id : openTaskIds) {
+        if (taskCreationDate(id) <= date) {
+            result.append(taskStore.at(taskIndex.value(id)));
+        }
+    }
+
+    // 已完成的任务显示到完成当天为止：只需遍历完成日期不早于查看日期的桶
+    for (auto it = finishedTasksByDay.lowerBound(date); it != finishedTasksByDay.end(); ++it) {
+        for (const QString &id : it.value()) {
+            const Task &task = taskStore.at(taskIndex.value(id));
+            if (task.status == TaskStatus_Completed && taskCreationDate(id) <= date) {
+                result.append(task);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const Task &a, const Task &b) {
+        return a.id < b.id;
+    });
+
+    return result;
 }
 
 QList<Task> Database::getTasksByStatus(TaskStatus status)
 {
     QList<Task> tasks;
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
+    ensureAllTaskSegments();
     
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        if (obj["status"].toInt() == static_cast<int>(status)) {
-            tasks.append(jsonToTask(obj));
+    for (const Task &task : taskStore) {
+        if (task.status == status) {
+            tasks.append(task);
         }
     }
     
@@ -1626,12 +2897,11 @@ QList<Task> Database::getTasksByStatus(TaskStatus status)
 QList<Task> Database::getTasksByCategory(int categoryId)
 {
     QList<Task> tasks;
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
+    ensureAllTaskSegments();
     
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        if (obj["categoryId"].toInt() == categoryId) {
-            tasks.append(jsonToTask(obj));
+    for (const Task &task : taskStore) {
+        if (task.categoryId == categoryId) {
+            tasks.append(task);
         }
     }
     
@@ -1641,22 +2911,16 @@ QList<Task> Database::getTasksByCategory(int categoryId)
 QList<Task> Database::getTasksByDateRange(const QDateTime &startDate, const QDateTime &endDate)
 {
     QList<Task> tasks;
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
     
     QDate startDateObj = startDate.date();
     QDate endDateObj = endDate.date();
+    ensureTaskSegmentsCreatedBetween(startDateObj, endDateObj);
     
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        QString taskId = obj["id"].toString();
-        
-        if (taskId.length() >= 8) {
-            QString dateStr = taskId.left(8);
-            QDate taskDate = QDate::fromString(dateStr, "yyyyMMdd");
-            
-            if (taskDate.isValid() && taskDate >= startDateObj && taskDate <= endDateObj) {
-                tasks.append(jsonToTask(obj));
-            }
+    auto it = tasksByDay.lowerBound(startDateObj);
+    auto end = tasksByDay.upperBound(endDateObj);
+    for (; it != end; ++it) {
+        for (const QString &id : it.value()) {
+            tasks.append(taskStore.at(taskIndex.value(id)));
         }
     }
     
@@ -1665,34 +2929,51 @@ QList<Task> Database::getTasksByDateRange(const QDateTime &startDate, const QDat
 
 QList<Task> Database::searchTasks(const QString &keyword)
 {
+    if (keyword.trimmed().isEmpty()) {
+        return getAllTasks();
+    }
+
+    ensureAllTaskSegments();
+
     QList<Task> tasks;
-    QList<Task> allTasks = getAllTasks();
-    
-    QString lowerKeyword = keyword.toLower();
-    
-    for (const Task &task : allTasks) {
-        if (task.title.toLower().contains(lowerKeyword) ||
-            task.description.toLower().contains(lowerKeyword)) {
-            tasks.append(task);
-        }
+    const QStringList ids = taskSearchIndex.search(keyword);
+    for (const QString &id : ids) {
+        tasks.append(taskStore.at(taskIndex.value(id)));
     }
     
     return tasks;
 }
 
+QHash<QString, int> Database::matchTaskIds(const QString &keyword) const
+{
+    return taskSearchIndex.match(keyword);
+}
+
+const Task *Database::findLoadedTask(const QString &id) const
+{
+    int index = taskIndex.value(id, -1);
+    return index >= 0 ? &taskStore.at(index) : nullptr;
+}
+
+bool Database::isTaskShownOnDate(const Task &task, const QDate &date)
+{
+    if (taskCreationDate(task.id) > date) {
+        return false;
+    }
+    // 已完成的任务显示到完成当天为止
+    return !(task.status == TaskStatus_Completed && task.completionTime.isValid()
+             && task.completionTime.date() < date);
+}
+
 Task Database::getTaskById(const QString &id)
 {
     Task task;
     task.id = "";
     
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        if (obj["id"].toString() == id) {
-            task = jsonToTask(obj);
-            break;
-        }
+    ensureTaskSegmentFor(id);
+    int index = taskIndex.value(id, -1);
+    if (index >= 0) {
+        task = taskStore.at(index);
     }
     
     return task;
@@ -1700,49 +2981,49 @@ Task Database::getTaskById(const QString &id)
 
 bool Database::updateTaskStatus(const QString &id, TaskStatus status)
 {
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    
-    for (int i = 0; i < tasksArray.size(); ++i) {
-        QJsonObject obj = tasksArray[i].toObject();
-        if (obj["id"].toString() == id) {
-            obj["status"] = static_cast<int>(status);
-            if (status == TaskStatus_Completed) {
-                obj["finishTime"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-            } else {
-                obj.remove("finishTime");
-            }
-            tasksArray[i] = obj;
-            break;
+    ensureTaskSegmentFor(id);
+    int index = taskIndex.value(id, -1);
+    if (index >= 0) {
+        Task &task = taskStore[index];
+        unindexTask(task);
+        task.status = status;
+        task.updatedAt = QDateTime::currentDateTime();
+        task.version = allocateTaskVersion();
+        if (status == TaskStatus_Completed) {
+            // 与持久化格式保持一致：完成时间精确到秒
+            QDateTime now = QDateTime::currentDateTime();
+            task.completionTime = now.addMSecs(-now.time().msec());
+        } else {
+            task.completionTime = QDateTime();
         }
+        indexTask(task);
+        markTaskSegmentDirty(id);
     }
-    
-    taskRootObject["tasks"] = tasksArray;
 
     bool result = saveTaskData();
     if (result) {
-        emit tasksChanged();
+        notifyTasksChanged(id);
     }
     return result;
 }
 
 bool Database::updateTaskDuration(const QString &id, double duration)
 {
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    
-    for (int i = 0; i < tasksArray.size(); ++i) {
-        QJsonObject obj = tasksArray[i].toObject();
-        if (obj["id"].toString() == id) {
-            obj["workDuration"] = duration;
-            tasksArray[i] = obj;
-            break;
-        }
+    ensureTaskSegmentFor(id);
+    int index = taskIndex.value(id, -1);
+    if (index >= 0) {
+        Task &task = taskStore[index];
+        unindexTask(task);
+        task.workDuration = duration;
+        task.updatedAt = QDateTime::currentDateTime();
+        task.version = allocateTaskVersion();
+        indexTask(task);
+        markTaskSegmentDirty(id);
     }
-    
-    taskRootObject["tasks"] = tasksArray;
 
     bool result = saveTaskData();
     if (result) {
-        emit tasksChanged();
+        notifyTasksChanged(id);
     }
     return result;
 }
@@ -1794,55 +3075,94 @@ QList<Category> Database::getBuiltinCategories()
     return categories;
 }
 
-QHash<QString, double> Database::getCategoryWorkHours(const QDateTime &startDate, const QDateTime &endDate)
+// 按完成时间统计：区间内整天直接取每日汇总，首尾两天按具体时间逐个判断
+TaskStats Database::getTaskStatsByFinishTime(const QDateTime &startDate, const QDateTime &endDate)
 {
-    QHash<QString, double> result;
-    QList<Category> categories = getBuiltinCategories();
-    for (const Category &cat : categories) {
-        result[cat.name] = 0.0;
-    }
-    
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        QDateTime finishTime = QDateTime::fromString(obj["finishTime"].toString(), Qt::ISODate);
-        if (finishTime.isValid() && finishTime >= startDate && finishTime <= endDate) {
-            int categoryId = obj["categoryId"].toInt(-1);
-            // 从内置分类中查找
-            for (const Category &cat : getBuiltinCategories()) {
-                if (cat.id == categoryId) {
-                    result[cat.name] += obj["workDuration"].toDouble(0.0);
-                    break;
-                }
+    TaskStats stats;
+    ensureTaskSegmentsFinishedSince(endDate.date(), startDate.date(), false);
+
+    auto it = statsByFinishedDay.lowerBound(startDate.date());
+    auto end = statsByFinishedDay.upperBound(endDate.date());
+    for (; it != end; ++it) {
+        QDate day = it.key();
+        bool wholeDay = QDateTime(day, QTime(0, 0)) >= startDate &&
+                        QDateTime(day, QTime(23, 59, 59, 999)) <= endDate;
+        if (wholeDay) {
+            mergeTaskStats(stats, it.value());
+            continue;
+        }
+
+        for (const QString &id : finishedTasksByDay.value(day)) {
+            const Task &task = taskStore.at(taskIndex.value(id));
+            if (task.completionTime >= startDate && task.completionTime <= endDate) {
+                accumulateTaskStats(stats, task, 1);
             }
         }
     }
 
+    return stats;
+}
+
+// 未加载的分段直接使用索引中的汇总，不必为统计总数解码历史数据
+TaskStats Database::getTaskStats()
+{
+    TaskStats stats = overallTaskStats;
+    for (const TaskSegment &segment : taskSegments) {
+        if (!segment.loaded) {
+            mergeTaskStats(stats, segment.stats);
+        }
+    }
+    return stats;
+}
+
+TaskStats Database::getTaskStatsByCreatedDate(const QDate &startDate, const QDate &endDate)
+{
+    TaskStats stats;
+    ensureTaskSegmentsCreatedBetween(startDate, endDate);
+
+    auto it = statsByCreatedDay.lowerBound(startDate);
+    auto end = statsByCreatedDay.upperBound(endDate);
+    for (; it != end; ++it) {
+        mergeTaskStats(stats, it.value());
+    }
+
+    return stats;
+}
+
+// 内置分类不会变化，首次使用时建立 ID 到名称的映射
+QString Database::categoryName(int categoryId)
+{
+    static const QHash<int, QString> names = []() {
+        QHash<int, QString> result;
+        for (const Category &category : getBuiltinCategories()) {
+            result.insert(category.id, category.name);
+        }
+        return result;
+    }();
+    return names.value(categoryId, "未分类");
+}
+
+QHash<QString, double> Database::getCategoryWorkHours(const QDateTime &startDate, const QDateTime &endDate)
+{
+    QHash<QString, double> result;
+    TaskStats stats = getTaskStatsByFinishTime(startDate, endDate);
+
+    // 只统计内置分类
+    for (const Category &cat : getBuiltinCategories()) {
+        result[cat.name] = stats.categories.value(cat.id).hours;
+    }
+
     return result;
 }
 
 QHash<QString, int> Database::getCategoryTaskCount(const QDateTime &startDate, const QDateTime &endDate)
 {
     QHash<QString, int> result;
-    QList<Category> categories = getBuiltinCategories();
-    for (const Category &cat : categories) {
-        result[cat.name] = 0;
-    }
-    
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        QDateTime finishTime = QDateTime::fromString(obj["finishTime"].toString(), Qt::ISODate);
-        if (finishTime.isValid() && finishTime >= startDate && finishTime <= endDate) {
-            int categoryId = obj["categoryId"].toInt(-1);
-            // 从内置分类中查找
-            for (const Category &cat : getBuiltinCategories()) {
-                if (cat.id == categoryId) {
-                    result[cat.name]++;
-                    break;
-                }
-            }
-        }
+    TaskStats stats = getTaskStatsByFinishTime(startDate, endDate);
+
+    // 只统计内置分类
+    for (const Category &cat : getBuiltinCategories()) {
+        result[cat.name] = stats.categories.value(cat.id).taskCount;
     }
 
     return result;
@@ -1850,81 +3170,32 @@ QHash<QString, int> Database::getCategoryTaskCount(const QDateTime &startDate, c
 
 double Database::getTotalWorkHours(const QDateTime &startDate, const QDateTime &endDate)
 {
-    double total = 0.0;
-    
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        QDateTime finishTime = QDateTime::fromString(obj["finishTime"].toString(), Qt::ISODate);
-        if (finishTime.isValid() && finishTime >= startDate && finishTime <= endDate) {
-            total += obj["workDuration"].toDouble(0.0);
-        }
-    }
-    
-    return total;
+    return getTaskStatsByFinishTime(startDate, endDate).hours;
 }
 
 int Database::getTotalTaskCount(const QDateTime &startDate, const QDateTime &endDate)
 {
-    int count = 0;
-    
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        QDateTime finishTime = QDateTime::fromString(obj["finishTime"].toString(), Qt::ISODate);
-        if (finishTime.isValid() && finishTime >= startDate && finishTime <= endDate) {
-            count++;
-        }
-    }
-    
-    return count;
+    return getTaskStatsByFinishTime(startDate, endDate).taskCount;
 }
 
 QString Database::generateTaskId()
 {
     QString dateStr = QDate::currentDate().toString("yyyyMMdd");
-    int sequenceNumber = getDailyTaskCount(dateStr) + 1;
+    ensureTaskSegmentFor(dateStr);
+    int sequenceNumber = taskIdSequences.value(dateStr) + 1;
     
+    // 序号表由 indexTask 维护，已覆盖加载过的和同步下发的任务；
+    // 再用哈希索引兜底检查一次，防止序号表缺失时重复
     QString taskId;
     do {
         QString sequenceStr = QString::number(sequenceNumber).rightJustified(4, '0');
         taskId = dateStr + sequenceStr;
         sequenceNumber++;
-    } while (taskExists(taskId));
+    } while (taskIndex.contains(taskId));
     
     return taskId;
 }
 
-bool Database::taskExists(const QString &taskId)
-{
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-    
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        if (obj["id"].toString() == taskId) {
-            return true;
-        }
-    }
-    
-    return false;
-}
-
-int Database::getDailyTaskCount(const QString &dateStr)
-{
-    int count = 0;
-    QJsonArray tasksArray = taskRootObject["tasks"].toArray();
-
-    for (const QJsonValue &val : tasksArray) {
-        QJsonObject obj = val.toObject();
-        QString taskId = obj["id"].toString();
-        if (taskId.startsWith(dateStr)) {
-            count++;
-        }
-    }
-
-    return count;
-}
-
 void Database::setCurrentUser(int userId)
 {
     qDebug() << "[Database] setCurrentUser:" << currentUserId << "->" << userId;
@@ -1934,61 +3205,124 @@ void Database::setCurrentUser(int userId)
         return;
     }
 
+    // 批量修改的快照属于当前用户的任务文件，不能跨用户提交
+    if (batchDepth > 0) {
+        qWarning() << "[Database] Cannot switch user while a batch is open";
+        return;
+    }
+
     // 保存当前用户数据
     if (!taskFilePath.isEmpty()) {
         saveTaskData();
     }
 
+    // 切回的用户可能还有未写完的任务文件，先等后台写完再读取
+    persistenceWorker->flush();
+
     // 更新当前用户ID
     currentUserId = userId;
 
     // 更新任务文件路径
     QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     if (userId > 0) {
-        taskFilePath = dataPath + QString("/user_%1/tasks.json").arg(userId);
+        taskFilePath = dataPath + QString("/user_%1/tasks%2").arg(userId).arg(StorageCodec::suffix(storageFormat));
         QDir dir(QFileInfo(taskFilePath).absolutePath());
         if (!dir.exists()) {
             dir.mkpath(".");
         }
         qDebug() << "[Database] Logged in, using user task file:" << taskFilePath;
     } else {
-        taskFilePath = dataPath + "/tasks.json";
+        taskFilePath = dataPath + "/tasks" + StorageCodec::suffix(storageFormat);
         qDebug() << "[Database] Logged out, using default task file:" << taskFilePath;
     }
 
     // 清空当前数据并重新加载
     taskRootObject = QJsonObject();
-    taskRootObject["tasks"] = QJsonArray();
+    clearTaskStore();
     loadTaskData();
 
     // 发出信号通知UI刷新
-    emit tasksChanged();
+    notifyTasksChanged();
 }
 
 bool Database::loadTaskData()
 {
-    QFile file(taskFilePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        // 文件不存在，初始化为空数据
+    syncLogStore.open(taskSyncLogPath());
+
+    // 当前格式的任务文件不存在时依次尝试临时文件、备份和另一种格式的文件，读到后按当前格式重写
+    QString loadedPath;
+    for (const QString &path : storageFileCandidates(taskFilePath)) {
+        if (QFile::exists(path) && readStorageFile(path, &taskRootObject)) {
+            loadedPath = path;
+            break;
+        }
+    }
+    bool migrated = !loadedPath.isEmpty() && loadedPath != taskFilePath;
+    if (migrated) {
+        qWarning("Task file unavailable, loaded from: %s", qPrintable(loadedPath));
+    }
+
+    if (loadedPath.isEmpty()) {
+        // 文件不存在或无法解析，初始化为空数据；分段文件还在时从中恢复
         taskRootObject = QJsonObject();
-        taskRootObject["tasks"] = QJsonArray();
+        clearTaskStore();
+        recoverTaskSegments();
+        if (!taskSegments.isEmpty()) {
+            saveTaskData();
+        }
         return false;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
+    // 旧版单文件格式：全部任务在主文件中，加载后拆分为分段重新写出
+    bool legacyLayout = taskRootObject.contains("tasks");
+    if (legacyLayout) {
+        loadTaskStore(taskRootObject["tasks"].toArray());
+        taskRootObject.remove("tasks");
+    } else {
+        clearTaskStore();
+    }
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) {
-        taskRootObject = QJsonObject();
-        taskRootObject["tasks"] = QJsonArray();
-        return false;
+    // 分段只读入索引信息，任务本身在查询涉及时再加载
+    const QJsonObject segmentsObject = taskRootObject["segments"].toObject();
+    for (auto it = segmentsObject.constBegin(); it != segmentsObject.constEnd(); ++it) {
+        if (taskSegments.contains(it.key())) {
+            continue;
+        }
+        QJsonObject meta = it.value().toObject();
+        TaskSegment segment;
+        segment.openCount = meta["open"].toInt();
+        segment.lastFinished = QDate::fromString(meta["lastFinished"].toString(), Qt::ISODate);
+        segment.maxVersion = meta["maxVersion"].toVariant().toLongLong();
+        segment.stats = jsonToTaskStats(meta["stats"].toObject());
+        taskSegments.insert(it.key(), segment);
     }
+    taskRootObject.remove("segments");
 
-    taskRootObject = doc.object();
+    const QJsonObject sequencesObject = taskRootObject["idSequences"].toObject();
+    for (auto it = sequencesObject.constBegin(); it != sequencesObject.constEnd(); ++it) {
+        int &maxSequence = taskIdSequences[it.key()];
+        maxSequence = qMax(maxSequence, it.value().toInt());
+    }
+    taskRootObject.remove("idSequences");
+
+    const QJsonObject tombstonesObject = taskRootObject["tombstones"].toObject();
+    for (auto it = tombstonesObject.constBegin(); it != tombstonesObject.constEnd(); ++it) {
+        taskTombstones.insert(it.key(), it.value().toVariant().toLongLong());
+    }
+    taskRootObject.remove("tombstones");
+
+    loadTaskSyncBases();
 
-    if (!taskRootObject.contains("tasks")) {
-        taskRootObject["tasks"] = QJsonArray();
+    bool legacySyncLogs = taskRootObject.contains("syncLogs");
+    if (legacySyncLogs) {
+        migrateSyncLogs();
+    }
+
+    // 当前月份几乎总会被查看，启动时直接加载
+    loadTaskSegment(QDate::currentDate().toString("yyyy-MM"));
+
+    if (migrated || legacyLayout || legacySyncLogs) {
+        saveTaskData();
     }
 
     return true;
@@ -1996,15 +3330,90 @@ bool Database::loadTaskData()
 
 bool Database::saveTaskData()
 {
-    QJsonDocument doc(taskRootObject);
-    QFile file(taskFilePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning("Cannot save task file: %s", qPrintable(file.errorString()));
-        return false;
+    if (batchDepth > 0) {
+        batchTasksDirty = true;
+        return true;
     }
 
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    // 只重写有改动的分段，同时重新计算这些分段的索引信息
+    QHash<QString, QJsonArray> dirtySegments;
+    for (auto it = taskSegments.begin(); it != taskSegments.end(); ++it) {
+        if (it.value().dirty) {
+            dirtySegments.insert(it.key(), QJsonArray());
+            it.value().openCount = 0;
+            it.value().lastFinished = QDate();
+            it.value().maxVersion = 0;
+            it.value().stats = TaskStats();
+        }
+    }
+
+    if (!dirtySegments.isEmpty()) {
+        for (const Task &task : taskStore) {
+            QString key = taskSegmentKey(task.id);
+            auto found = dirtySegments.find(key);
+            if (found == dirtySegments.end()) {
+                continue;
+            }
+            found.value().append(taskToJson(task));
+
+            TaskSegment &segment = taskSegments[key];
+            accumulateTaskStats(segment.stats, task, 1);
+            segment.maxVersion = qMax(segment.maxVersion, task.version);
+            if (key != TASK_SEGMENT_UNDATED &&
+                (task.status != TaskStatus_Completed || !task.completionTime.isValid())) {
+                segment.openCount++;
+            }
+            if (task.completionTime.isValid() &&
+                (!segment.lastFinished.isValid() || task.completionTime.date() > segment.lastFinished)) {
+                segment.lastFinished = task.completionTime.date();
+            }
+        }
+
+        QDir().mkpath(QFileInfo(taskSegmentPath(dirtySegments.constBegin().key())).absolutePath());
+        for (auto it = dirtySegments.constBegin(); it != dirtySegments.constEnd(); ++it) {
+            QJsonObject segmentObject;
+            segmentObject["tasks"] = it.value();
+            persistenceWorker->enqueue(taskSegmentPath(it.key()), segmentObject, storageFormat);
+            taskSegments[it.key()].dirty = false;
+        }
+    }
+
+    // 主文件保存版本号、同步状态和分段索引；同步日志由 SyncLogStore 写入单独的环形文件
+    QJsonObject segmentsObject;
+    for (auto it = taskSegments.constBegin(); it != taskSegments.constEnd(); ++it) {
+        QJsonObject meta;
+        meta["open"] = it.value().openCount;
+        meta["lastFinished"] = it.value().lastFinished.toString(Qt::ISODate);
+        meta["maxVersion"] = it.value().maxVersion;
+        meta["stats"] = taskStatsToJson(it.value().stats);
+        segmentsObject[it.key()] = meta;
+    }
+
+    QJsonObject sequencesObject;
+    for (auto it = taskIdSequences.constBegin(); it != taskIdSequences.constEnd(); ++it) {
+        sequencesObject[it.key()] = it.value();
+    }
+
+    QJsonObject tombstonesObject;
+    for (auto it = taskTombstones.constBegin(); it != taskTombstones.constEnd(); ++it) {
+        tombstonesObject[it.key()] = it.value();
+    }
+
+    QJsonObject root = taskRootObject;
+    root["segments"] = segmentsObject;
+    root["idSequences"] = sequencesObject;
+    root["tombstones"] = tombstonesObject;
+    persistenceWorker->enqueue(taskFilePath, root, storageFormat);
+
+    // 同步基准可能很大，只在有改动时重写
+    if (taskSyncBasesDirty) {
+        QJsonObject basesObject;
+        for (auto it = taskSyncBases.constBegin(); it != taskSyncBases.constEnd(); ++it) {
+            basesObject[it.key()] = it.value();
+        }
+        persistenceWorker->enqueue(taskSyncBasePath(), basesObject, storageFormat);
+        taskSyncBasesDirty = false;
+    }
 
     return true;
 }
@@ -2022,7 +3431,7 @@ bool Database::migrateTaskData()
     QJsonArray tasksArray = rootObject["tasks"].toArray();
 
     taskRootObject = QJsonObject();
-    taskRootObject["tasks"] = tasksArray;
+    loadTaskStore(tasksArray);
 
     // 保存任务文件
     saveTaskData();
@@ -9,6 +9,16 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include "storagecodec.h"
+#include "searchindex.h"
+#include "synclogstore.h"
+
+class QTimer;
+class PersistenceWorker;
 
 enum AppType {
     AppType_Executable,
@@ -201,19 +211,58 @@ struct Category {
     int sortOrder;
 };
 
+struct TaskCategoryStats {
+    int taskCount;
+    int completedCount;
+    double hours;            // 全部任务工时
+    double completedHours;   // 已完成任务工时
+
+    TaskCategoryStats() : taskCount(0), completedCount(0), hours(0), completedHours(0) {}
+};
+
+// 一组任务的汇总统计，按日期增量维护，区间统计只需合并区间内每天的汇总
+struct TaskStats {
+    int taskCount;
+    int completedCount;
+    double hours;
+    double completedHours;
+    QHash<int, TaskCategoryStats> categories;  // 分类ID → 该分类的汇总
+
+    TaskStats() : taskCount(0), completedCount(0), hours(0), completedHours(0) {}
+};
+
 class Database : public QObject
 {
     Q_OBJECT
 signals:
     void appsChanged();
     void tasksChanged();
+    // 与 tasksChanged 同时发出，说明变化的范围：单个任务的增删改发出 taskChanged，
+    // 批量修改、切换用户等整体变化发出 tasksReset
+    void taskChanged(const QString &id);
+    void tasksReset();
+    // 后台写盘失败（磁盘已满、目录无权限等），内存中的数据仍然有效
+    void saveFailed(const QString &filePath, const QString &error);
 public:
     explicit Database(QObject *parent = nullptr);
     ~Database();
 
     bool init();
+    // 等待后台线程把所有待保存的数据写入磁盘，退出前调用
+    bool flush();
+    // 数据文件格式，切换后立即按新格式重写 data 与当前用户的任务文件，旧格式文件在写入成功后删除
+    StorageCodec::Format getStorageFormat() const { return storageFormat; }
+    void setStorageFormat(StorageCodec::Format format);
     void setCurrentUser(int userId);
     int getCurrentUserId() const { return currentUserId; }
+
+    // 批量修改：beginBatch() 与 commitBatch() 之间的修改只在提交时写一次文件、发一次变更信号。
+    // rollbackBatch() 恢复到 beginBatch() 时的内存状态；可嵌套，以最外层为准，
+    // 内层回滚后外层的 commitBatch() 返回 false。文件在后台写入，写入失败通过 saveFailed 通知，不回滚内存中的修改
+    void beginBatch();
+    bool commitBatch();
+    void rollbackBatch();
+    bool inBatch() const { return batchDepth > 0; }
     
     bool addApp(const AppInfo &app);
     bool updateApp(const AppInfo &app);
@@ -292,51 +341,227 @@ public:
     bool updateTaskVersion(const QString& id);     // 更新任务的版本号
     QList<Task> getTasksModifiedSince(const QDateTime& since);  // 获取指定时间后修改的任务
 
+    // 增量同步：本地每次修改任务都会分配新的版本号，删除留下删除记录，
+    // 上传时只发送版本号大于上次同步版本的任务和删除记录
+    qint64 currentTaskVersion() const;                     // 当前已分配的最大任务版本号
+    QList<Task> getTasksChangedSince(qint64 version);      // 版本号大于 version 的任务
+    QStringList getDeletedTaskIdsSince(qint64 version) const;  // 版本号大于 version 的删除记录
+    bool hasTaskTombstone(const QString& id) const;        // 任务是否有尚未确认上传的删除记录
+    SyncState getTaskSyncState();                          // 任务整体的同步状态
+    bool markTasksSynced(qint64 version);                  // 确认 version 及之前的修改已上传
+    // 增量下载的起点：服务器分配的修改序号，只在下载的任务合并成功后推进，与上传时间无关
+    qint64 getTaskDownloadCursor() const;
+    bool setTaskDownloadCursor(qint64 cursor);
+    int getPendingTaskSyncCount();                         // 尚未上传的任务修改和删除数（同一任务多次修改只计一次）
+
+    // 三方合并的基准：每个任务最近一次与云端一致时的内容（同步格式的 JSON），
+    // 与同步状态一起保存在任务文件旁，合并时据此判断本地和云端各自改了哪些字段
+    QJsonObject getTaskSyncBase(const QString& id) const;          // 没有基准时返回空对象
+    void setTaskSyncBase(const QString& id, const QJsonObject& base);  // base 为空时删除；随下一次保存任务文件写出
+
     // 同步状态管理
     bool saveSyncState(const SyncState& state);
     SyncState getSyncState(const QString& entityType, const QString& entityId);
     bool updateLastSyncTime(const QString& entityType, const QString& entityId, qint64 version);
 
-    // 同步日志
+    // 同步日志：保存在任务文件旁的环形文件中，写满后覆盖最旧的记录，不随任务文件重写。
+    // 按从新到旧排列，offset/limit 用于分页；before 有效时只取早于该时间的记录
     bool addSyncLog(const SyncLog& log);
-    QList<SyncLog> getSyncLogs(const QString& entityType = QString(), int limit = 100);
+    QList<SyncLog> getSyncLogs(const QString& entityType = QString(), int limit = 100,
+                               int offset = 0, const QDateTime& before = QDateTime());
+    int getSyncLogCount(const QString& entityType = QString(), const QDateTime& before = QDateTime()) const;
     bool clearSyncLogs();
     QList<Task> getAllTasks();
     QList<Task> getTasksForDate(const QDate &date);
     QList<Task> getTasksByStatus(TaskStatus status);
     QList<Task> getTasksByCategory(int categoryId);
     QList<Task> getTasksByDateRange(const QDateTime &startDate, const QDateTime &endDate);
+    // 按相关度排序的全文搜索（全部历史任务）
     QList<Task> searchTasks(const QString &keyword);
+    // 已加载任务中命中关键字的任务ID及相关度得分，用于在已有列表上过滤
+    QHash<QString, int> matchTaskIds(const QString &keyword) const;
     Task getTaskById(const QString &id);
+    // 直接访问已加载的任务，不加载分段、不复制；返回的指针在下一次修改任务前有效
+    const Task *findLoadedTask(const QString &id) const;
+    // 任务是否显示在指定日期的列表中，与 getTasksForDate 的规则一致
+    static bool isTaskShownOnDate(const Task &task, const QDate &date);
+    // 任务的创建日期，取自任务ID的前8位；getTasksByDateRange 按它筛选，ID 中没有日期时无效
+    static QDate taskCreationDate(const QString &taskId);
     bool updateTaskStatus(const QString &id, TaskStatus status);
     bool updateTaskDuration(const QString &id, double duration);
 
     static QList<Category> getBuiltinCategories();
+    // 内置分类的名称，未知的 ID 返回"未分类"
+    static QString categoryName(int categoryId);
 
     QHash<QString, double> getCategoryWorkHours(const QDateTime &startDate, const QDateTime &endDate);
     QHash<QString, int> getCategoryTaskCount(const QDateTime &startDate, const QDateTime &endDate);
     double getTotalWorkHours(const QDateTime &startDate, const QDateTime &endDate);
     int getTotalTaskCount(const QDateTime &startDate, const QDateTime &endDate);
 
-    // 公开方法供外部调用保存和转换任务数据
+    // 全部任务的汇总，以及按创建日期（任务ID日期）落在区间内的任务汇总，耗时与区间天数成正比
+    TaskStats getTaskStats();
+    TaskStats getTaskStatsByCreatedDate(const QDate &startDate, const QDate &endDate);
+
+    // 公开方法供外部调用保存和转换任务数据。写入在后台进行，返回时只是加入了写入队列
     bool saveTaskData();
     QJsonObject taskToJson(const Task &task);
 
+private slots:
+    void compactJournal();
+    void onPersistenceWriteFinished(const QString &filePath, qint64 tag);
+
 private:
+    // 任务文件按创建月份分段存放，未加载的分段只保留索引中的汇总信息，
+    // 查询涉及到该月份时才映射文件并解码
+    struct TaskSegment {
+        bool loaded;
+        bool dirty;
+        int openCount;          // 未完成或缺少完成时间的任务数，会顺延显示到之后的日期
+        QDate lastFinished;     // 段内最晚的完成日期
+        qint64 maxVersion;      // 段内最大的任务版本号，增量同步时据此决定是否需要加载
+        TaskStats stats;
+        TaskSegment() : loaded(false), dirty(false), openCount(0), maxVersion(0) {}
+    };
+
+    struct DataSnapshot {
+        QJsonObject rootObject;
+        int nextAppId;
+        int nextCollectionId;
+        int nextRemoteDesktopId;
+        int nextSnapshotId;
+    };
+
+    struct TaskSnapshot {
+        QJsonObject taskRootObject;
+        QVector<Task> taskStore;
+        QHash<QString, int> taskIndex;
+        QMap<QDate, QVector<QString>> tasksByDay;
+        QMap<QDate, QVector<QString>> finishedTasksByDay;
+        QSet<QString> openTaskIds;
+        TaskStats overallTaskStats;
+        QMap<QDate, TaskStats> statsByCreatedDay;
+        QMap<QDate, TaskStats> statsByFinishedDay;
+        QMap<QString, TaskSegment> taskSegments;
+        SearchIndex taskSearchIndex;
+        QHash<QString, int> taskIdSequences;
+        QMultiMap<qint64, QString> taskIdsByVersion;
+        QHash<QString, qint64> taskTombstones;
+        QHash<QString, QJsonObject> taskSyncBases;
+        bool taskSyncBasesDirty;
+    };
+
     QString dataFilePath;
     QString taskFilePath;
     int currentUserId;
     QJsonObject rootObject;
-    QJsonObject taskRootObject;
+    QJsonObject taskRootObject;   // 任务文件中除任务列表外的部分（版本号、同步状态）
     int nextAppId;
     int nextCollectionId;
     int nextRemoteDesktopId;
     int nextSnapshotId;
 
+    // data.json 的追加式日志：变更先追加到日志，再由空闲时的合并写回快照
+    // journalSeq 为最后一条日志的序号，跨合并递增；快照记录其包含到的序号，回放时跳过更早的记录
+    QString journalFilePath;
+    StorageCodec::Format storageFormat;
+    qint64 journalSeq;
+    int journalRecordCount;
+    bool journalEnabled;
+    QTimer *compactTimer;
+    PersistenceWorker *persistenceWorker;
+
+    // 运行时任务存储：taskStore 为唯一数据源，taskIndex 按任务ID映射到下标，
+    // 只有在写入任务文件时才转换为 JSON
+    QVector<Task> taskStore;
+    QHash<QString, int> taskIndex;
+
+    // 按日期的二级索引，随任务增删改增量维护，桶内任务ID有序
+    QMap<QDate, QVector<QString>> tasksByDay;          // 创建日期（取自任务ID前8位）
+    QMap<QDate, QVector<QString>> finishedTasksByDay;  // 完成时间所在日期，含所有有完成时间的任务
+    QSet<QString> openTaskIds;                         // 未完成或缺少完成时间的任务，会顺延显示到之后的日期
+
+    // 与上面索引同步维护的每日汇总，只覆盖已加载的任务
+    TaskStats overallTaskStats;
+    QMap<QDate, TaskStats> statsByCreatedDay;
+    QMap<QDate, TaskStats> statsByFinishedDay;
+
+    // 任务分段，键为创建月份（yyyy-MM）
+    QMap<QString, TaskSegment> taskSegments;
+    // 每天已分配过的最大任务序号（键为 yyyyMMdd），随任务文件保存，
+    // 删除任务后序号也不回退，避免同一ID先后指向不同任务
+    QHash<QString, int> taskIdSequences;
+
+    // 已加载任务按版本号排列，增量上传时直接取大于上次同步版本的部分
+    QMultiMap<qint64, QString> taskIdsByVersion;
+    // 删除记录：任务ID -> 删除时分配的版本号，随任务文件保存，确认上传后清理
+    QHash<QString, qint64> taskTombstones;
+    // 同步基准：任务ID -> 上次同步时的内容，单独成文件，只在有改动时随任务文件写出
+    QHash<QString, QJsonObject> taskSyncBases;
+    bool taskSyncBasesDirty;
+    // 同步日志，随任务文件所属用户切换
+    SyncLogStore syncLogStore;
+
+    // 全文索引：任务随 indexTask/unindexTask 维护；快照和远程桌面随日志操作维护，
+    // 整体替换（加载、回滚）后标记失效，下次搜索时重建
+    SearchIndex taskSearchIndex;
+    SearchIndex snapshotSearchIndex;
+    SearchIndex remoteDesktopSearchIndex;
+    bool dataSearchIndexValid;
+
+    // 批量修改状态
+    int batchDepth;
+    bool batchAborted;
+    bool batchTasksDirty;
+    bool batchAppsChanged;
+    bool batchTasksChanged;
+    QJsonArray batchOps;
+    DataSnapshot batchDataSnapshot;
+    TaskSnapshot batchTaskSnapshot;
+
     bool loadData();
     bool saveData();
+    bool commitData(const QJsonArray &ops);
+    bool appendJournal(const QJsonArray &ops);
+    int replayJournal(qint64 baseSeq);
+    bool readStorageFile(const QString &filePath, QJsonObject *object);
+    void trimJournal(qint64 compactedSeq);
+    void updateDataSearchIndex(const QJsonArray &ops);
+    void rebuildDataSearchIndex();
+    void applyJournalOp(const QJsonObject &op);
     bool loadTaskData();
     bool migrateTaskData();
+    void loadTaskStore(const QJsonArray &tasksArray);
+    void clearTaskStore();
+    int storeTask(const Task &task);
+    void removeStoredTask(int index);
+    QString taskSegmentPath(const QString &key) const;
+    QString taskSyncBasePath() const;
+    QString taskSyncLogPath() const;
+    void migrateSyncLogs();
+    void loadTaskSyncBases();
+    bool readTaskSegmentFile(const QString &path, QJsonObject *object);
+    bool loadTaskSegment(const QString &key);
+    void recoverTaskSegments();
+    void ensureTaskSegmentFor(const QString &taskId);
+    void ensureAllTaskSegments();
+    void ensureTaskSegmentsCreatedBetween(const QDate &startDate, const QDate &endDate);
+    void ensureTaskSegmentsChangedSince(qint64 version);
+    void ensureTaskSegmentsFinishedSince(const QDate &until, const QDate &finishedFrom, bool includeOpen);
+    void markTaskSegmentDirty(const QString &taskId);
+    void resetBatchState();
+    DataSnapshot takeDataSnapshot() const;
+    void restoreDataSnapshot(const DataSnapshot &snapshot);
+    TaskSnapshot takeTaskSnapshot() const;
+    void restoreTaskSnapshot(const TaskSnapshot &snapshot);
+    void notifyAppsChanged();
+    void notifyTasksChanged(const QString &id = QString());
+#ifdef QT_DEBUG
+    void runTaskFilterTests();
+#endif
+    void indexTask(const Task &task);
+    void unindexTask(const Task &task);
+    TaskStats getTaskStatsByFinishTime(const QDateTime &startDate, const QDateTime &endDate);
     QJsonObject appToJson(const AppInfo &app);
     AppInfo jsonToApp(const QJsonObject &obj);
     QJsonObject collectionToJson(const AppCollection &collection);
@@ -349,8 +574,35 @@ private:
     QString encryptPassword(const QString &password);
     QString decryptPassword(const QString &encrypted);
     QString generateTaskId();
-    int getDailyTaskCount(const QString &dateStr);
-    bool taskExists(const QString &taskId);
+    qint64 allocateTaskVersion();
+};
+
+// 作用域内的批量修改：未调用 commit() 即离开作用域时自动回滚
+class DatabaseTransaction
+{
+public:
+    explicit DatabaseTransaction(Database *db) : m_db(db), m_finished(false) { m_db->beginBatch(); }
+    ~DatabaseTransaction() { rollback(); }
+
+    bool commit()
+    {
+        if (m_finished) return false;
+        m_finished = true;
+        return m_db->commitBatch();
+    }
+
+    void rollback()
+    {
+        if (m_finished) return;
+        m_finished = true;
+        m_db->rollbackBatch();
+    }
+
+private:
+    Q_DISABLE_COPY(DatabaseTransaction)
+
+    Database *m_db;
+    bool m_finished;
 };
 
 Q_DECLARE_METATYPE(RemoteDesktopConnection)
@@ -1,27 +1,41 @@
 #include "networkmonitor.h"
 #include <QNetworkReply>
 #include <QHostAddress>
+#include <QSettings>
+
+// 离线时的探测间隔：从 5 秒起每次翻倍，最长 5 分钟
+#define NETWORK_OFFLINE_CHECK_BASE_MS 5000
+#define NETWORK_OFFLINE_CHECK_MAX_MS (5 * 60 * 1000)
+// 单个探测地址的超时
+#define NETWORK_PROBE_TIMEOUT_MS 3000
 
 NetworkMonitor* NetworkMonitor::s_instance = nullptr;
 
 NetworkMonitor::NetworkMonitor(QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_networkManager(nullptr)
     , m_checkTimer(new QTimer(this))
     , m_isOnline(true)
     , m_isSyncing(false)
-    , m_checkInterval(5000)
+    , m_monitoring(false)
+    , m_checkInterval(60000)
+    , m_offlineChecks(0)
+    , m_recheckPending(false)
 {
-    // 连接网络状态变化信号
-    connect(m_networkManager, &QNetworkAccessManager::networkAccessibleChanged,
-            this, &NetworkMonitor::onNetworkAccessibleChanged);
-
-    // 连接定时器检查
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    // 系统的在线状态只用来触发探测，是否在线仍以探测结果为准（虚拟网卡等情况下系统的判断并不可靠）
+    QT_WARNING_PUSH
+    QT_WARNING_DISABLE_DEPRECATED
+    m_configManager = new QNetworkConfigurationManager(this);
+    connect(m_configManager, &QNetworkConfigurationManager::onlineStateChanged,
+            this, [this](bool) { notifyNetworkChanged(); });
+    QT_WARNING_POP
+#endif
+
+    // 每次检查后按当前状态重新安排，定时器只触发一次
+    m_checkTimer->setSingleShot(true);
     connect(m_checkTimer, &QTimer::timeout,
             this, &NetworkMonitor::checkNetworkStatus);
-
-    // 初始检查
-    QTimer::singleShot(1000, this, &NetworkMonitor::checkNetworkStatus);
 }
 
 NetworkMonitor::~NetworkMonitor()
@@ -40,20 +54,54 @@ NetworkMonitor* NetworkMonitor::instance()
 void NetworkMonitor::setCheckInterval(int intervalMs)
 {
     m_checkInterval = intervalMs;
-    m_checkTimer->setInterval(intervalMs);
+    scheduleNextCheck();
+}
+
+void NetworkMonitor::setNetworkManager(QNetworkAccessManager* manager)
+{
+    m_networkManager = manager;
+}
+
+void NetworkMonitor::setProbeTargets(const QStringList& urls)
+{
+    m_probeTargets = urls;
+}
+
+void NetworkMonitor::setDefaultProbeTarget(const QString& url)
+{
+    m_defaultProbeTarget = url;
+}
+
+QStringList NetworkMonitor::probeTargets() const
+{
+    QStringList targets = QSettings().value("network/probeUrls").toStringList();
+    if (targets.isEmpty()) {
+        targets = m_probeTargets;
+    }
+    if (targets.isEmpty() && !m_defaultProbeTarget.isEmpty()) {
+        targets.append(m_defaultProbeTarget);
+    }
+    return targets;
 }
 
 void NetworkMonitor::startMonitoring()
 {
-    if (!m_checkTimer->isActive()) {
-        m_checkTimer->start(m_checkInterval);
+    if (!m_monitoring) {
+        m_monitoring = true;
         qDebug() << "NetworkMonitor: Started monitoring with interval" << m_checkInterval << "ms";
+        // 初始检查
+        m_checkTimer->start(1000);
     }
 }
 
 void NetworkMonitor::stopMonitoring()
 {
+    m_monitoring = false;
+    m_recheckPending = false;
     m_checkTimer->stop();
+    if (m_probeReply) {
+        m_probeReply->abort();
+    }
     qDebug() << "NetworkMonitor: Stopped monitoring";
 }
 
@@ -65,45 +113,124 @@ void NetworkMonitor::setSyncing(bool syncing)
     }
 }
 
-void NetworkMonitor::checkNetworkStatus()
+void NetworkMonitor::notifyNetworkChanged()
+{
+    m_offlineChecks = 0;
+    if (!m_monitoring) {
+        return;
+    }
+    // 进行中的探测可能发生在变化之前，结束后由 scheduleNextCheck 再探测一次
+    if (m_probeReply) {
+        m_recheckPending = true;
+        return;
+    }
+    qDebug() << "NetworkMonitor: System reported a network change, probing now";
+    m_checkTimer->stop();
+    probeTarget(0);
+}
+
+void NetworkMonitor::reportRequestResult(bool reachable)
+{
+    m_lastCheckTime = QDateTime::currentDateTime();
+    updateOnlineStatus(reachable);
+    // 请求结果已经说明了网络状态，推迟下一次探测
+    scheduleNextCheck();
+}
+
+void NetworkMonitor::scheduleNextCheck()
 {
-    // 使用 QNetworkAccessManager 的网络可达性检查
-    QNetworkAccessManager::NetworkAccessibility accessibility = m_networkManager->networkAccessible();
+    if (!m_monitoring || m_probeReply) {
+        return;
+    }
+    if (m_recheckPending) {
+        m_recheckPending = false;
+        m_checkTimer->stop();
+        probeTarget(0);
+        return;
+    }
 
-    bool online = (accessibility == QNetworkAccessManager::Accessible);
-    if (!online) {
-        // 尝试通过发送简单的请求来检查网络
-        QNetworkRequest request;
-        request.setUrl(QUrl("https://www.google.com/generate_204"));
-        request.setHeader(QNetworkRequest::UserAgentHeader, "PonyWork/1.0");
+    int interval = m_checkInterval;
+    if (!m_isOnline) {
+        interval = NETWORK_OFFLINE_CHECK_MAX_MS;
+        if (m_offlineChecks < 16) {
+            interval = qMin(NETWORK_OFFLINE_CHECK_BASE_MS << m_offlineChecks, NETWORK_OFFLINE_CHECK_MAX_MS);
+        }
+    }
+    m_checkTimer->start(interval);
+}
 
-        QNetworkReply* reply = m_networkManager->get(request);
-        QObject::connect(reply, &QNetworkReply::finished, [this, reply]() {
-            bool online = (reply->error() == QNetworkReply::NoError);
-            reply->deleteLater();
-            updateOnlineStatus(online);
-        });
+void NetworkMonitor::checkNetworkStatus()
+{
+    if (m_probeReply) {
+        return;
+    }
 
-        // 设置超时
-        QTimer::singleShot(3000, this, [this, reply]() {
-            if (reply->isRunning()) {
-                reply->abort();
-                reply->deleteLater();
-            }
-        });
-    } else {
-        updateOnlineStatus(online);
+    // 在线且最近有请求成功时无需探测
+    if (m_isOnline && m_lastCheckTime.isValid()
+        && m_lastCheckTime.msecsTo(QDateTime::currentDateTime()) < m_checkInterval) {
+        scheduleNextCheck();
+        return;
     }
+
+    probeTarget(0);
 }
 
-void NetworkMonitor::onNetworkAccessibleChanged(QNetworkAccessManager::NetworkAccessibility accessible)
+void NetworkMonitor::probeTarget(int index)
 {
-    bool online = (accessible == QNetworkAccessManager::Accessible);
-    updateOnlineStatus(online);
+    const QStringList targets = probeTargets();
+    if (index >= targets.size()) {
+        // 所有探测地址都不可达时为离线；没有配置探测地址时保持现状，由请求结果决定
+        if (!targets.isEmpty()) {
+            m_lastCheckTime = QDateTime::currentDateTime();
+            updateOnlineStatus(false);
+        }
+        scheduleNextCheck();
+        return;
+    }
+
+    if (!m_networkManager) {
+        m_networkManager = new QNetworkAccessManager(this);
+    }
+
+    QNetworkRequest request;
+    request.setUrl(QUrl(targets.at(index)));
+    request.setHeader(QNetworkRequest::UserAgentHeader, "PonyWork/1.0");
+
+    QNetworkReply* reply = m_networkManager->get(request);
+    m_probeReply = reply;
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, index]() {
+        // 收到任意 HTTP 响应说明服务器可达；连接失败、超时时尝试下一个地址
+        bool reachable = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() > 0;
+        reply->deleteLater();
+        m_probeReply = nullptr;
+
+        if (!reachable && m_monitoring) {
+            probeTarget(index + 1);
+            return;
+        }
+        if (reachable) {
+            m_lastCheckTime = QDateTime::currentDateTime();
+            updateOnlineStatus(true);
+        }
+        scheduleNextCheck();
+    });
+
+    // 设置超时，abort 会触发 finished
+    QTimer::singleShot(NETWORK_PROBE_TIMEOUT_MS, reply, [reply]() {
+        if (reply->isRunning()) {
+            reply->abort();
+        }
+    });
 }
 
 void NetworkMonitor::updateOnlineStatus(bool online)
 {
+    if (online) {
+        m_offlineChecks = 0;
+    } else if (!m_isOnline) {
+        m_offlineChecks++;
+    }
+
     if (m_isOnline != online) {
         m_isOnline = online;
         qDebug() << "NetworkMonitor: Network status changed to" << (online ? "Online" : "Offline");
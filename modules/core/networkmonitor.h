@@ -3,9 +3,20 @@
 
 #include <QObject>
 #include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QStringList>
+#include <QDateTime>
 #include <QTimer>
 #include <QDebug>
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#include <QNetworkConfigurationManager>
+#endif
 
+// 网络状态监控。在线状态只取自实际的 API 请求结果（由 ApiClient 通过 reportRequestResult 上报）
+// 和探测结果；一段时间没有请求时才访问探测地址。探测使用 ApiClient 注入的共享 QNetworkAccessManager。
+// 离线时探测间隔从 5 秒起指数增长，最长 5 分钟，恢复在线时重置。
+// 系统报告网络连接变化（QNetworkConfigurationManager）或从睡眠恢复时不等退避结束，立即重新探测
 class NetworkMonitor : public QObject
 {
     Q_OBJECT
@@ -18,11 +29,26 @@ public:
 
     bool isOnline() const { return m_isOnline; }
     bool isSyncing() const { return m_isSyncing; }
+    // 最近一次确认网络状态的时间（请求结果或探测），无效表示尚未确认
+    QDateTime lastCheckTime() const { return m_lastCheckTime; }
 
-    // 设置检查间隔（毫秒），默认5000ms
+    // 在线时没有请求的情况下多久探测一次（毫秒），默认60秒
     void setCheckInterval(int intervalMs);
     int getCheckInterval() const { return m_checkInterval; }
 
+    // 探测地址依次尝试，收到任意 HTTP 响应即视为在线。
+    // 设置项 network/probeUrls 优先，其次为 setProbeTargets，都为空时使用默认地址（同步服务器的健康检查接口）
+    void setProbeTargets(const QStringList& urls);
+    void setDefaultProbeTarget(const QString& url);
+    QStringList probeTargets() const;
+
+    // 实际请求的结果：reachable 表示收到了服务器的响应（不论状态码），
+    // 为 false 表示连接失败或超时
+    void reportRequestResult(bool reachable);
+
+    // 探测使用的 QNetworkAccessManager，由调用方持有；未设置时在第一次探测时自行创建
+    void setNetworkManager(QNetworkAccessManager* manager);
+
 signals:
     void networkStatusChanged(bool online);
     void syncRequested();  // 联网后自动触发同步
@@ -31,21 +57,34 @@ public slots:
     void startMonitoring();
     void stopMonitoring();
     void setSyncing(bool syncing);
+    // 系统报告网络可能发生了变化（网卡连接或断开、从睡眠恢复），立即重新探测
+    void notifyNetworkChanged();
 
 private slots:
     void checkNetworkStatus();
-    void onNetworkAccessibleChanged(QNetworkAccessManager::NetworkAccessibility accessible);
 
 private:
+    void probeTarget(int index);
     void updateOnlineStatus(bool online);
+    void scheduleNextCheck();
 
     static NetworkMonitor* s_instance;
 
-    QNetworkAccessManager* m_networkManager;
+    QPointer<QNetworkAccessManager> m_networkManager;
     QTimer* m_checkTimer;
     bool m_isOnline;
     bool m_isSyncing;
+    bool m_monitoring;
     int m_checkInterval;
+    int m_offlineChecks;        // 连续离线的探测次数，决定下次探测的等待时间
+    QStringList m_probeTargets;
+    QString m_defaultProbeTarget;
+    QPointer<QNetworkReply> m_probeReply;
+    bool m_recheckPending;      // 探测进行中时系统报告了变化，结束后再探测一次
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QNetworkConfigurationManager* m_configManager;
+#endif
+    QDateTime m_lastCheckTime;
 };
 
 #endif // NETWORKMONITOR_H
@@ -0,0 +1,183 @@
+#include "persistenceworker.h"
+#include <QFile>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// 收到保存请求后等待一小段时间，让连续的修改合并成一次写入
+#define PERSIST_COALESCE_MS 300
+
+PersistenceWorker::PersistenceWorker(QObject *parent)
+    : QThread(parent)
+    , writing(false)
+    , stopping(false)
+    , flushWaiters(0)
+    , failureCount(0)
+{
+}
+
+PersistenceWorker::~PersistenceWorker()
+{
+    stop();
+}
+
+void PersistenceWorker::enqueue(const QString &filePath, const QJsonObject &content,
+                                StorageCodec::Format format, qint64 tag)
+{
+    QMutexLocker locker(&mutex);
+    PendingWrite write;
+    write.content = content;
+    write.format = format;
+    write.tag = tag;
+    pending.insert(filePath, write);
+    workCondition.wakeOne();
+}
+
+bool PersistenceWorker::flush()
+{
+    QMutexLocker locker(&mutex);
+
+    // 线程未运行时（已停止或尚未启动）直接在调用线程写出
+    if (!isRunning()) {
+        QHash<QString, PendingWrite> writes;
+        writes.swap(pending);
+        locker.unlock();
+        bool ok = true;
+        for (auto it = writes.constBegin(); it != writes.constEnd(); ++it) {
+            QString error;
+            if (writeDocumentFile(it.key(), it.value().content, it.value().format, &error)) {
+                emit writeFinished(it.key(), it.value().tag);
+            } else {
+                ok = false;
+                emit writeFailed(it.key(), error);
+            }
+        }
+        locker.relock();
+        ok = ok && failureCount == 0;
+        failureCount = 0;
+        return ok;
+    }
+
+    flushWaiters++;
+    workCondition.wakeOne();
+    while (!pending.isEmpty() || writing) {
+        idleCondition.wait(&mutex);
+    }
+    flushWaiters--;
+
+    bool ok = failureCount == 0;
+    failureCount = 0;
+    return ok;
+}
+
+void PersistenceWorker::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        workCondition.wakeOne();
+    }
+    wait();
+
+    // 线程从未启动时把残留内容同步写出
+    flush();
+}
+
+void PersistenceWorker::run()
+{
+    QMutexLocker locker(&mutex);
+
+    forever {
+        while (pending.isEmpty() && !stopping) {
+            workCondition.wait(&mutex);
+        }
+        if (pending.isEmpty()) {
+            break;
+        }
+
+        // 合并窗口：有人在等待 flush 或正在退出时立即写
+        QElapsedTimer timer;
+        timer.start();
+        while (!stopping && flushWaiters == 0) {
+            qint64 remaining = PERSIST_COALESCE_MS - timer.elapsed();
+            if (remaining <= 0) {
+                break;
+            }
+            workCondition.wait(&mutex, static_cast<unsigned long>(remaining));
+        }
+
+        QHash<QString, PendingWrite> writes;
+        writes.swap(pending);
+        writing = true;
+        locker.unlock();
+
+        for (auto it = writes.constBegin(); it != writes.constEnd(); ++it) {
+            QString error;
+            if (writeDocumentFile(it.key(), it.value().content, it.value().format, &error)) {
+                emit writeFinished(it.key(), it.value().tag);
+            } else {
+                qWarning("Background save failed for %s: %s", qPrintable(it.key()), qPrintable(error));
+                locker.relock();
+                failureCount++;
+                locker.unlock();
+                emit writeFailed(it.key(), error);
+            }
+        }
+
+        locker.relock();
+        writing = false;
+        if (pending.isEmpty()) {
+            idleCondition.wakeAll();
+        }
+    }
+
+    idleCondition.wakeAll();
+}
+
+bool PersistenceWorker::writeDocumentFile(const QString &filePath, const QJsonObject &content,
+                                          StorageCodec::Format format, QString *error)
+{
+    QByteArray data = StorageCodec::encode(content, format);
+
+    // 原子写入：先写临时文件，再重命名
+    QString tempFilePath = filePath + ".tmp";
+    QFile tempFile(tempFilePath);
+    if (!tempFile.open(QIODevice::WriteOnly)) {
+        *error = QString("Cannot create temp file: %1").arg(tempFile.errorString());
+        return false;
+    }
+
+    if (tempFile.write(data) != data.size() || !tempFile.flush()) {
+        *error = QString("Failed to write temp file: %1").arg(tempFile.errorString());
+        tempFile.close();
+        QFile::remove(tempFilePath);
+        return false;
+    }
+    tempFile.close();
+
+    // 先备份原文件
+    QString backupFilePath = filePath + ".bak";
+    if (QFile::exists(filePath)) {
+        QFile::remove(backupFilePath);
+        if (!QFile::copy(filePath, backupFilePath)) {
+            qWarning("Failed to create backup, continuing anyway...");
+        }
+    }
+
+    // 先删除已存在的目标文件（Windows上rename不能覆盖已存在的文件）
+    if (QFile::exists(filePath)) {
+        QFile::remove(filePath);
+    }
+
+    // 重命名临时文件为目标文件
+    if (!QFile::rename(tempFilePath, filePath)) {
+        *error = QString("Failed to rename temp file: %1").arg(tempFilePath);
+        // 尝试恢复备份
+        if (QFile::exists(backupFilePath) && !QFile::exists(filePath)) {
+            QFile::copy(backupFilePath, filePath);
+        }
+        return false;
+    }
+
+    QFile::remove(backupFilePath);
+    return true;
+}
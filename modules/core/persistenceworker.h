@@ -0,0 +1,57 @@
+#ifndef PERSISTENCEWORKER_H
+#define PERSISTENCEWORKER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QString>
+#include <QJsonObject>
+#include "storagecodec.h"
+
+// 后台写盘线程：接收 JSON 快照，在工作线程里按指定格式序列化并原子写入文件。
+// 同一文件在写出前收到的多次保存只写最后一份
+class PersistenceWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit PersistenceWorker(QObject *parent = nullptr);
+    ~PersistenceWorker();
+
+    // 登记一次写入（线程安全），tag 会随写入结果一起返回
+    void enqueue(const QString &filePath, const QJsonObject &content,
+                 StorageCodec::Format format = StorageCodec::Json, qint64 tag = 0);
+    // 阻塞直到已登记的写入全部完成，返回自上次 flush 以来是否全部写入成功
+    bool flush();
+    // 写完剩余内容后结束线程
+    void stop();
+
+    static bool writeDocumentFile(const QString &filePath, const QJsonObject &content,
+                                  StorageCodec::Format format, QString *error);
+
+signals:
+    void writeFinished(const QString &filePath, qint64 tag);
+    void writeFailed(const QString &filePath, const QString &error);
+
+protected:
+    void run() override;
+
+private:
+    struct PendingWrite {
+        QJsonObject content;
+        StorageCodec::Format format;
+        qint64 tag;
+    };
+
+    QMutex mutex;
+    QWaitCondition workCondition;
+    QWaitCondition idleCondition;
+    QHash<QString, PendingWrite> pending;
+    bool writing;
+    bool stopping;
+    int flushWaiters;
+    int failureCount;
+};
+
+#endif
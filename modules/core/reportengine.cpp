@@ -0,0 +1,102 @@
+#include "reportengine.h"
+
+ReportEngine::ReportEngine(Database *database, QObject *parent)
+    : QObject(parent)
+    , db(database)
+    , todoCacheValid(false)
+{
+    connect(db, &Database::taskChanged, this, &ReportEngine::invalidateTask);
+    connect(db, &Database::tasksReset, this, &ReportEngine::invalidateAll);
+}
+
+void ReportEngine::invalidateTask(const QString &id)
+{
+    // 任务的创建日期由ID决定，修改不会让任务移到别的日期
+    QDate created = Database::taskCreationDate(id);
+    if (created.isValid()) {
+        dayBlocks.remove(created);
+    }
+    // 任何任务都可能变为或不再是待办
+    todoCacheValid = false;
+}
+
+void ReportEngine::invalidateAll()
+{
+    dayBlocks.clear();
+    todoCache.clear();
+    todoCacheValid = false;
+}
+
+// 一次查询补齐范围内所有缺失的天，没有任务的天也记为空块
+void ReportEngine::buildDays(const QDate &startDate, const QDate &endDate)
+{
+    QList<Task> tasks = db->getTasksByDateRange(QDateTime(startDate, QTime(0, 0, 0)),
+                                                QDateTime(endDate, QTime(23, 59, 59)));
+
+    for (QDate date = startDate; date <= endDate; date = date.addDays(1)) {
+        dayBlocks.insert(date, DayBlock());
+    }
+
+    for (const Task &task : tasks) {
+        if (task.status != TaskStatus_Completed) {
+            continue;
+        }
+        auto block = dayBlocks.find(Database::taskCreationDate(task.id));
+        if (block == dayBlocks.end()) {
+            continue;
+        }
+
+        QString category = Database::categoryName(task.categoryId);
+        block->categoryItems[category].append({ task.title, task.description, task.workDuration });
+        CategoryTotal &total = block->categoryTotals[category];
+        total.taskCount++;
+        total.workDuration += task.workDuration;
+    }
+}
+
+ReportEngine::Summary ReportEngine::summarize(const QDate &startDate, const QDate &endDate)
+{
+    QDate firstMissing;
+    QDate lastMissing;
+    for (QDate date = startDate; date <= endDate; date = date.addDays(1)) {
+        if (!dayBlocks.contains(date)) {
+            if (!firstMissing.isValid()) {
+                firstMissing = date;
+            }
+            lastMissing = date;
+        }
+    }
+    if (firstMissing.isValid()) {
+        buildDays(firstMissing, lastMissing);
+    }
+
+    Summary summary;
+    summary.totalTasks = 0;
+    summary.totalHours = 0.0;
+    for (QDate date = startDate; date <= endDate; date = date.addDays(1)) {
+        const DayBlock &block = dayBlocks[date];
+        for (auto it = block.categoryItems.constBegin(); it != block.categoryItems.constEnd(); ++it) {
+            summary.categoryItems[it.key()] += it.value();
+        }
+        for (auto it = block.categoryTotals.constBegin(); it != block.categoryTotals.constEnd(); ++it) {
+            CategoryTotal &total = summary.categoryTotals[it.key()];
+            total.taskCount += it.value().taskCount;
+            total.workDuration += it.value().workDuration;
+            summary.totalTasks += it.value().taskCount;
+            summary.totalHours += it.value().workDuration;
+        }
+    }
+    return summary;
+}
+
+QVector<ReportEngine::Item> ReportEngine::todoItems(int limit)
+{
+    if (!todoCacheValid) {
+        todoCache.clear();
+        for (const Task &task : db->getTasksByStatus(TaskStatus_Todo)) {
+            todoCache.append({ task.title, task.description, task.workDuration });
+        }
+        todoCacheValid = true;
+    }
+    return todoCache.mid(0, limit);
+}
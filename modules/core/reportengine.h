@@ -0,0 +1,62 @@
+#ifndef REPORTENGINE_H
+#define REPORTENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QDate>
+#include "database.h"
+
+// 工作报告的统计数据。按任务创建日期缓存每天已完成任务的分类明细和分类合计，
+// 周报、月报、季报由范围内各天的数据拼合。某天的缓存只在当天创建的任务变化时失效
+// （Database::taskChanged），批量修改、切换用户等整体变化时全部失效
+class ReportEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Item {
+        QString title;
+        QString description;
+        double workDuration;
+    };
+
+    struct CategoryTotal {
+        int taskCount;
+        double workDuration;
+    };
+
+    struct Summary {
+        QMap<QString, QVector<Item>> categoryItems;     // 分类名 -> 已完成任务，按分类名排序
+        QMap<QString, CategoryTotal> categoryTotals;
+        int totalTasks;
+        double totalHours;
+    };
+
+    explicit ReportEngine(Database *database, QObject *parent = nullptr);
+
+    // 创建日期在 [startDate, endDate] 内的已完成任务
+    Summary summarize(const QDate &startDate, const QDate &endDate);
+    // 待办任务，最多 limit 个
+    QVector<Item> todoItems(int limit);
+
+public slots:
+    void invalidateTask(const QString &id);
+    void invalidateAll();
+
+private:
+    struct DayBlock {
+        QMap<QString, QVector<Item>> categoryItems;
+        QMap<QString, CategoryTotal> categoryTotals;
+    };
+
+    void buildDays(const QDate &startDate, const QDate &endDate);
+
+    Database *db;
+    QHash<QDate, DayBlock> dayBlocks;
+    QVector<Item> todoCache;
+    bool todoCacheValid;
+};
+
+#endif // REPORTENGINE_H
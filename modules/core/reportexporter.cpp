@@ -0,0 +1,316 @@
+#include "reportexporter.h"
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextFrame>
+#include <QAbstractTextDocumentLayout>
+#include <QPrinter>
+#include <QPainter>
+#include <QPageSize>
+#include <QPageLayout>
+#include <QMarginsF>
+#include <QRegularExpression>
+#include <QAxObject>
+#include <windows.h>
+
+ReportExporter::ReportExporter(const QString &content, const QString &filePath, Format format, QObject *parent)
+    : QThread(parent)
+    , content(content)
+    , filePath(filePath)
+    , format(format)
+    , canceled(0)
+{
+}
+
+ReportExporter::~ReportExporter()
+{
+    cancel();
+    wait();
+}
+
+void ReportExporter::cancel()
+{
+    canceled.storeRelaxed(1);
+}
+
+bool ReportExporter::isCanceled() const
+{
+    return canceled.loadRelaxed() != 0;
+}
+
+void ReportExporter::run()
+{
+    QString error;
+    bool ok = false;
+    emit progress(0);
+
+    switch (format) {
+    case Markdown:
+    case Text:
+        ok = writePlainFile(&error);
+        break;
+    case Pdf:
+        ok = writePdf(&error);
+        break;
+    case Word:
+        ok = writeWord(&error);
+        break;
+    }
+
+    if (isCanceled()) {
+        ok = false;
+        error.clear();
+    }
+    if (ok) {
+        emit progress(100);
+    }
+    emit exportFinished(ok, error);
+}
+
+bool ReportExporter::writePlainFile(QString *error)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *error = "无法保存文件";
+        return false;
+    }
+
+    file.write(content.toUtf8());
+    if (isCanceled()) {
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        *error = "无法保存文件";
+        return false;
+    }
+    return true;
+}
+
+// 逐页绘制，便于报告进度和中途取消。版式与 QTextDocument::print 一致：2 厘米边距，右下角页码
+bool ReportExporter::writePdf(QString *error)
+{
+    QTextDocument document;
+    document.setMarkdown(content);
+    emit progress(10);
+
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(filePath);
+    printer.setPageSize(QPageSize(QPageSize::A4));
+    printer.setPageMargins(QMarginsF(20, 20, 20, 20), QPageLayout::Millimeter);
+
+    QPainter painter;
+    if (!painter.begin(&printer)) {
+        *error = "无法保存文件";
+        return false;
+    }
+
+    document.documentLayout()->setPaintDevice(&printer);
+    int dpiy = printer.logicalDpiY();
+    int margin = static_cast<int>((2 / 2.54) * dpiy);
+    QTextFrameFormat frameFormat = document.rootFrame()->frameFormat();
+    frameFormat.setMargin(margin);
+    document.rootFrame()->setFrameFormat(frameFormat);
+
+    QRectF body(0, 0, printer.width(), printer.height());
+    QPointF pageNumberPos(body.width() - margin,
+                          body.height() - margin + QFontMetrics(document.defaultFont(), &printer).ascent() + 5 * dpiy / 72.0);
+    document.setPageSize(body.size());
+
+    // pageCount 会完成整篇排版
+    int pageCount = document.pageCount();
+    emit progress(30);
+
+    for (int page = 0; page < pageCount; ++page) {
+        if (isCanceled()) {
+            painter.end();
+            QFile::remove(filePath);
+            return false;
+        }
+        if (page > 0) {
+            printer.newPage();
+        }
+
+        painter.save();
+        QRectF view(0, page * body.height(), body.width(), body.height());
+        painter.translate(body.left(), body.top() - view.top());
+        painter.setClipRect(view);
+
+        QAbstractTextDocumentLayout::PaintContext context;
+        context.clip = view;
+        context.palette.setColor(QPalette::Text, Qt::black);
+        document.documentLayout()->draw(&painter, context);
+
+        painter.setClipping(false);
+        painter.setFont(document.defaultFont());
+        QString pageString = QString::number(page + 1);
+        painter.drawText(qRound(pageNumberPos.x() - painter.fontMetrics().horizontalAdvance(pageString)),
+                         qRound(pageNumberPos.y() + view.top()), pageString);
+        painter.restore();
+
+        emit progress(30 + 70 * (page + 1) / pageCount);
+    }
+
+    if (!painter.end()) {
+        *error = "无法保存文件";
+        return false;
+    }
+    return true;
+}
+
+static void setSelectionFont(QAxObject *selection, int size, bool bold)
+{
+    QAxObject *font = selection->querySubObject("Font");
+    if (font) {
+        font->setProperty("Size", size);
+        font->setProperty("Bold", bold);
+    }
+}
+
+// 标题和列表按 Markdown 前缀转为 Word 段落格式
+static void typeWordParagraph(QAxObject *selection, const QString &text)
+{
+    struct Heading {
+        const char *prefix;
+        int alignment;
+        int size;
+    };
+    static const Heading headings[] = {
+        { "### ", 0, 14 },
+        { "## ", 0, 16 },
+        { "# ", 1, 18 },
+    };
+
+    for (const Heading &heading : headings) {
+        QString prefix = QString::fromLatin1(heading.prefix);
+        if (text.startsWith(prefix)) {
+            selection->querySubObject("ParagraphFormat")->setProperty("Alignment", heading.alignment);
+            setSelectionFont(selection, heading.size, true);
+            selection->dynamicCall("TypeText(const QString&)", text.mid(prefix.length()));
+            selection->dynamicCall("TypeParagraph()");
+            setSelectionFont(selection, 12, false);
+            return;
+        }
+    }
+
+    selection->querySubObject("ParagraphFormat")->setProperty("Alignment", 0);
+    if (text.startsWith("- ") || text.startsWith("* ")) {
+        selection->dynamicCall("TypeText(const QString&)", "• " + text.mid(2));
+    } else {
+        selection->dynamicCall("TypeText(const QString&)", text);
+    }
+    selection->dynamicCall("TypeParagraph()");
+}
+
+// Word 通过 COM 自动化写入，工作线程需要自己初始化 COM
+bool ReportExporter::writeWord(QString *error)
+{
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+    if (FAILED(hr)) {
+        *error = "无法创建Word文档，请确保已安装Microsoft Word";
+        return false;
+    }
+
+    bool ok = false;
+    {
+        QAxObject word("Word.Application");
+        QAxObject *document = nullptr;
+        QAxObject *selection = nullptr;
+
+        if (!word.isNull()) {
+            word.setProperty("Visible", false);
+            QAxObject *documents = word.querySubObject("Documents");
+            document = documents ? documents->querySubObject("Add()") : nullptr;
+            selection = document ? word.querySubObject("Selection") : nullptr;
+        }
+
+        if (!selection) {
+            *error = "无法创建Word文档，请确保已安装Microsoft Word";
+        } else {
+            QTextDocument textDoc;
+            textDoc.setMarkdown(content);
+
+            QAxObject *font = selection->querySubObject("Font");
+            if (font) {
+                font->setProperty("Name", "Microsoft YaHei");
+                font->setProperty("Size", 12);
+                font->setProperty("NameFarEast", "Microsoft YaHei");
+            }
+
+            int blockCount = qMax(textDoc.blockCount(), 1);
+            int index = 0;
+            for (QTextBlock block = textDoc.begin(); block != textDoc.end() && !isCanceled(); block = block.next()) {
+                if (!block.text().isEmpty()) {
+                    typeWordParagraph(selection, block.text());
+                }
+                emit progress(90 * ++index / blockCount);
+            }
+
+            if (!isCanceled()) {
+                // SaveAs 没有返回值，失败时 Word 抛出 COM 异常；再确认文件确实写出
+                QString saveError;
+                QObject::connect(document, &QAxObject::exception,
+                                 [&saveError](int, const QString &, const QString &desc, const QString &) {
+                    saveError = desc;
+                });
+                QDateTime previousModified = QFileInfo(filePath).lastModified();
+                document->dynamicCall("SaveAs(const QString&, int)", filePath, 16);
+
+                QFileInfo saved(filePath);
+                ok = saveError.isEmpty() && saved.exists() && saved.size() > 0
+                    && saved.lastModified() != previousModified;
+                if (!ok) {
+                    *error = saveError.isEmpty() ? QString("无法保存文件") : QString("无法保存文件：%1").arg(saveError);
+                }
+            }
+        }
+
+        if (document) {
+            document->dynamicCall("Close(bool)", false);
+        }
+        if (!word.isNull()) {
+            word.dynamicCall("Quit()");
+        }
+    }
+
+    CoUninitialize();
+    return ok;
+}
+
+QString ReportExporter::markdownToHtml(const QString &markdown)
+{
+    QString html = markdown;
+    
+    html.replace(QRegularExpression("^# (.+)$"), "<h1>\\1</h1>");
+    html.replace(QRegularExpression("^## (.+)$"), "<h2>\\1</h2>");
+    html.replace(QRegularExpression("^### (.+)$"), "<h3>\\1</h3>");
+    html.replace(QRegularExpression("^#### (.+)$"), "<h4>\\1</h4>");
+    
+    html.replace(QRegularExpression("\\*\\*(.+?)\\*\\*"), "<strong>\\1</strong>");
+    html.replace(QRegularExpression("\\*(.+?)\\*"), "<em>\\1</em>");
+    
+    html.replace(QRegularExpression("^- (.+)$"), "<li>\\1</li>");
+    html.replace(QRegularExpression("^\\d+\\. (.+)$"), "<li>\\1</li>");
+    
+    html.replace(QRegularExpression("```"), "<pre>");
+    
+    html.replace(QRegularExpression("\n\n"), "</p><p>");
+    html.prepend("<p>");
+    html.append("</p>");
+    
+    html.replace(QRegularExpression("<p>(<h[1-6]>)"), "\\1");
+    html.replace(QRegularExpression("(</h[1-6]>)</p>"), "\\1");
+    html.replace(QRegularExpression("<p>(<li>)"), "<ul>\\1");
+    html.replace(QRegularExpression("(</li>)</p>"), "\\1</ul>");
+    
+    html.replace(QRegularExpression("<p></p>"), "");
+    html.replace(QRegularExpression("<ul></ul>"), "");
+    
+    html.replace("\n", "<br>");
+    
+    return html;
+}
@@ -0,0 +1,52 @@
+#ifndef REPORTEXPORTER_H
+#define REPORTEXPORTER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QString>
+
+// 报告导出线程：在工作线程里把 Markdown 报告排版并写成 PDF、Word、Markdown 或纯文本文件，
+// 通过 progress 报告进度，cancel 后在下一页（或下一段）前停止并删除未写完的文件。
+// 每个对象只执行一次导出，结束时发出 exportFinished
+class ReportExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        Markdown,
+        Text,
+        Pdf,
+        Word
+    };
+
+    ReportExporter(const QString &content, const QString &filePath, Format format, QObject *parent = nullptr);
+    ~ReportExporter();
+
+    // 线程安全
+    void cancel();
+    bool isCanceled() const;
+
+    // 简单的 Markdown 转 HTML（标题、粗斜体、列表、段落），可在任意线程调用
+    static QString markdownToHtml(const QString &markdown);
+
+signals:
+    void progress(int percent);
+    // 取消时 ok 为 false 且 error 为空
+    void exportFinished(bool ok, const QString &error);
+
+protected:
+    void run() override;
+
+private:
+    bool writePlainFile(QString *error);
+    bool writePdf(QString *error);
+    bool writeWord(QString *error);
+
+    QString content;
+    QString filePath;
+    Format format;
+    QAtomicInt canceled;
+};
+
+#endif // REPORTEXPORTER_H
@@ -0,0 +1,258 @@
+#include "searchindex.h"
+#include <QSet>
+#include <algorithm>
+
+static bool isCjk(QChar ch)
+{
+    ushort u = ch.unicode();
+    return (u >= 0x4E00 && u <= 0x9FFF)     // 中日韩统一表意文字
+        || (u >= 0x3400 && u <= 0x4DBF)     // 扩展 A
+        || (u >= 0xF900 && u <= 0xFAFF)     // 兼容表意文字
+        || (u >= 0x3040 && u <= 0x30FF)     // 平假名、片假名
+        || (u >= 0xAC00 && u <= 0xD7AF);    // 韩文音节
+}
+
+// 把文本切成词段：连续的中日韩文字为一段，连续的字母数字为一段
+static void splitRuns(const QString &text, QStringList *cjkRuns, QStringList *wordRuns, bool *endsInRun)
+{
+    QString folded = text.toCaseFolded();
+    QString cjk;
+    QString word;
+
+    for (QChar ch : folded) {
+        if (isCjk(ch)) {
+            if (!word.isEmpty()) {
+                wordRuns->append(word);
+                word.clear();
+            }
+            cjk.append(ch);
+        } else if (ch.isLetterOrNumber()) {
+            if (!cjk.isEmpty()) {
+                cjkRuns->append(cjk);
+                cjk.clear();
+            }
+            word.append(ch);
+        } else {
+            if (!word.isEmpty()) {
+                wordRuns->append(word);
+                word.clear();
+            }
+            if (!cjk.isEmpty()) {
+                cjkRuns->append(cjk);
+                cjk.clear();
+            }
+        }
+    }
+
+    if (endsInRun) {
+        *endsInRun = !word.isEmpty();
+    }
+    if (!word.isEmpty()) {
+        wordRuns->append(word);
+    }
+    if (!cjk.isEmpty()) {
+        cjkRuns->append(cjk);
+    }
+}
+
+QStringList SearchIndex::tokenize(const QString &text)
+{
+    QStringList cjkRuns;
+    QStringList wordRuns;
+    splitRuns(text, &cjkRuns, &wordRuns, nullptr);
+
+    QStringList tokens = wordRuns;
+    for (const QString &run : cjkRuns) {
+        for (int i = 0; i < run.size(); ++i) {
+            tokens.append(run.mid(i, 1));
+            if (i + 1 < run.size()) {
+                tokens.append(run.mid(i, 2));
+            }
+        }
+    }
+    return tokens;
+}
+
+// 查询中的中文段只取 bigram（单字段取单字），已能覆盖原文中的连续片段；
+// 仍在输入中的最后一个英文词按前缀匹配
+QVector<SearchIndex::QueryTerm> SearchIndex::queryTerms(const QString &query)
+{
+    QStringList cjkRuns;
+    QStringList wordRuns;
+    bool endsInWord = false;
+    splitRuns(query, &cjkRuns, &wordRuns, &endsInWord);
+
+    QVector<QueryTerm> terms;
+    QSet<QString> seen;
+    for (int i = 0; i < wordRuns.size(); ++i) {
+        bool prefix = endsInWord && i == wordRuns.size() - 1;
+        if (!seen.contains(wordRuns.at(i))) {
+            seen.insert(wordRuns.at(i));
+            terms.append({ wordRuns.at(i), prefix });
+        }
+    }
+    for (const QString &run : cjkRuns) {
+        if (run.size() == 1) {
+            if (!seen.contains(run)) {
+                seen.insert(run);
+                terms.append({ run, false });
+            }
+            continue;
+        }
+        for (int i = 0; i + 1 < run.size(); ++i) {
+            QString bigram = run.mid(i, 2);
+            if (!seen.contains(bigram)) {
+                seen.insert(bigram);
+                terms.append({ bigram, false });
+            }
+        }
+    }
+    return terms;
+}
+
+void SearchIndex::setDocument(const QString &docId, const Fields &fields)
+{
+    removeDocument(docId);
+
+    QHash<QString, int> scores;
+    for (const auto &field : fields) {
+        const QStringList tokens = tokenize(field.first);
+        QSet<QString> fieldTokens;
+        for (const QString &token : tokens) {
+            // 同一字段内重复出现只计一次，避免长描述压过标题
+            if (!fieldTokens.contains(token)) {
+                fieldTokens.insert(token);
+                scores[token] += field.second;
+            }
+        }
+    }
+
+    if (scores.isEmpty()) {
+        return;
+    }
+
+    QStringList tokens;
+    tokens.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        postings[it.key()].insert(docId, it.value());
+        vocabulary[it.key()]++;
+        tokens.append(it.key());
+    }
+    documentTokens.insert(docId, tokens);
+}
+
+void SearchIndex::removeDocument(const QString &docId)
+{
+    auto doc = documentTokens.find(docId);
+    if (doc == documentTokens.end()) {
+        return;
+    }
+
+    for (const QString &token : doc.value()) {
+        auto posting = postings.find(token);
+        if (posting == postings.end()) {
+            continue;
+        }
+        posting.value().remove(docId);
+        if (posting.value().isEmpty()) {
+            postings.erase(posting);
+            vocabulary.remove(token);
+        } else {
+            vocabulary[token]--;
+        }
+    }
+    documentTokens.erase(doc);
+}
+
+void SearchIndex::clear()
+{
+    postings.clear();
+    vocabulary.clear();
+    documentTokens.clear();
+}
+
+QHash<QString, int> SearchIndex::termMatches(const QueryTerm &term) const
+{
+    if (!term.prefix) {
+        return postings.value(term.token);
+    }
+
+    // 前缀匹配：在有序词表中找出所有以该词开头的词，同一文档取最高得分
+    QHash<QString, int> result;
+    for (auto it = vocabulary.lowerBound(term.token); it != vocabulary.constEnd(); ++it) {
+        if (!it.key().startsWith(term.token)) {
+            break;
+        }
+        const QHash<QString, int> docs = postings.value(it.key());
+        bool exact = (it.key() == term.token);
+        for (auto doc = docs.constBegin(); doc != docs.constEnd(); ++doc) {
+            // 完整命中的词比只命中前缀的词得分高
+            int score = exact ? doc.value() * 2 : doc.value();
+            int &best = result[doc.key()];
+            best = qMax(best, score);
+        }
+    }
+    return result;
+}
+
+QHash<QString, int> SearchIndex::match(const QString &query) const
+{
+    QVector<QueryTerm> terms = queryTerms(query);
+    if (terms.isEmpty()) {
+        return QHash<QString, int>();
+    }
+
+    QVector<QHash<QString, int>> matches;
+    matches.reserve(terms.size());
+    for (const QueryTerm &term : terms) {
+        matches.append(termMatches(term));
+        if (matches.last().isEmpty()) {
+            return QHash<QString, int>();
+        }
+    }
+
+    // 从命中文档最少的词开始求交集，尽早缩小候选集
+    std::sort(matches.begin(), matches.end(), [](const QHash<QString, int> &a, const QHash<QString, int> &b) {
+        return a.size() < b.size();
+    });
+
+    QHash<QString, int> result = matches.first();
+    for (int i = 1; i < matches.size() && !result.isEmpty(); ++i) {
+        const QHash<QString, int> &other = matches.at(i);
+        for (auto it = result.begin(); it != result.end();) {
+            auto found = other.constFind(it.key());
+            if (found == other.constEnd()) {
+                it = result.erase(it);
+            } else {
+                it.value() += found.value();
+                ++it;
+            }
+        }
+    }
+    return result;
+}
+
+QStringList SearchIndex::search(const QString &query, int limit) const
+{
+    QHash<QString, int> scores = match(query);
+
+    QVector<QPair<int, QString>> ranked;
+    ranked.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        ranked.append(qMakePair(it.value(), it.key()));
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return a.second < b.second;
+    });
+
+    QStringList result;
+    int count = (limit >= 0) ? qMin(limit, ranked.size()) : ranked.size();
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.append(ranked.at(i).second);
+    }
+    return result;
+}
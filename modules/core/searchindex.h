@@ -0,0 +1,44 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+#include <QHash>
+#include <QMap>
+
+// 全文倒排索引。中日韩文字按单字和相邻两字（bigram）切分，其他文字按字母数字连续段切分；
+// 查询时所有词都须命中，最后一个词按前缀匹配，便于边输入边搜索
+class SearchIndex
+{
+public:
+    typedef QVector<QPair<QString, int>> Fields;   // 字段文本与权重，权重越高命中时得分越高
+
+    void setDocument(const QString &docId, const Fields &fields);
+    void removeDocument(const QString &docId);
+    void clear();
+    bool isEmpty() const { return documentTokens.isEmpty(); }
+
+    // 命中的文档及得分
+    QHash<QString, int> match(const QString &query) const;
+    // 命中的文档按得分从高到低排列，同分按文档ID排列
+    QStringList search(const QString &query, int limit = -1) const;
+
+    static QStringList tokenize(const QString &text);
+
+private:
+    struct QueryTerm {
+        QString token;
+        bool prefix;
+    };
+
+    static QVector<QueryTerm> queryTerms(const QString &query);
+    QHash<QString, int> termMatches(const QueryTerm &term) const;
+
+    QHash<QString, QHash<QString, int>> postings;   // 词 -> 文档 -> 得分
+    QMap<QString, int> vocabulary;                  // 有序词表，用于前缀匹配，值为包含该词的文档数
+    QHash<QString, QStringList> documentTokens;     // 文档 -> 词，删除文档时使用
+};
+
+#endif
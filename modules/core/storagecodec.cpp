@@ -0,0 +1,288 @@
+#include "storagecodec.h"
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCborValue>
+#include <QCborArray>
+#include <QCborMap>
+#include <cmath>
+
+// 二进制文件结构：自描述标签(55799) [ "PonyWork", 版本号, 数据 ]
+#define CBOR_FILE_MAGIC "PonyWork"
+#define CBOR_FILE_VERSION 1
+// 对象数组的表格编码：标签 [ [键名...], [[值...], ...] ]，缺失的字段写 undefined
+#define CBOR_TAG_TABLE 0x5057
+
+// 超过 2^53 的整数在 double 中已不精确，保持按浮点数编码
+static const double kMaxExactInteger = 9007199254740992.0;
+
+static QCborValue jsonToCbor(const QJsonValue &value);
+
+static QCborValue jsonObjectToCbor(const QJsonObject &object)
+{
+    QCborMap map;
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        map.insert(it.key(), jsonToCbor(it.value()));
+    }
+    return map;
+}
+
+static QCborValue jsonArrayToCbor(const QJsonArray &array)
+{
+    bool allObjects = array.size() >= 2;
+    for (const QJsonValue &item : array) {
+        if (!item.isObject()) {
+            allObjects = false;
+            break;
+        }
+    }
+
+    if (!allObjects) {
+        QCborArray result;
+        for (const QJsonValue &item : array) {
+            result.append(jsonToCbor(item));
+        }
+        return result;
+    }
+
+    // 按首次出现的顺序收集所有键名
+    QStringList keys;
+    QHash<QString, int> keyColumns;
+    for (const QJsonValue &item : array) {
+        const QJsonObject object = item.toObject();
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            if (!keyColumns.contains(it.key())) {
+                keyColumns.insert(it.key(), keys.size());
+                keys.append(it.key());
+            }
+        }
+    }
+
+    QCborArray keyArray;
+    for (const QString &key : keys) {
+        keyArray.append(key);
+    }
+
+    QCborArray rows;
+    for (const QJsonValue &item : array) {
+        const QJsonObject object = item.toObject();
+        QVector<QCborValue> row(keys.size(), QCborValue(QCborValue::Undefined));
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            row[keyColumns.value(it.key())] = jsonToCbor(it.value());
+        }
+        QCborArray rowArray;
+        for (const QCborValue &cell : row) {
+            rowArray.append(cell);
+        }
+        rows.append(rowArray);
+    }
+
+    return QCborValue(QCborTag(CBOR_TAG_TABLE), QCborArray{ keyArray, rows });
+}
+
+static QCborValue jsonToCbor(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        return QCborValue(value.toBool());
+    case QJsonValue::Double: {
+        double d = value.toDouble();
+        if (std::floor(d) == d && std::fabs(d) <= kMaxExactInteger) {
+            return QCborValue(static_cast<qint64>(d));
+        }
+        return QCborValue(d);
+    }
+    case QJsonValue::String:
+        return QCborValue(value.toString());
+    case QJsonValue::Array:
+        return jsonArrayToCbor(value.toArray());
+    case QJsonValue::Object:
+        return jsonObjectToCbor(value.toObject());
+    default:
+        return QCborValue(QCborValue::Null);
+    }
+}
+
+static QJsonValue cborToJson(const QCborValue &value);
+
+static QJsonValue cborTableToJson(const QCborValue &table)
+{
+    const QCborArray parts = table.toArray();
+    const QCborArray keyArray = parts.at(0).toArray();
+    const QCborArray rows = parts.at(1).toArray();
+
+    QStringList keys;
+    for (const QCborValue &key : keyArray) {
+        keys.append(key.toString());
+    }
+
+    QJsonArray result;
+    for (const QCborValue &rowValue : rows) {
+        const QCborArray row = rowValue.toArray();
+        QJsonObject object;
+        for (int i = 0; i < keys.size() && i < row.size(); ++i) {
+            QCborValue cell = row.at(i);
+            if (!cell.isUndefined()) {
+                object.insert(keys.at(i), cborToJson(cell));
+            }
+        }
+        result.append(object);
+    }
+    return result;
+}
+
+static QJsonValue cborToJson(const QCborValue &value)
+{
+    switch (value.type()) {
+    case QCborValue::Integer:
+        return QJsonValue(static_cast<double>(value.toInteger()));
+    case QCborValue::Double:
+        return QJsonValue(value.toDouble());
+    case QCborValue::String:
+        return QJsonValue(value.toString());
+    case QCborValue::True:
+        return QJsonValue(true);
+    case QCborValue::False:
+        return QJsonValue(false);
+    case QCborValue::Array: {
+        QJsonArray array;
+        for (const QCborValue &item : value.toArray()) {
+            array.append(cborToJson(item));
+        }
+        return array;
+    }
+    case QCborValue::Map: {
+        QJsonObject object;
+        const QCborMap map = value.toMap();
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            object.insert(it.key().toString(), cborToJson(it.value()));
+        }
+        return object;
+    }
+    case QCborValue::Tag:
+        if (value.tag() == QCborTag(CBOR_TAG_TABLE)) {
+            return cborTableToJson(value.taggedValue());
+        }
+        return cborToJson(value.taggedValue());
+    default:
+        return QJsonValue(QJsonValue::Null);
+    }
+}
+
+QString StorageCodec::suffix(Format format)
+{
+    return format == Cbor ? ".cbor" : ".json";
+}
+
+QString StorageCodec::formatName(Format format)
+{
+    return format == Cbor ? "cbor" : "json";
+}
+
+StorageCodec::Format StorageCodec::formatFromName(const QString &name)
+{
+    return name.compare("cbor", Qt::CaseInsensitive) == 0 ? Cbor : Json;
+}
+
+QString StorageCodec::counterpartPath(const QString &filePath)
+{
+    if (filePath.endsWith(suffix(Json))) {
+        return filePath.left(filePath.size() - suffix(Json).size()) + suffix(Cbor);
+    }
+    if (filePath.endsWith(suffix(Cbor))) {
+        return filePath.left(filePath.size() - suffix(Cbor).size()) + suffix(Json);
+    }
+    return QString();
+}
+
+QByteArray StorageCodec::encode(const QJsonObject &object, Format format)
+{
+    if (format == Json) {
+        return QJsonDocument(object).toJson(QJsonDocument::Indented);
+    }
+
+    QCborArray file{ QString(CBOR_FILE_MAGIC), CBOR_FILE_VERSION, jsonObjectToCbor(object) };
+    return QCborValue(QCborKnownTags::Signature, file).toCbor();
+}
+
+bool StorageCodec::isBinary(const QByteArray &data)
+{
+    // 自描述标签 55799 的编码固定为 D9 D9 F7
+    return data.size() >= 3
+        && static_cast<quint8>(data.at(0)) == 0xD9
+        && static_cast<quint8>(data.at(1)) == 0xD9
+        && static_cast<quint8>(data.at(2)) == 0xF7;
+}
+
+bool StorageCodec::decode(const QByteArray &data, QJsonObject *object, QString *error)
+{
+    if (!isBinary(data)) {
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+        if (!doc.isObject()) {
+            if (error) {
+                *error = parseError.errorString();
+            }
+            return false;
+        }
+        *object = doc.object();
+        return true;
+    }
+
+    QCborParserError parseError;
+    QCborValue root = QCborValue::fromCbor(data, &parseError);
+    if (parseError.error != QCborError::NoError) {
+        if (error) {
+            *error = parseError.errorString();
+        }
+        return false;
+    }
+
+    QCborArray file = root.taggedValue().toArray();
+    if (file.size() != 3 || file.at(0).toString() != CBOR_FILE_MAGIC) {
+        if (error) {
+            *error = "Not a PonyWork data file";
+        }
+        return false;
+    }
+    if (file.at(1).toInteger() > CBOR_FILE_VERSION) {
+        if (error) {
+            *error = QString("Unsupported data file version %1").arg(file.at(1).toInteger());
+        }
+        return false;
+    }
+
+    *object = cborToJson(file.at(2)).toObject();
+    return true;
+}
+
+bool StorageCodec::dumpToJson(const QString &inputPath, const QString &outputPath, QString *error)
+{
+    QFile input(inputPath);
+    if (!input.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = input.errorString();
+        }
+        return false;
+    }
+    QByteArray data = input.readAll();
+    input.close();
+
+    QJsonObject object;
+    if (!decode(data, &object, error)) {
+        return false;
+    }
+
+    QFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = output.errorString();
+        }
+        return false;
+    }
+    output.write(encode(object, Json));
+    output.close();
+    return true;
+}
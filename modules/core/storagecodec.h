@@ -0,0 +1,34 @@
+#ifndef STORAGECODEC_H
+#define STORAGECODEC_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+// 数据文件的编码格式。Json 为原有的缩进 JSON；Cbor 为带版本号的紧凑二进制格式，
+// 对象数组按表格存储（键名只写一次），整数按变长整数编码
+class StorageCodec
+{
+public:
+    enum Format {
+        Json,
+        Cbor
+    };
+
+    static QString suffix(Format format);
+    static QString formatName(Format format);
+    static Format formatFromName(const QString &name);
+
+    // 同一份数据在另一种格式下的文件路径（data.json <-> data.cbor），用于格式迁移
+    static QString counterpartPath(const QString &filePath);
+
+    static QByteArray encode(const QJsonObject &object, Format format);
+    // 根据文件头自动识别格式
+    static bool decode(const QByteArray &data, QJsonObject *object, QString *error = nullptr);
+    static bool isBinary(const QByteArray &data);
+
+    // 调试用：把任意格式的数据文件转成缩进 JSON 写到 outputPath
+    static bool dumpToJson(const QString &inputPath, const QString &outputPath, QString *error = nullptr);
+};
+
+#endif
@@ -0,0 +1,332 @@
+#include "synclogstore.h"
+#include <QJsonDocument>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+
+// 文件头：魔数、格式版本、数据区大小、最旧记录位置、写入位置、最旧序号、下一个序号，共 32 字节
+#define SYNC_LOG_MAGIC 0x4c535750u      // "PWSL"
+#define SYNC_LOG_VERSION 1
+#define SYNC_LOG_HEADER_SIZE 32
+// 记录头：总长度、序号、毫秒时间戳、实体类型长度，之后是实体类型和紧凑 JSON 内容。
+// 总长度为 0 的记录是回绕标记，数据区末尾不足 4 字节时同样视为回绕
+#define SYNC_LOG_RECORD_HEADER_SIZE 18
+
+SyncLogStore::SyncLogStore()
+    : capacity(0)
+    , head(0)
+    , tail(0)
+    , nextId(1)
+    , firstEntry(0)
+    , firstId(1)
+{
+}
+
+SyncLogStore::~SyncLogStore()
+{
+    close();
+}
+
+bool SyncLogStore::open(const QString &filePath, int dataCapacity)
+{
+    close();
+
+    file.setFileName(filePath);
+    bool exists = file.exists();
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning("Cannot open sync log %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        return false;
+    }
+
+    if (exists && file.size() >= SYNC_LOG_HEADER_SIZE) {
+        uchar header[SYNC_LOG_HEADER_SIZE];
+        bool valid = file.read(reinterpret_cast<char *>(header), SYNC_LOG_HEADER_SIZE) == SYNC_LOG_HEADER_SIZE
+            && qFromLittleEndian<quint32>(header) == SYNC_LOG_MAGIC
+            && qFromLittleEndian<quint32>(header + 4) == SYNC_LOG_VERSION;
+        if (valid) {
+            capacity = qFromLittleEndian<quint32>(header + 8);
+            head = qFromLittleEndian<quint32>(header + 12);
+            tail = qFromLittleEndian<quint32>(header + 16);
+            firstId = static_cast<int>(qFromLittleEndian<quint32>(header + 20));
+            nextId = static_cast<int>(qFromLittleEndian<quint32>(header + 24));
+            valid = capacity > 0 && head <= capacity && tail <= capacity
+                && firstId > 0 && firstId <= nextId && rebuildIndex();
+        }
+        if (valid) {
+            return true;
+        }
+        // 上次写入中途退出等原因导致文件损坏时丢弃旧日志，日志只用于查看，不影响数据
+        qWarning("Sync log %s is corrupt, starting a new one", qPrintable(filePath));
+    }
+
+    capacity = static_cast<quint32>(qMax(dataCapacity, SYNC_LOG_RECORD_HEADER_SIZE * 4));
+    head = 0;
+    tail = 0;
+    firstId = 1;
+    nextId = 1;
+    resetIndex();
+    file.resize(0);
+    return writeHeader();
+}
+
+void SyncLogStore::close()
+{
+    if (file.isOpen()) {
+        file.close();
+    }
+    resetIndex();
+}
+
+bool SyncLogStore::writeHeader()
+{
+    uchar header[SYNC_LOG_HEADER_SIZE] = {};
+    qToLittleEndian<quint32>(SYNC_LOG_MAGIC, header);
+    qToLittleEndian<quint32>(SYNC_LOG_VERSION, header + 4);
+    qToLittleEndian<quint32>(capacity, header + 8);
+    qToLittleEndian<quint32>(head, header + 12);
+    qToLittleEndian<quint32>(tail, header + 16);
+    qToLittleEndian<quint32>(static_cast<quint32>(firstId), header + 20);
+    qToLittleEndian<quint32>(static_cast<quint32>(nextId), header + 24);
+
+    if (!file.seek(0) || file.write(reinterpret_cast<const char *>(header), SYNC_LOG_HEADER_SIZE) != SYNC_LOG_HEADER_SIZE) {
+        qWarning("Cannot write sync log header: %s", qPrintable(file.errorString()));
+        return false;
+    }
+    return file.flush();
+}
+
+void SyncLogStore::resetIndex()
+{
+    entries.clear();
+    firstEntry = 0;
+    idsByType.clear();
+}
+
+// 从最旧的记录开始只读记录头，重建内存索引
+bool SyncLogStore::rebuildIndex()
+{
+    resetIndex();
+    entries.reserve(nextId - firstId);
+
+    quint32 pos = head;
+    for (int id = firstId; id < nextId; ++id) {
+        uchar header[SYNC_LOG_RECORD_HEADER_SIZE];
+        quint32 length = 0;
+        for (int attempt = 0; attempt < 2 && length == 0; ++attempt) {
+            if (capacity - pos >= 4 && file.seek(SYNC_LOG_HEADER_SIZE + pos)
+                && file.read(reinterpret_cast<char *>(header), 4) == 4) {
+                length = qFromLittleEndian<quint32>(header);
+            }
+            if (length == 0) {
+                pos = 0;
+            }
+        }
+
+        if (length < SYNC_LOG_RECORD_HEADER_SIZE || length > capacity - pos
+            || file.read(reinterpret_cast<char *>(header) + 4, SYNC_LOG_RECORD_HEADER_SIZE - 4) != SYNC_LOG_RECORD_HEADER_SIZE - 4
+            || static_cast<int>(qFromLittleEndian<quint32>(header + 4)) != id) {
+            return false;
+        }
+
+        quint16 typeLength = qFromLittleEndian<quint16>(header + 16);
+        QByteArray type = file.read(typeLength);
+        if (type.size() != typeLength || SYNC_LOG_RECORD_HEADER_SIZE + typeLength > length) {
+            return false;
+        }
+
+        entries.append({ pos, length, qFromLittleEndian<qint64>(header + 8) });
+        idsByType[QString::fromUtf8(type)].append(id);
+        pos += length;
+    }
+
+    return entries.isEmpty() || pos == tail;
+}
+
+void SyncLogStore::evictOldest()
+{
+    firstEntry++;
+    firstId++;
+
+    // 已淘汰的前缀超过一半时再整体前移，淘汰的均摊开销为 O(1)
+    if (firstEntry > 64 && firstEntry * 2 > entries.size()) {
+        entries.remove(0, firstEntry);
+        firstEntry = 0;
+    }
+}
+
+int SyncLogStore::append(const QString &entityType, const QDateTime &timestamp, const QJsonObject &payload)
+{
+    if (!file.isOpen()) {
+        return -1;
+    }
+
+    QByteArray type = entityType.toUtf8();
+    QByteArray content = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    quint32 length = static_cast<quint32>(SYNC_LOG_RECORD_HEADER_SIZE + type.size() + content.size());
+    if (type.size() > 0xffff || length > capacity) {
+        qWarning("Sync log record of %u bytes does not fit in the log", length);
+        return -1;
+    }
+
+    if (entryCount() == 0) {
+        head = 0;
+        tail = 0;
+    }
+
+    // 数据区末尾放不下：淘汰末尾部分的记录，写入回绕标记后从开头写
+    if (length > capacity - tail) {
+        while (entryCount() > 0 && entries.at(firstEntry).offset >= tail) {
+            evictOldest();
+        }
+        if (capacity - tail >= 4) {
+            uchar marker[4] = {};
+            if (!file.seek(SYNC_LOG_HEADER_SIZE + tail) || file.write(reinterpret_cast<const char *>(marker), 4) != 4) {
+                qWarning("Cannot write sync log: %s", qPrintable(file.errorString()));
+                return -1;
+            }
+        }
+        tail = 0;
+    }
+
+    // 淘汰与新记录位置重叠的旧记录
+    while (entryCount() > 0 && entries.at(firstEntry).offset >= tail
+           && entries.at(firstEntry).offset < tail + length) {
+        evictOldest();
+    }
+
+    qint64 timestampMs = timestamp.toMSecsSinceEpoch();
+    QByteArray record(SYNC_LOG_RECORD_HEADER_SIZE, '\0');
+    uchar *header = reinterpret_cast<uchar *>(record.data());
+    qToLittleEndian<quint32>(length, header);
+    qToLittleEndian<quint32>(static_cast<quint32>(nextId), header + 4);
+    qToLittleEndian<qint64>(timestampMs, header + 8);
+    qToLittleEndian<quint16>(static_cast<quint16>(type.size()), header + 16);
+    record.append(type);
+    record.append(content);
+
+    if (!file.seek(SYNC_LOG_HEADER_SIZE + tail) || file.write(record) != record.size()) {
+        qWarning("Cannot write sync log: %s", qPrintable(file.errorString()));
+        return -1;
+    }
+
+    int id = nextId++;
+    entries.append({ tail, length, timestampMs });
+    tail += length;
+    head = entries.at(firstEntry).offset;
+
+    // 同类记录的序号列表里已淘汰的前缀超过一半时清理
+    QVector<int> &ids = idsByType[entityType];
+    ids.append(id);
+    int expired = static_cast<int>(std::lower_bound(ids.constBegin(), ids.constEnd(), firstId) - ids.constBegin());
+    if (expired > 64 && expired * 2 > ids.size()) {
+        ids.remove(0, expired);
+    }
+
+    if (!writeHeader()) {
+        return -1;
+    }
+    return id;
+}
+
+bool SyncLogStore::clear()
+{
+    resetIndex();
+    head = 0;
+    tail = 0;
+    firstId = nextId;
+    if (!file.isOpen()) {
+        return false;
+    }
+    file.resize(SYNC_LOG_HEADER_SIZE);
+    return writeHeader();
+}
+
+void SyncLogStore::idRange(const QString &entityType, const QDateTime &before,
+                           const QVector<int> **ids, int *begin, int *end) const
+{
+    *ids = nullptr;
+    *begin = firstId;
+    *end = nextId;
+    if (!entityType.isEmpty()) {
+        auto found = idsByType.constFind(entityType);
+        if (found == idsByType.constEnd()) {
+            *end = *begin;
+            return;
+        }
+        *ids = &found.value();
+        *begin = static_cast<int>(std::lower_bound((*ids)->constBegin(), (*ids)->constEnd(), firstId) - (*ids)->constBegin());
+        *end = (*ids)->size();
+    }
+
+    if (!before.isValid()) {
+        return;
+    }
+
+    // 找到第一条不早于 before 的记录
+    qint64 beforeMs = before.toMSecsSinceEpoch();
+    int low = *begin;
+    int high = *end;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        int id = *ids ? (*ids)->at(mid) : mid;
+        if (entryFor(id).timestampMs < beforeMs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *end = low;
+}
+
+int SyncLogStore::count(const QString &entityType, const QDateTime &before) const
+{
+    const QVector<int> *ids;
+    int begin;
+    int end;
+    idRange(entityType, before, &ids, &begin, &end);
+    return end - begin;
+}
+
+QVector<SyncLogStore::Record> SyncLogStore::read(const QString &entityType, const QDateTime &before, int offset, int limit)
+{
+    QVector<Record> result;
+    if (!file.isOpen()) {
+        return result;
+    }
+
+    const QVector<int> *ids;
+    int begin;
+    int end;
+    idRange(entityType, before, &ids, &begin, &end);
+
+    int last = end - 1 - qMax(offset, 0);
+    int first = qMax(begin, last - limit + 1);
+    if (last < first) {
+        return result;
+    }
+
+    result.reserve(last - first + 1);
+    for (int i = last; i >= first; --i) {
+        int id = ids ? ids->at(i) : i;
+        const Entry &entry = entryFor(id);
+        if (!file.seek(SYNC_LOG_HEADER_SIZE + entry.offset)) {
+            break;
+        }
+        QByteArray data = file.read(entry.length);
+        if (data.size() != static_cast<int>(entry.length)) {
+            qWarning("Cannot read sync log record %d", id);
+            break;
+        }
+
+        const uchar *header = reinterpret_cast<const uchar *>(data.constData());
+        int typeLength = qFromLittleEndian<quint16>(header + 16);
+
+        Record record;
+        record.id = id;
+        record.entityType = QString::fromUtf8(data.constData() + SYNC_LOG_RECORD_HEADER_SIZE, typeLength);
+        record.timestamp = QDateTime::fromMSecsSinceEpoch(entry.timestampMs);
+        record.payload = QJsonDocument::fromJson(data.mid(SYNC_LOG_RECORD_HEADER_SIZE + typeLength)).object();
+        result.append(record);
+    }
+    return result;
+}
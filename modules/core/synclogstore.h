@@ -0,0 +1,72 @@
+#ifndef SYNCLOGSTORE_H
+#define SYNCLOGSTORE_H
+
+#include <QString>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QDateTime>
+#include <QJsonObject>
+
+// 同步日志的环形文件：固定大小的数据区首尾相接，写满后覆盖最旧的记录，文件大小不再增长。
+// 打开时只扫描各条记录的头部，在内存中建立按序号、实体类型和时间的索引，
+// 记录内容在分页读取时才从文件中读出
+class SyncLogStore
+{
+public:
+    struct Record {
+        int id;
+        QString entityType;
+        QDateTime timestamp;
+        QJsonObject payload;
+    };
+
+    SyncLogStore();
+    ~SyncLogStore();
+
+    // 打开（不存在时创建）日志文件，dataCapacity 为数据区字节数，只在新建文件时生效
+    bool open(const QString &filePath, int dataCapacity = 2 * 1024 * 1024);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    // 追加一条记录，返回分配的序号，失败返回 -1；空间不足时先淘汰最旧的记录
+    int append(const QString &entityType, const QDateTime &timestamp, const QJsonObject &payload);
+    bool clear();
+
+    // entityType 为空表示全部类型；before 有效时只计入早于该时间的记录
+    int count(const QString &entityType = QString(), const QDateTime &before = QDateTime()) const;
+    // 从新到旧跳过 offset 条后读取至多 limit 条
+    QVector<Record> read(const QString &entityType, const QDateTime &before, int offset, int limit);
+
+private:
+    struct Entry {
+        quint32 offset;         // 记录在数据区中的位置
+        quint32 length;
+        qint64 timestampMs;
+    };
+
+    bool writeHeader();
+    bool rebuildIndex();
+    void resetIndex();
+    void evictOldest();
+    int entryCount() const { return entries.size() - firstEntry; }
+    const Entry &entryFor(int id) const { return entries.at(firstEntry + id - firstId); }
+    // 满足条件的记录为 [*begin, *end) 区间：ids 为空时区间本身就是序号，否则是 ids 的下标。
+    // before 按时间二分查找，记录按追加顺序近似有序
+    void idRange(const QString &entityType, const QDateTime &before,
+                 const QVector<int> **ids, int *begin, int *end) const;
+
+    QFile file;
+    quint32 capacity;
+    quint32 head;               // 最旧记录的位置
+    quint32 tail;               // 下一条记录的写入位置
+    int nextId;
+
+    // entries[firstEntry..] 依次对应序号 firstId..nextId-1
+    QVector<Entry> entries;
+    int firstEntry;
+    int firstId;
+    QHash<QString, QVector<int>> idsByType;     // 实体类型 -> 序号（从旧到新，可能含已淘汰的序号）
+};
+
+#endif
@@ -178,10 +178,15 @@ void BatchImportDialog::importSelected()
         }
     }
 
+    DatabaseTransaction transaction(db);
     for (const AppInfo &app : selectedItems) {
         db->addApp(app);
         addedCount++;
     }
+    if (!transaction.commit()) {
+        QMessageBox::warning(this, "错误", "导入已撤销");
+        return;
+    }
 
     accept();
     QMessageBox::information(this, "完成", QString("成功导入 %1 个应用").arg(addedCount));
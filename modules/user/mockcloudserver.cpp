@@ -0,0 +1,1000 @@
+#include "mockcloudserver.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <climits>
+
+// 请求头的长度上限
+#define MOCK_MAX_HEADER_BYTES 65536
+// TCP 报文段大小和丢包后的重传等待
+#define MOCK_SEGMENT_BYTES 1460
+#define MOCK_RTO_MS 200
+
+// ===== gzip 解码 =====
+// 客户端较大的请求体以 gzip 上传（见 ApiClient），这里按 RFC 1951 解码 deflate 数据
+
+namespace {
+
+struct Huffman {
+    QVector<short> count;       // 每种码长的符号数
+    QVector<short> symbol;      // 按码字顺序排列的符号
+};
+
+struct Inflater {
+    const uchar* in;
+    int inSize;
+    int pos;
+    quint32 bitBuf;
+    int bitCount;
+    bool error;
+    QByteArray out;
+};
+
+int needBits(Inflater& s, int need) {
+    quint32 value = s.bitBuf;
+    while (s.bitCount < need) {
+        if (s.pos >= s.inSize) {
+            s.error = true;
+            return 0;
+        }
+        value |= static_cast<quint32>(s.in[s.pos++]) << s.bitCount;
+        s.bitCount += 8;
+    }
+    s.bitBuf = value >> need;
+    s.bitCount -= need;
+    return static_cast<int>(value & ((1u << need) - 1));
+}
+
+// 由码长生成范式 Huffman 表，码长集合不完整（仅一个码字等）是合法的
+bool buildHuffman(Huffman& h, const short* lengths, int n) {
+    h.count.fill(0, 16);
+    h.symbol.fill(0, n);
+    for (int i = 0; i < n; ++i) {
+        h.count[lengths[i]]++;
+    }
+    if (h.count[0] == n) {
+        return true;
+    }
+
+    int left = 1;
+    for (int len = 1; len < 16; ++len) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    short offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 15; ++len) {
+        offsets[len + 1] = offsets[len] + h.count[len];
+    }
+    for (int i = 0; i < n; ++i) {
+        if (lengths[i] != 0) {
+            h.symbol[offsets[lengths[i]]++] = static_cast<short>(i);
+        }
+    }
+    return true;
+}
+
+int decodeSymbol(Inflater& s, const Huffman& h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len < 16; ++len) {
+        code |= needBits(s, 1);
+        if (s.error) {
+            return -1;
+        }
+        int count = h.count[len];
+        if (code - count < first) {
+            return h.symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+bool inflateCodes(Inflater& s, const Huffman& lencode, const Huffman& distcode) {
+    static const short lengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const short lengthExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const short distBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static const short distExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    for (;;) {
+        int symbol = decodeSymbol(s, lencode);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 256) {
+            s.out.append(static_cast<char>(symbol));
+            continue;
+        }
+        if (symbol == 256) {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            return false;
+        }
+        int length = lengthBase[symbol] + needBits(s, lengthExtra[symbol]);
+
+        symbol = decodeSymbol(s, distcode);
+        if (symbol < 0 || symbol >= 30) {
+            return false;
+        }
+        int distance = distBase[symbol] + needBits(s, distExtra[symbol]);
+        if (s.error || distance > s.out.size()) {
+            return false;
+        }
+
+        // 复制区间可能与输出末尾重叠，只能逐字节复制
+        int from = s.out.size() - distance;
+        for (int i = 0; i < length; ++i) {
+            s.out.append(s.out.at(from + i));
+        }
+    }
+}
+
+bool inflateStored(Inflater& s) {
+    s.bitBuf = 0;
+    s.bitCount = 0;
+    if (s.pos + 4 > s.inSize) {
+        return false;
+    }
+    int length = s.in[s.pos] | (s.in[s.pos + 1] << 8);
+    int complement = s.in[s.pos + 2] | (s.in[s.pos + 3] << 8);
+    s.pos += 4;
+    if (length != (~complement & 0xffff) || s.pos + length > s.inSize) {
+        return false;
+    }
+    s.out.append(reinterpret_cast<const char*>(s.in + s.pos), length);
+    s.pos += length;
+    return true;
+}
+
+bool inflateFixed(Inflater& s) {
+    static Huffman lencode;
+    static Huffman distcode;
+    static bool built = false;
+    if (!built) {
+        short lengths[288];
+        for (int i = 0; i < 144; ++i) lengths[i] = 8;
+        for (int i = 144; i < 256; ++i) lengths[i] = 9;
+        for (int i = 256; i < 280; ++i) lengths[i] = 7;
+        for (int i = 280; i < 288; ++i) lengths[i] = 8;
+        buildHuffman(lencode, lengths, 288);
+        for (int i = 0; i < 30; ++i) lengths[i] = 5;
+        buildHuffman(distcode, lengths, 30);
+        built = true;
+    }
+    return inflateCodes(s, lencode, distcode);
+}
+
+bool inflateDynamic(Inflater& s) {
+    static const short order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    int nlen = needBits(s, 5) + 257;
+    int ndist = needBits(s, 5) + 1;
+    int ncode = needBits(s, 4) + 4;
+    if (s.error || nlen > 286 || ndist > 30) {
+        return false;
+    }
+
+    short lengths[286 + 30];
+    int index = 0;
+    for (; index < ncode; ++index) {
+        lengths[order[index]] = static_cast<short>(needBits(s, 3));
+    }
+    for (; index < 19; ++index) {
+        lengths[order[index]] = 0;
+    }
+
+    Huffman lencode;
+    Huffman distcode;
+    if (s.error || !buildHuffman(lencode, lengths, 19)) {
+        return false;
+    }
+
+    index = 0;
+    while (index < nlen + ndist) {
+        int symbol = decodeSymbol(s, lencode);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = static_cast<short>(symbol);
+            continue;
+        }
+
+        short repeated = 0;
+        if (symbol == 16) {
+            if (index == 0) {
+                return false;
+            }
+            repeated = lengths[index - 1];
+            symbol = 3 + needBits(s, 2);
+        } else if (symbol == 17) {
+            symbol = 3 + needBits(s, 3);
+        } else {
+            symbol = 11 + needBits(s, 7);
+        }
+        if (s.error || index + symbol > nlen + ndist) {
+            return false;
+        }
+        while (symbol--) {
+            lengths[index++] = repeated;
+        }
+    }
+
+    // 必须有结束符
+    if (lengths[256] == 0) {
+        return false;
+    }
+    if (!buildHuffman(lencode, lengths, nlen) || !buildHuffman(distcode, lengths + nlen, ndist)) {
+        return false;
+    }
+    return inflateCodes(s, lencode, distcode);
+}
+
+bool gzipDecompress(const QByteArray& data, QByteArray* out) {
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    int size = data.size();
+    if (size < 18 || bytes[0] != 0x1f || bytes[1] != 0x8b || bytes[2] != 8) {
+        return false;
+    }
+
+    // 跳过可选的头部字段
+    int flags = bytes[3];
+    int pos = 10;
+    if (flags & 0x04) {
+        if (pos + 2 > size) return false;
+        pos += 2 + (bytes[pos] | (bytes[pos + 1] << 8));
+    }
+    if (flags & 0x08) {
+        while (pos < size && bytes[pos] != 0) ++pos;
+        ++pos;
+    }
+    if (flags & 0x10) {
+        while (pos < size && bytes[pos] != 0) ++pos;
+        ++pos;
+    }
+    if (flags & 0x02) {
+        pos += 2;
+    }
+    if (pos >= size - 8) {
+        return false;
+    }
+
+    Inflater s;
+    s.in = bytes;
+    s.inSize = size - 8;
+    s.pos = pos;
+    s.bitBuf = 0;
+    s.bitCount = 0;
+    s.error = false;
+
+    // 尾部记录了原始长度，用来预留输出空间并校验结果
+    quint32 expectedSize = bytes[size - 4] | (bytes[size - 3] << 8) | (bytes[size - 2] << 16)
+                         | (static_cast<quint32>(bytes[size - 1]) << 24);
+    s.out.reserve(static_cast<int>(qMin<quint32>(expectedSize, 256u * 1024 * 1024)));
+
+    int last = 0;
+    do {
+        last = needBits(s, 1);
+        int type = needBits(s, 2);
+        bool ok = false;
+        if (!s.error) {
+            switch (type) {
+            case 0: ok = inflateStored(s); break;
+            case 1: ok = inflateFixed(s); break;
+            case 2: ok = inflateDynamic(s); break;
+            default: break;
+            }
+        }
+        if (!ok || s.error) {
+            return false;
+        }
+    } while (!last);
+
+    if (static_cast<quint32>(s.out.size()) != expectedSize) {
+        return false;
+    }
+    *out = s.out;
+    return true;
+}
+
+QString sha256Hex(const QString& text) {
+    return QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha256).toHex();
+}
+
+bool isSha256Hex(const QString& text) {
+    static const QRegularExpression re("^[a-fA-F0-9]{64}$");
+    return re.match(text).hasMatch();
+}
+
+QString nowIso() {
+    return QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+}
+
+QByteArray reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 415: return "Unsupported Media Type";
+    case 431: return "Request Header Fields Too Large";
+    default: return "Internal Server Error";
+    }
+}
+
+QJsonObject errorBody(const QString& error) {
+    QJsonObject body;
+    body["success"] = false;
+    body["error"] = error;
+    return body;
+}
+
+// 与服务器写入 user_tasks 表时一致：缺失的字段取默认值，updatedAt 为空时使用服务器时间
+QJsonObject taskRow(const QJsonObject& task) {
+    QJsonObject row;
+    row["id"] = task.value("id").toString();
+    row["title"] = task.value("title").toString();
+    row["description"] = task.value("description").toString();
+    row["categoryId"] = task.value("categoryId").toInt();
+    row["priority"] = task.value("priority").toInt();
+    row["status"] = task.value("status").toInt();
+    row["workDuration"] = task.value("workDuration").toInt();
+    row["completionTime"] = task.value("completionTime").toString();
+
+    QJsonValue tags = task.value("tags");
+    if (tags.isString()) {
+        tags = QJsonDocument::fromJson(tags.toString().toUtf8()).array();
+    }
+    row["tags"] = tags.isArray() ? tags.toArray() : QJsonArray();
+
+    QString updatedAt = task.value("updatedAt").toString();
+    row["updatedAt"] = updatedAt.isEmpty() ? nowIso() : updatedAt;
+    return row;
+}
+
+}
+
+// ===== 网络条件 =====
+
+QStringList MockCloudServer::profileNames() {
+    return QStringList() << "local" << "lan" << "broadband" << "mobile" << "lossy";
+}
+
+MockCloudServer::NetworkProfile MockCloudServer::profile(const QString& name) {
+    NetworkProfile p;
+    p.name = "local";
+    if (name == "lan") {
+        p.name = name;
+        p.latencyMs = 1;
+        p.jitterMs = 1;
+        p.bandwidthKbps = 100000;
+    } else if (name == "broadband") {
+        p.name = name;
+        p.latencyMs = 20;
+        p.jitterMs = 5;
+        p.lossRate = 0.001;
+        p.bandwidthKbps = 20000;
+    } else if (name == "mobile") {
+        p.name = name;
+        p.latencyMs = 60;
+        p.jitterMs = 30;
+        p.lossRate = 0.01;
+        p.bandwidthKbps = 5000;
+    } else if (name == "lossy") {
+        p.name = name;
+        p.latencyMs = 150;
+        p.jitterMs = 80;
+        p.lossRate = 0.05;
+        p.bandwidthKbps = 1000;
+    }
+    return p;
+}
+
+int MockCloudServer::networkDelayMs(qint64 bytes) const {
+    QRandomGenerator* random = QRandomGenerator::global();
+    qint64 delay = 2 * m_profile.latencyMs;
+    if (m_profile.jitterMs > 0) {
+        delay += random->bounded(m_profile.jitterMs + 1) + random->bounded(m_profile.jitterMs + 1);
+    }
+    if (m_profile.bandwidthKbps > 0) {
+        delay += bytes * 8 / m_profile.bandwidthKbps;
+    }
+    if (m_profile.lossRate > 0) {
+        qint64 segments = (bytes + MOCK_SEGMENT_BYTES - 1) / MOCK_SEGMENT_BYTES;
+        for (qint64 i = 0; i < segments; ++i) {
+            if (random->generateDouble() < m_profile.lossRate) {
+                delay += MOCK_RTO_MS;
+            }
+        }
+    }
+    return static_cast<int>(qMin<qint64>(delay, INT_MAX));
+}
+
+// ===== 连接与 HTTP =====
+
+MockCloudServer::MockCloudServer(QObject* parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_nextUserId(1)
+    , m_nextTaskSeq(1) {
+    m_profile = profile("local");
+    connect(m_server, &QTcpServer::newConnection, this, &MockCloudServer::onNewConnection);
+}
+
+MockCloudServer::~MockCloudServer() {
+}
+
+bool MockCloudServer::listen(quint16 port) {
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "[MockCloudServer] 监听失败:" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+QString MockCloudServer::baseUrl() const {
+    return QString("http://127.0.0.1:%1").arg(port());
+}
+
+int MockCloudServer::addUser(const QString& username, const QString& email, const QString& password) {
+    User user;
+    user.id = m_nextUserId++;
+    user.username = username;
+    user.email = email;
+    user.password = sha256Hex(password);
+    user.createdAt = nowIso();
+    m_users.insert(user.id, user);
+    return user.id;
+}
+
+void MockCloudServer::clearTasks() {
+    m_tasks.clear();
+}
+
+void MockCloudServer::onNewConnection() {
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        m_buffers.insert(socket, QByteArray());
+        m_busy.insert(socket, false);
+        connect(socket, &QTcpSocket::readyRead, this, &MockCloudServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            m_busy.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockCloudServer::onReadyRead() {
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    m_buffers[socket].append(socket->readAll());
+    processNext(socket);
+}
+
+void MockCloudServer::processNext(QTcpSocket* socket) {
+    // 同一连接上的请求按顺序回复
+    if (m_busy.value(socket)) return;
+
+    Request request;
+    qint64 wireBytes = 0;
+    Response error(0);
+    if (!takeRequest(socket, &request, &wireBytes, &error)) return;
+
+    m_stats.requestCount++;
+    m_stats.bytesReceived += wireBytes;
+
+    Response response = error.status != 0 ? error : dispatch(request);
+    emit requestHandled(request.method, request.path, response.status);
+    sendResponse(socket, response, request.keepAlive && error.status == 0, wireBytes);
+}
+
+bool MockCloudServer::takeRequest(QTcpSocket* socket, Request* request, qint64* wireBytes, Response* error) {
+    QByteArray& buffer = m_buffers[socket];
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (buffer.size() > MOCK_MAX_HEADER_BYTES) {
+            buffer.clear();
+            *error = Response(431, errorBody("Request header too large"));
+            return true;
+        }
+        return false;
+    }
+
+    QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.takeFirst().trimmed().split(' ');
+    if (requestLine.size() != 3) {
+        buffer.clear();
+        *error = Response(400, errorBody("Malformed request line"));
+        return true;
+    }
+
+    request->headers.clear();
+    for (const QByteArray& line : lines) {
+        int colon = line.indexOf(':');
+        if (colon > 0) {
+            request->headers.insert(line.left(colon).trimmed().toLower(), line.mid(colon + 1).trimmed());
+        }
+    }
+
+    int contentLength = request->headers.value("content-length", "0").toInt();
+    int total = headerEnd + 4 + contentLength;
+    if (buffer.size() < total) {
+        return false;
+    }
+
+    QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+    buffer.remove(0, total);
+    *wireBytes = total;
+
+    request->method = QString::fromLatin1(requestLine.at(0));
+    QUrl url(QStringLiteral("http://localhost") + QString::fromLatin1(requestLine.at(1)));
+    request->path = url.path();
+    request->query.clear();
+    const auto items = QUrlQuery(url).queryItems(QUrl::FullyDecoded);
+    for (const auto& item : items) {
+        request->query.insert(item.first, item.second);
+    }
+    QByteArray connection = request->headers.value("connection").toLower();
+    request->keepAlive = requestLine.at(2) == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+
+    // 与 express 的 body-parser 一致：接受 gzip 和未编码的请求体，其他编码返回 415
+    QByteArray encoding = request->headers.value("content-encoding").toLower();
+    if (encoding == "gzip") {
+        if (!gzipDecompress(body, &request->body)) {
+            *error = Response(400, errorBody("Invalid gzip body"));
+            return true;
+        }
+    } else if (encoding.isEmpty() || encoding == "identity") {
+        request->body = body;
+    } else {
+        *error = Response(415, errorBody("Unsupported content encoding: " + QString::fromLatin1(encoding)));
+        return true;
+    }
+    m_stats.bodyBytesReceived += request->body.size();
+    return true;
+}
+
+void MockCloudServer::sendResponse(QTcpSocket* socket, const Response& response, bool keepAlive, qint64 requestBytes) {
+    QByteArray body = QJsonDocument(response.body).toJson(QJsonDocument::Compact);
+    QByteArray data;
+    data.reserve(body.size() + 256);
+    data.append("HTTP/1.1 " + QByteArray::number(response.status) + " " + reasonPhrase(response.status) + "\r\n");
+    data.append("Content-Type: application/json; charset=utf-8\r\n");
+    data.append("Content-Length: " + QByteArray::number(body.size()) + "\r\n");
+    data.append(keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    data.append("\r\n");
+    data.append(body);
+    m_stats.bytesSent += data.size();
+
+    // 按模拟的网络条件推迟回复，期间该连接不处理后续请求
+    m_busy[socket] = true;
+    int delay = networkDelayMs(requestBytes + data.size());
+    QTimer::singleShot(delay, socket, [this, socket, data, keepAlive]() {
+        socket->write(data);
+        m_busy[socket] = false;
+        if (!keepAlive) {
+            socket->disconnectFromHost();
+            return;
+        }
+        processNext(socket);
+    });
+}
+
+// ===== 接口 =====
+
+MockCloudServer::Response MockCloudServer::dispatch(const Request& request) {
+    QJsonObject body;
+    if (!request.body.isEmpty()) {
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(request.body, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            return Response(400, errorBody("Invalid JSON body"));
+        }
+        body = doc.object();
+    }
+
+    const QString& method = request.method;
+    const QString& path = request.path;
+
+    if (method == "GET" && path == "/api/health") {
+        QJsonObject health;
+        health["success"] = true;
+        health["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        return Response(200, health);
+    }
+    if (method == "POST" && path == "/api/auth/login") return handleLogin(body);
+    if (method == "POST" && path == "/api/auth/register") return handleRegister(body);
+    if (method == "GET" && path == "/api/auth/check-email") return handleCheck(request, "email");
+    if (method == "GET" && path == "/api/auth/check-username") return handleCheck(request, "username");
+    if (method == "GET" && path == "/api/auth/profile") return handleProfile(request);
+    if (method == "POST" && path == "/api/auth/logout") return handleLogout(request);
+
+    bool authRequired = path == "/api/auth/change-password" || path.startsWith("/api/config/");
+    if (!authRequired) {
+        return Response(404, errorBody("Not found"));
+    }
+
+    int userId = authenticate(request);
+    if (userId == 0) {
+        QJsonObject unauthorized;
+        unauthorized["success"] = false;
+        unauthorized["message"] = request.headers.contains("authorization") ? "登录已过期，请重新登录" : "未授权访问";
+        return Response(401, unauthorized);
+    }
+
+    if (method == "POST" && path == "/api/auth/change-password") return handleChangePassword(userId, body);
+    if (method == "GET" && path == "/api/config/get") return handleConfigGet(userId);
+    if (method == "POST" && path == "/api/config/save") return handleConfigSave(userId, body);
+    if (method == "GET" && path == "/api/config/frpc/get") return handleFrpcGet(userId);
+    if (method == "POST" && path == "/api/config/frpc/save") return handleFrpcSave(userId, body);
+    if (method == "POST" && path == "/api/config/tasks/sync") return handleTasksSync(userId, body);
+    if (method == "GET" && path == "/api/config/tasks/get") return handleTasksGet(userId, QString());
+    if (method == "POST" && path == "/api/config/tasks/incremental") return handleTasksIncremental(userId, body);
+    if (method == "GET" && path == "/api/config/tasks/incremental") {
+        bool hasSeq = false;
+        qint64 sinceSeq = request.query.value("sinceSeq").toLongLong(&hasSeq);
+        return handleTasksGet(userId, request.query.value("lastSyncTime"), hasSeq ? sinceSeq : -1);
+    }
+    return Response(404, errorBody("Not found"));
+}
+
+int MockCloudServer::authenticate(const Request& request) const {
+    QString header = QString::fromUtf8(request.headers.value("authorization"));
+    QString token = header.startsWith("Bearer ") ? header.mid(7) : header;
+    return token.isEmpty() ? 0 : m_sessions.value(token, 0);
+}
+
+QJsonObject MockCloudServer::userJson(const User& user) {
+    QJsonObject obj;
+    obj["id"] = user.id;
+    obj["username"] = user.username;
+    obj["email"] = user.email;
+    obj["vipLevel"] = 0;
+    obj["lastLogin"] = user.lastLogin;
+    obj["createdAt"] = user.createdAt;
+    return obj;
+}
+
+MockCloudServer::Response MockCloudServer::handleLogin(const QJsonObject& body) {
+    QString email = body.value("email").toString();
+    QString username = body.value("username").toString();
+    QString password = body.value("password").toString();
+    if ((email.isEmpty() && username.isEmpty()) || password.isEmpty()) {
+        return Response(400, errorBody("邮箱/用户名和密码必填"));
+    }
+
+    // 客户端通常发送 SHA-256 哈希，也兼容明文
+    QString hashed = isSha256Hex(password) ? password.toLower() : sha256Hex(password);
+    for (auto it = m_users.begin(); it != m_users.end(); ++it) {
+        User& user = it.value();
+        bool matched = email.isEmpty() ? user.username == username : user.email == email;
+        if (!matched) continue;
+        if (user.password != hashed) break;
+
+        QByteArray token(32, Qt::Uninitialized);
+        for (int i = 0; i < token.size(); ++i) {
+            token[i] = static_cast<char>(QRandomGenerator::global()->bounded(256));
+        }
+        QString tokenHex = QString::fromLatin1(token.toHex());
+        m_sessions.insert(tokenHex, user.id);
+
+        QJsonObject result;
+        result["success"] = true;
+        result["token"] = tokenHex;
+        result["user"] = userJson(user);
+        user.lastLogin = nowIso();
+        return Response(200, result);
+    }
+    return Response(401, errorBody("邮箱/用户名或密码错误"));
+}
+
+MockCloudServer::Response MockCloudServer::handleRegister(const QJsonObject& body) {
+    QString username = body.value("username").toString();
+    QString email = body.value("email").toString();
+    QString password = body.value("password").toString();
+    if (username.isEmpty() || email.isEmpty() || password.isEmpty()) {
+        return Response(400, errorBody("用户名、邮箱和密码必填"));
+    }
+    if (password.size() < 6) {
+        return Response(400, errorBody("密码长度至少 6 位"));
+    }
+    for (const User& user : m_users) {
+        if (user.username == username) return Response(400, errorBody("用户名已存在"));
+        if (user.email == email) return Response(400, errorBody("邮箱已被注册"));
+    }
+
+    int userId = addUser(username, email, password);
+    if (isSha256Hex(password)) {
+        m_users[userId].password = password.toLower();
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["userId"] = userId;
+    result["message"] = "注册成功";
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleCheck(const Request& request, const QString& field) {
+    QString value = request.query.value(field);
+    if (value.isEmpty()) {
+        return Response(400, errorBody(field == "email" ? "邮箱必填" : "用户名必填"));
+    }
+
+    bool exists = false;
+    for (const User& user : m_users) {
+        if ((field == "email" ? user.email : user.username) == value) {
+            exists = true;
+            break;
+        }
+    }
+    QJsonObject result;
+    result["exists"] = exists;
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleProfile(const Request& request) {
+    if (!request.headers.contains("authorization")) {
+        return Response(401, errorBody("未授权访问"));
+    }
+    int userId = authenticate(request);
+    if (userId == 0 || !m_users.contains(userId)) {
+        return Response(401, errorBody("登录已过期"));
+    }
+
+    const User& user = m_users[userId];
+    QJsonObject userObj;
+    userObj["id"] = user.id;
+    userObj["email"] = user.email;
+    userObj["username"] = user.username;
+    userObj["vip_level"] = 0;
+    userObj["created_at"] = user.createdAt;
+    userObj["last_login"] = user.lastLogin;
+
+    QJsonObject result;
+    result["success"] = true;
+    result["user"] = userObj;
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleLogout(const Request& request) {
+    if (!request.headers.contains("authorization")) {
+        return Response(401, errorBody("未授权访问"));
+    }
+    QString header = QString::fromUtf8(request.headers.value("authorization"));
+    QString token = header.startsWith("Bearer ") ? header.mid(7) : header;
+    if (!m_sessions.remove(token)) {
+        return Response(401, errorBody("无效的会话"));
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["message"] = "登出成功";
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleChangePassword(int userId, const QJsonObject& body) {
+    QString oldPassword = body.value("old_password").toString();
+    QString newPassword = body.value("new_password").toString();
+    if (oldPassword.isEmpty() || newPassword.isEmpty()) {
+        return Response(400, errorBody("请提供旧密码和新密码"));
+    }
+    if (newPassword.size() < 6) {
+        return Response(400, errorBody("新密码长度不能少于6位"));
+    }
+
+    User& user = m_users[userId];
+    QString oldHash = isSha256Hex(oldPassword) ? oldPassword.toLower() : sha256Hex(oldPassword);
+    if (user.password != oldHash) {
+        return Response(401, errorBody("旧密码错误"));
+    }
+    user.password = newPassword;
+
+    // 修改密码后所有会话失效
+    for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+        if (it.value() == userId) {
+            it = m_sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["message"] = "密码修改成功，请重新登录";
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleConfigGet(int userId) {
+    QJsonObject configs = m_configs.value(userId);
+    QJsonObject hashes = m_configHashes.value(userId);
+    QJsonObject sectionHashes;
+    for (auto it = hashes.begin(); it != hashes.end(); ++it) {
+        if (configs.contains(it.key())) {
+            sectionHashes[it.key()] = it.value();
+        }
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["configs"] = configs;
+    result["sectionHashes"] = sectionHashes;
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleConfigSave(int userId, const QJsonObject& body) {
+    if (!body.contains("configs") || body.value("configs").isNull()) {
+        return Response(400, errorBody("配置数据不能为空"));
+    }
+
+    // 哈希与已保存的相同的段不再写入
+    QJsonObject& configs = m_configs[userId];
+    QJsonObject& storedHashes = m_configHashes[userId];
+    const QJsonObject hashes = body.value("sectionHashes").toObject();
+    const QJsonObject updates = body.value("configs").toObject();
+    QJsonArray notModified;
+    for (auto it = updates.begin(); it != updates.end(); ++it) {
+        QString hash = hashes.value(it.key()).toString();
+        if (!hash.isEmpty() && storedHashes.value(it.key()).toString() == hash) {
+            notModified.append(it.key());
+            continue;
+        }
+        configs.insert(it.key(), it.value());
+        if (hash.isEmpty()) {
+            storedHashes.remove(it.key());
+        } else {
+            storedHashes.insert(it.key(), hash);
+        }
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["message"] = "配置保存成功";
+    result["notModified"] = notModified;
+    result["sectionHashes"] = hashes;
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleFrpcGet(int userId) {
+    QJsonObject result;
+    result["success"] = true;
+    result["frpc"] = m_configs.value(userId).value("frpc").toObject();
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleFrpcSave(int userId, const QJsonObject& body) {
+    if (!body.contains("frpc") || body.value("frpc").isNull()) {
+        return Response(400, errorBody("FRPC配置不能为空"));
+    }
+
+    m_configs[userId].insert("frpc", body.value("frpc"));
+    m_configHashes[userId].remove("frpc");
+
+    QJsonObject result;
+    result["success"] = true;
+    result["message"] = "FRPC配置保存成功";
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleTasksSync(int userId, const QJsonObject& body) {
+    if (!body.value("tasks").isArray()) {
+        return Response(400, errorBody("工作日志数据格式错误"));
+    }
+
+    QHash<QString, QJsonObject>& tasks = m_tasks[userId];
+    int deleted = 0;
+    const QJsonArray deletedIds = body.value("deletedTaskIds").toArray();
+    for (const QJsonValue& id : deletedIds) {
+        deleted += tasks.remove(id.toString());
+    }
+
+    const QJsonArray uploaded = body.value("tasks").toArray();
+    for (const QJsonValue& value : uploaded) {
+        QJsonObject row = taskRow(value.toObject());
+        row["seq"] = m_nextTaskSeq++;
+        tasks.insert(row.value("id").toString(), row);
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["message"] = "工作日志同步成功";
+    result["count"] = uploaded.size();
+    result["deleted"] = deleted;
+    return Response(200, result);
+}
+
+MockCloudServer::Response MockCloudServer::handleTasksIncremental(int userId, const QJsonObject& body) {
+    if (!body.value("tasks").isArray()) {
+        return Response(400, errorBody("工作日志数据格式错误"));
+    }
+
+    QHash<QString, QJsonObject>& tasks = m_tasks[userId];
+    const QJsonArray uploaded = body.value("tasks").toArray();
+    for (const QJsonValue& value : uploaded) {
+        QJsonObject row = taskRow(value.toObject());
+        row["seq"] = m_nextTaskSeq++;
+        tasks.insert(row.value("id").toString(), row);
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["inserted"] = uploaded.size();
+    return Response(200, result);
+}
+
+// sinceSeq 不小于 0 时只返回修改序号大于它的任务，按序号排列；
+// 否则 since 为空时返回全部任务，不为空时只返回 updatedAt 晚于 since 的任务，按 updatedAt 从新到旧排列。
+// cursor 为当前最大的修改序号
+MockCloudServer::Response MockCloudServer::handleTasksGet(int userId, const QString& since, qint64 sinceSeq) {
+    const QHash<QString, QJsonObject> tasks = m_tasks.value(userId);
+
+    QVector<QPair<QString, const QJsonObject*>> rows;
+    QVector<QPair<qint64, const QJsonObject*>> seqRows;
+    qint64 cursor = 0;
+    for (auto it = tasks.constBegin(); it != tasks.constEnd(); ++it) {
+        qint64 seq = it.value().value("seq").toVariant().toLongLong();
+        cursor = qMax(cursor, seq);
+        if (sinceSeq >= 0) {
+            if (seq > sinceSeq) {
+                seqRows.append(qMakePair(seq, &it.value()));
+            }
+            continue;
+        }
+        QString updatedAt = it.value().value("updatedAt").toString();
+        if (since.isEmpty() || updatedAt > since) {
+            rows.append(qMakePair(updatedAt, &it.value()));
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const QPair<QString, const QJsonObject*>& a,
+                                           const QPair<QString, const QJsonObject*>& b) {
+        return a.first > b.first;
+    });
+    std::sort(seqRows.begin(), seqRows.end(), [](const QPair<qint64, const QJsonObject*>& a,
+                                                 const QPair<qint64, const QJsonObject*>& b) {
+        return a.first < b.first;
+    });
+
+    QJsonArray array;
+    for (const auto& row : rows) {
+        array.append(*row.second);
+    }
+    for (const auto& row : seqRows) {
+        array.append(*row.second);
+    }
+
+    QJsonObject result;
+    result["success"] = true;
+    result["tasks"] = array;
+    result["cursor"] = cursor;
+    return Response(200, result);
+}
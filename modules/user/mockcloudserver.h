@@ -0,0 +1,134 @@
+#ifndef MOCKCLOUDSERVER_H
+#define MOCKCLOUDSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// 进程内的云端服务替身，行为与 server/admin-server.js 中客户端用到的接口一致：
+// 健康检查（/api/health）、认证（/api/auth/*）、配置（/api/config/get|save、/api/config/frpc/*）和工作日志（/api/config/tasks/*）。
+// 数据只保存在内存中；可注入网络延迟、带宽和丢包，用于在没有真实服务器时测试同步流程
+class MockCloudServer : public QObject {
+    Q_OBJECT
+public:
+    // 模拟的网络条件。丢包按 TCP 报文段计算，每丢一个报文段增加一次重传超时的等待
+    struct NetworkProfile {
+        QString name;
+        int latencyMs;          // 单程延迟，每个请求往返计两次
+        int jitterMs;           // 单程延迟的随机波动上限
+        double lossRate;        // 报文段丢失概率
+        int bandwidthKbps;      // 带宽，0 表示不限
+
+        NetworkProfile() : latencyMs(0), jitterMs(0), lossRate(0.0), bandwidthKbps(0) {}
+    };
+
+    // 收发统计，字节数包含 HTTP 头
+    struct Stats {
+        int requestCount;
+        qint64 bytesReceived;       // 请求在网络上的字节数（压缩后）
+        qint64 bodyBytesReceived;   // 解压后的请求体字节数
+        qint64 bytesSent;
+
+        Stats() : requestCount(0), bytesReceived(0), bodyBytesReceived(0), bytesSent(0) {}
+    };
+
+    static QStringList profileNames();
+    static NetworkProfile profile(const QString& name);     // 名称未知时返回不加限制的 local
+
+    explicit MockCloudServer(QObject* parent = nullptr);
+    ~MockCloudServer();
+
+    // 只监听本机回环地址，port 为 0 时自动分配
+    bool listen(quint16 port = 0);
+    quint16 port() const { return m_server->serverPort(); }
+    QString baseUrl() const;
+
+    void setNetworkProfile(const NetworkProfile& profile) { m_profile = profile; }
+    NetworkProfile networkProfile() const { return m_profile; }
+
+    // password 为明文，保存时与服务器一样存 SHA-256
+    int addUser(const QString& username, const QString& email, const QString& password);
+    void clearTasks();
+    int taskCount(int userId) const { return m_tasks.value(userId).size(); }
+
+    Stats stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+signals:
+    void requestHandled(const QString& method, const QString& path, int status);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    struct Request {
+        QString method;
+        QString path;
+        QHash<QString, QString> query;
+        QHash<QByteArray, QByteArray> headers;     // 头名称为小写
+        QByteArray body;
+        bool keepAlive = false;
+    };
+
+    struct Response {
+        int status;
+        QJsonObject body;
+
+        Response(int status = 200, const QJsonObject& body = QJsonObject()) : status(status), body(body) {}
+    };
+
+    struct User {
+        int id;
+        QString username;
+        QString email;
+        QString password;
+        QString createdAt;
+        QString lastLogin;
+    };
+
+    void processNext(QTcpSocket* socket);
+    // 从缓冲区取出一个完整请求；请求格式错误时 error 的状态码非 0
+    bool takeRequest(QTcpSocket* socket, Request* request, qint64* wireBytes, Response* error);
+    Response dispatch(const Request& request);
+    void sendResponse(QTcpSocket* socket, const Response& response, bool keepAlive, qint64 requestBytes);
+    int networkDelayMs(qint64 bytes) const;
+
+    int authenticate(const Request& request) const;     // 返回用户ID，未登录返回 0
+    static QJsonObject userJson(const User& user);
+
+    Response handleLogin(const QJsonObject& body);
+    Response handleRegister(const QJsonObject& body);
+    Response handleCheck(const Request& request, const QString& field);
+    Response handleProfile(const Request& request);
+    Response handleLogout(const Request& request);
+    Response handleChangePassword(int userId, const QJsonObject& body);
+    Response handleConfigGet(int userId);
+    Response handleConfigSave(int userId, const QJsonObject& body);
+    Response handleFrpcGet(int userId);
+    Response handleFrpcSave(int userId, const QJsonObject& body);
+    Response handleTasksSync(int userId, const QJsonObject& body);
+    Response handleTasksGet(int userId, const QString& since, qint64 sinceSeq = -1);
+    Response handleTasksIncremental(int userId, const QJsonObject& body);
+
+    QTcpServer* m_server;
+    NetworkProfile m_profile;
+    Stats m_stats;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QHash<QTcpSocket*, bool> m_busy;            // 正在等待模拟延迟的连接，回复前不处理下一个请求
+
+    int m_nextUserId;
+    qint64 m_nextTaskSeq;                               // 与 user_tasks 的自增行号一致，每次写入任务递增
+    QHash<int, User> m_users;
+    QHash<QString, int> m_sessions;                     // token -> 用户ID
+    QHash<int, QJsonObject> m_configs;                  // 用户ID -> key -> 配置
+    QHash<int, QJsonObject> m_configHashes;             // 用户ID -> key -> 客户端提供的内容哈希
+    QHash<int, QHash<QString, QJsonObject>> m_tasks;    // 用户ID -> 任务ID -> 任务
+};
+
+#endif // MOCKCLOUDSERVER_H
@@ -0,0 +1,415 @@
+#include "syncbenchmark.h"
+#include "mockcloudserver.h"
+#include "userapi.h"
+#include "usermenuwidget.h"
+#include "../core/database.h"
+#include <QCoreApplication>
+#include <QWidget>
+#include <QDir>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSettings>
+#include <QTextStream>
+#include <functional>
+
+#define BENCHMARK_EMAIL "benchmark@example.com"
+#define BENCHMARK_PASSWORD "benchmark123"
+// 大数据量在慢速网络下耗时较长，超时放宽到 10 分钟
+#define BENCHMARK_TIMEOUT_MS (10 * 60 * 1000)
+// 低于该值的耗时差异视为测量噪声，不判为回退
+#define BENCHMARK_NOISE_MS 50
+
+// 执行 start 并等待 sender 发出完成或失败信号，记录耗时和服务器统计的传输量。
+// start 可能同步发出失败信号（如未登录），此时不进入事件循环；返回 false 表示没有发出请求
+template <typename Sender, typename DoneSignal, typename FailSignal>
+static SyncBenchmark::Result runStep(MockCloudServer* server, const QString& step, int taskCount,
+                                     const std::function<bool()>& start,
+                                     Sender* sender, DoneSignal doneSignal, FailSignal failSignal) {
+    SyncBenchmark::Result result;
+    result.step = step;
+    result.taskCount = taskCount;
+    server->resetStats();
+
+    QEventLoop loop;
+    bool finished = false;
+    QMetaObject::Connection done = QObject::connect(sender, doneSignal, &loop, [&]() {
+        result.ok = true;
+        finished = true;
+        loop.quit();
+    });
+    QMetaObject::Connection failed = QObject::connect(sender, failSignal, &loop, [&](const QString& error) {
+        result.error = error;
+        finished = true;
+        loop.quit();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!start() && !finished) {
+        result.error = "request not started";
+        finished = true;
+    }
+    if (!finished) {
+        loop.exec();
+    }
+    result.elapsedMs = timer.elapsed();
+
+    QObject::disconnect(done);
+    QObject::disconnect(failed);
+
+    MockCloudServer::Stats stats = server->stats();
+    result.requests = stats.requestCount;
+    result.requestBytes = stats.bytesReceived;
+    result.bodyBytes = stats.bodyBytesReceived;
+    result.responseBytes = stats.bytesSent;
+    return result;
+}
+
+SyncBenchmark::Options SyncBenchmark::parseArguments(const QStringList& args) {
+    Options options;
+    options.taskCounts << 1000 << 10000 << 100000;
+    options.profile = "local";
+
+    for (int i = 0; i + 1 < args.size(); ++i) {
+        const QString& arg = args.at(i);
+        const QString& value = args.at(i + 1);
+        if (arg == "--tasks") {
+            options.taskCounts.clear();
+            for (const QString& count : value.split(',', Qt::SkipEmptyParts)) {
+                int n = count.trimmed().toInt();
+                if (n > 0) {
+                    options.taskCounts << n;
+                }
+            }
+        } else if (arg == "--profile") {
+            options.profile = value;
+        } else if (arg == "--output") {
+            options.outputPath = value;
+        } else if (arg == "--baseline") {
+            options.baselinePath = value;
+        } else if (arg == "--tolerance") {
+            options.tolerance = value.toDouble();
+        }
+    }
+    return options;
+}
+
+SyncBenchmark::SyncBenchmark(QObject* parent)
+    : QObject(parent)
+    , m_lastDownloadCount(-1)
+    , m_lastDownloadCursor(0) {
+}
+
+// 字段与 UserMenuWidget 上传时的格式一致，每天 20 条，向前排列
+QJsonArray SyncBenchmark::generateTasks(int count, const QDateTime& updatedAt) {
+    QJsonArray tasks;
+    QDate today = updatedAt.date();
+    QString updated = updatedAt.toString(Qt::ISODate);
+
+    for (int i = 0; i < count; ++i) {
+        QDate day = today.addDays(-(i / 20));
+        QDateTime completion(day, QTime(9, 0).addSecs((i % 20) * 1200), Qt::UTC);
+
+        QJsonObject task;
+        task["id"] = day.toString("yyyyMMdd") + QString("%1").arg(i % 20 + 1, 3, 10, QChar('0'));
+        task["title"] = QString("基准任务 %1").arg(i);
+        task["description"] = QString("同步基准测试生成的第 %1 条工作日志，用于测量上传下载的耗时和数据量。").arg(i);
+        task["categoryId"] = i % 5;
+        task["priority"] = i % 3;
+        task["status"] = i % 2;
+        task["workDuration"] = 30 + i % 90;
+        task["completionTime"] = completion.toString(Qt::ISODate);
+        task["tags"] = QJsonArray{ "benchmark", QString("tag%1").arg(i % 10) };
+        task["updatedAt"] = updated;
+        tasks.append(task);
+    }
+    return tasks;
+}
+
+int SyncBenchmark::run(const Options& options) {
+    QTextStream out(stdout);
+
+    MockCloudServer server;
+    server.setNetworkProfile(MockCloudServer::profile(options.profile));
+    if (!server.listen()) {
+        return 1;
+    }
+    server.addUser("benchmark", BENCHMARK_EMAIL, BENCHMARK_PASSWORD);
+
+    // 清除上次运行留下的配置确认记录，否则配置上传会被跳过
+    QSettings().remove("configSync");
+
+    ApiClient* client = ApiClient::instance();
+    client->setBaseUrl(server.baseUrl());
+    client->setDefaultTimeout(BENCHMARK_TIMEOUT_MS);
+
+    out << "Sync benchmark, profile: " << server.networkProfile().name
+        << ", server: " << server.baseUrl() << Qt::endl;
+
+    connect(TaskSync::instance(), &TaskSync::tasksSynced, this, [this](const QJsonArray& tasks, qint64 cursor) {
+        m_lastDownloadCount = tasks.size();
+        m_lastDownloadCursor = cursor;
+    });
+
+    m_results.clear();
+    UserManager* users = UserManager::instance();
+    m_results.append(runStep(&server, "login", 0, [users]() {
+        users->login(BENCHMARK_EMAIL, BENCHMARK_PASSWORD);
+        return true;
+    }, users, &UserManager::loginSuccess, &UserManager::loginFailed));
+
+    if (m_results.last().ok) {
+        ConfigSync* configSync = ConfigSync::instance();
+        QJsonObject configs;
+        configs["benchmark"] = QJsonObject{ { "theme", "light" }, { "autoSync", true } };
+        m_results.append(runStep(&server, "config-save", 0, [configSync, configs]() {
+            configSync->saveAllConfig(configs);
+            return true;
+        }, configSync, &ConfigSync::configSaved, &ConfigSync::syncFailed));
+        m_results.append(runStep(&server, "config-load", 0, [configSync]() {
+            configSync->fetchConfig();
+            return true;
+        }, configSync, &ConfigSync::configLoaded, &ConfigSync::syncFailed));
+
+        for (int taskCount : options.taskCounts) {
+            runTaskSteps(&server, taskCount);
+            runAppSteps(&server, taskCount);
+        }
+    }
+
+    bool allOk = true;
+    out << QString("%1 %2 %3 %4 %5 %6 %7")
+               .arg("step", -16).arg("tasks", 8).arg("ms", 8).arg("requests", 8)
+               .arg("sent", 12).arg("body", 12).arg("received", 12) << Qt::endl;
+    for (const Result& result : m_results) {
+        out << QString("%1 %2 %3 %4 %5 %6 %7")
+                   .arg(result.step, -16).arg(result.taskCount, 8).arg(result.elapsedMs, 8).arg(result.requests, 8)
+                   .arg(result.requestBytes, 12).arg(result.bodyBytes, 12).arg(result.responseBytes, 12);
+        if (!result.ok) {
+            out << "  FAILED: " << result.error;
+            allOk = false;
+        }
+        out << Qt::endl;
+    }
+
+    if (!options.outputPath.isEmpty() && !writeResults(options.outputPath, server.networkProfile().name)) {
+        allOk = false;
+    }
+
+    int regressions = 0;
+    if (!options.baselinePath.isEmpty()) {
+        regressions = compareWithBaseline(options.baselinePath, options.tolerance);
+    }
+
+    return (allOk && regressions == 0) ? 0 : 1;
+}
+
+// 全量上传、全量下载，再修改 1% 并删除 0.1% 后做增量上传和增量下载
+void SyncBenchmark::runTaskSteps(MockCloudServer* server, int taskCount) {
+    TaskSync* taskSync = TaskSync::instance();
+    server->clearTasks();
+
+    QDateTime baseTime = QDateTime::currentDateTimeUtc().addSecs(-3600);
+    baseTime.setTime(QTime(baseTime.time().hour(), baseTime.time().minute(), baseTime.time().second()));
+    QJsonArray tasks = generateTasks(taskCount, baseTime);
+
+    m_results.append(runStep(server, "upload-full", taskCount, [taskSync, tasks]() {
+        return taskSync->uploadTasksWithDeleted(tasks, QStringList());
+    }, taskSync, &TaskSync::tasksUploadComplete, &TaskSync::syncFailed));
+    if (!m_results.last().ok) return;
+
+    m_lastDownloadCount = -1;
+    m_results.append(runStep(server, "download-full", taskCount, [taskSync]() {
+        taskSync->downloadTasks();
+        return true;
+    }, taskSync, &TaskSync::tasksSynced, &TaskSync::syncFailed));
+    if (m_results.last().ok && m_lastDownloadCount != taskCount) {
+        m_results.last().ok = false;
+        m_results.last().error = QString("expected %1 tasks, got %2").arg(taskCount).arg(m_lastDownloadCount);
+        return;
+    }
+    qint64 fullCursor = m_lastDownloadCursor;
+
+    int changedCount = qMax(1, taskCount / 100);
+    int deletedCount = qMax(1, taskCount / 1000);
+    QString changedAt = baseTime.addSecs(60).toString(Qt::ISODate);
+    QJsonArray changed;
+    QStringList deleted;
+    for (int i = 0; i < changedCount && i < tasks.size(); ++i) {
+        QJsonObject task = tasks.at(i).toObject();
+        task["status"] = 1;
+        task["updatedAt"] = changedAt;
+        changed.append(task);
+    }
+    for (int i = qMax(changed.size(), tasks.size() - deletedCount); i < tasks.size(); ++i) {
+        deleted << tasks.at(i).toObject().value("id").toString();
+    }
+
+    m_results.append(runStep(server, "upload-delta", taskCount, [taskSync, changed, deleted]() {
+        return taskSync->uploadTasksWithDeleted(changed, deleted);
+    }, taskSync, &TaskSync::tasksUploadComplete, &TaskSync::syncFailed));
+    if (!m_results.last().ok) return;
+
+    // 从全量下载返回的位置开始，只应收到增量上传的任务
+    m_lastDownloadCount = -1;
+    qint64 since = fullCursor;
+    m_results.append(runStep(server, "download-delta", taskCount, [taskSync, since]() {
+        taskSync->downloadIncrementalTasks(since);
+        return true;
+    }, taskSync, &TaskSync::tasksSynced, &TaskSync::syncFailed));
+    if (m_results.last().ok && m_lastDownloadCount != changed.size()) {
+        m_results.last().ok = false;
+        m_results.last().error = QString("expected %1 tasks, got %2").arg(changed.size()).arg(m_lastDownloadCount);
+    }
+}
+
+// 经由 UserMenuWidget 完成应用内的同步：从本地数据库取出待上传的任务上传，上传完成后增量下载并合并回数据库。
+// 每步以合并结束（tasksSynced）为止，耗时包含数据库的查询、合并和保存
+void SyncBenchmark::runAppSteps(MockCloudServer* server, int taskCount) {
+    server->clearTasks();
+
+    // 基准使用单独的组织名，数据目录与正常使用的不同，每次从空数据库开始
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+
+    Database db;
+    if (!db.init()) {
+        Result result;
+        result.step = "app-sync-full";
+        result.taskCount = taskCount;
+        result.error = "cannot initialize database";
+        m_results.append(result);
+        return;
+    }
+
+    // 任务按 ID 中的日期分布在多个月份的分段中，都标记为待上传
+    const QJsonArray tasks = generateTasks(taskCount, QDateTime::currentDateTimeUtc().addSecs(-3600));
+    QStringList ids;
+    {
+        DatabaseTransaction transaction(&db);
+        for (const QJsonValue& value : tasks) {
+            const QJsonObject obj = value.toObject();
+            Task task;
+            task.id = obj["id"].toString();
+            task.title = obj["title"].toString();
+            task.description = obj["description"].toString();
+            task.categoryId = obj["categoryId"].toInt();
+            task.priority = static_cast<TaskPriority>(obj["priority"].toInt());
+            task.status = static_cast<TaskStatus>(obj["status"].toInt());
+            task.workDuration = obj["workDuration"].toDouble();
+            task.completionTime = QDateTime::fromString(obj["completionTime"].toString(), Qt::ISODate).toLocalTime();
+            task.updatedAt = QDateTime::fromString(obj["updatedAt"].toString(), Qt::ISODate).toLocalTime();
+            for (const QJsonValue& tag : obj["tags"].toArray()) {
+                task.tags.append(tag.toString());
+            }
+            db.addTaskWithId(task);
+            db.updateTaskVersion(task.id);
+            ids.append(task.id);
+        }
+        transaction.commit();
+    }
+
+    // 构造时若已登录会安排一次自动同步，先让它在没有数据库时空转，之后的同步都由基准发起
+    QWidget host;
+    UserMenuWidget widget(&host);
+    QCoreApplication::processEvents();
+    widget.m_db = &db;
+
+    TaskSync* taskSync = TaskSync::instance();
+    UserMenuWidget* widgetPtr = &widget;
+    m_results.append(runStep(server, "app-sync-full", taskCount, [widgetPtr]() {
+        return widgetPtr->uploadPendingTasks(true);
+    }, taskSync, &TaskSync::tasksSynced, &TaskSync::syncFailed));
+    if (!m_results.last().ok) return;
+
+    // 修改 1%、删除 0.1% 后增量同步
+    int changedCount = qMax(1, taskCount / 100);
+    int deletedCount = qMax(1, taskCount / 1000);
+    {
+        DatabaseTransaction transaction(&db);
+        for (int i = 0; i < changedCount && i < ids.size(); ++i) {
+            Task task = db.getTaskById(ids.at(i));
+            task.status = TaskStatus_Completed;
+            db.updateTask(task);
+        }
+        for (int i = qMax(changedCount, ids.size() - deletedCount); i < ids.size(); ++i) {
+            db.deleteTask(ids.at(i));
+        }
+        transaction.commit();
+    }
+
+    m_results.append(runStep(server, "app-sync-delta", taskCount, [widgetPtr]() {
+        return widgetPtr->uploadPendingTasks(false);
+    }, taskSync, &TaskSync::tasksSynced, &TaskSync::syncFailed));
+}
+
+bool SyncBenchmark::writeResults(const QString& path, const QString& profile) const {
+    QJsonArray results;
+    for (const Result& result : m_results) {
+        QJsonObject obj;
+        obj["step"] = result.step;
+        obj["tasks"] = result.taskCount;
+        obj["elapsedMs"] = result.elapsedMs;
+        obj["requests"] = result.requests;
+        obj["requestBytes"] = result.requestBytes;
+        obj["bodyBytes"] = result.bodyBytes;
+        obj["responseBytes"] = result.responseBytes;
+        obj["ok"] = result.ok;
+        results.append(obj);
+    }
+
+    QJsonObject root;
+    root["profile"] = profile;
+    root["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = results;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write benchmark results:" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return file.commit();
+}
+
+int SyncBenchmark::compareWithBaseline(const QString& path, double tolerance) const {
+    QTextStream out(stdout);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot read benchmark baseline:" << path;
+        return 1;
+    }
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+    QHash<QString, QJsonObject> baseline;
+    for (const QJsonValue& value : root.value("results").toArray()) {
+        QJsonObject obj = value.toObject();
+        baseline.insert(obj.value("step").toString() + "/" + QString::number(obj.value("tasks").toInt()), obj);
+    }
+
+    int regressions = 0;
+    for (const Result& result : m_results) {
+        QString key = result.step + "/" + QString::number(result.taskCount);
+        if (!result.ok || !baseline.contains(key)) continue;
+
+        QJsonObject base = baseline.value(key);
+        qint64 baseMs = static_cast<qint64>(base.value("elapsedMs").toDouble());
+        qint64 baseBytes = static_cast<qint64>(base.value("requestBytes").toDouble());
+        if (result.elapsedMs > baseMs * (1.0 + tolerance) && result.elapsedMs - baseMs > BENCHMARK_NOISE_MS) {
+            out << "REGRESSION " << key << ": " << result.elapsedMs << " ms, baseline " << baseMs << " ms" << Qt::endl;
+            ++regressions;
+        }
+        if (result.requestBytes > baseBytes * (1.0 + tolerance)) {
+            out << "REGRESSION " << key << ": " << result.requestBytes << " bytes sent, baseline "
+                << baseBytes << " bytes" << Qt::endl;
+            ++regressions;
+        }
+    }
+    return regressions;
+}
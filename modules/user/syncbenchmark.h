@@ -0,0 +1,65 @@
+#ifndef SYNCBENCHMARK_H
+#define SYNCBENCHMARK_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonArray>
+#include <QDateTime>
+
+class MockCloudServer;
+
+// 端到端同步基准：在进程内启动 MockCloudServer，经由 ApiClient、TaskSync、ConfigSync 和 UserManager
+// 完成登录、全量上传下载、增量上传下载，再经由 UserMenuWidget 和本地数据库完成应用内的上传与合并，
+// 记录每一步的耗时和网络传输量。
+// 可与上次保存的结果比较，超出容差的耗时或传输量视为性能回退
+class SyncBenchmark : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QList<int> taskCounts;
+        QString profile;            // MockCloudServer::profileNames() 之一
+        QString outputPath;         // 结果写成 JSON，为空时不写
+        QString baselinePath;       // 用于比较的上次结果，为空时不比较
+        double tolerance;           // 允许超出基线的比例
+
+        Options() : tolerance(0.25) {}
+    };
+
+    struct Result {
+        QString step;
+        int taskCount;
+        qint64 elapsedMs;
+        int requests;
+        qint64 requestBytes;        // 请求在网络上的字节数（压缩后）
+        qint64 bodyBytes;           // 解压后的请求体字节数
+        qint64 responseBytes;
+        bool ok;
+        QString error;
+
+        Result() : taskCount(0), elapsedMs(0), requests(0), requestBytes(0), bodyBytes(0), responseBytes(0), ok(false) {}
+    };
+
+    // 解析 --tasks 1000,10000 --profile lan --output a.json --baseline b.json --tolerance 0.25
+    static Options parseArguments(const QStringList& args);
+
+    explicit SyncBenchmark(QObject* parent = nullptr);
+
+    // 返回进程退出码：全部步骤成功且没有性能回退时为 0
+    int run(const Options& options);
+
+private:
+    static QJsonArray generateTasks(int count, const QDateTime& updatedAt);
+    void runTaskSteps(MockCloudServer* server, int taskCount);
+    void runAppSteps(MockCloudServer* server, int taskCount);
+    bool writeResults(const QString& path, const QString& profile) const;
+    int compareWithBaseline(const QString& path, double tolerance) const;      // 返回回退的项数
+
+    QVector<Result> m_results;
+    int m_lastDownloadCount;
+    qint64 m_lastDownloadCursor;
+};
+
+#endif // SYNCBENCHMARK_H
@@ -1,4 +1,5 @@
 #include "userapi.h"
+#include "../core/networkmonitor.h"
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QNetworkCookie>
@@ -11,6 +12,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QCoreApplication>
+#include <QBuffer>
 
 QString hashPassword(const QString& password) {
     QByteArray data = password.toUtf8();
@@ -67,6 +69,101 @@ static void writeHttpLog(const QString& type, const QString& endpoint, const QSt
     file.close();
 }
 
+// 请求体达到该大小才压缩，小请求压缩收益不抵开销
+#define REQUEST_COMPRESS_THRESHOLD 1024
+// 请求体超过该大小时日志只记录长度
+#define HTTP_LOG_BODY_LIMIT 4096
+
+static quint32 crc32(const QByteArray& data) {
+    static quint32 table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    quint32 crc = 0xFFFFFFFFu;
+    const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+    for (int i = 0; i < data.size(); ++i) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void appendLittleEndian32(QByteArray& out, quint32 value) {
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// qCompress 的输出为 4 字节原始长度 + zlib 流（2 字节头、deflate 数据、4 字节 Adler-32），
+// 取出其中的 deflate 数据，加上 gzip 头和 CRC-32/长度尾即为 gzip 格式
+static QByteArray gzipCompress(const QByteArray& data) {
+    QByteArray zlib = qCompress(data, 6);
+    int deflateSize = zlib.size() - 4 - 2 - 4;
+
+    QByteArray out;
+    out.reserve(10 + deflateSize + 8);
+    static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff' };
+    out.append(header, sizeof(header));
+    out.append(zlib.constData() + 6, deflateSize);
+    appendLittleEndian32(out, crc32(data));
+    appendLittleEndian32(out, static_cast<quint32>(data.size()));
+    return out;
+}
+
+// 同时进行的请求数上限（与 Qt 对同一主机的并发连接数一致）和排队上限
+#define API_MAX_IN_FLIGHT 6
+#define API_MAX_QUEUED 256
+// 默认请求超时
+#define API_DEFAULT_TIMEOUT_MS 30000
+
+ApiRequest::ApiRequest(quint64 id, const QString& method, const QString& endpoint, ApiClient* client)
+    : QObject(client)
+    , m_client(client)
+    , m_id(id)
+    , m_method(method)
+    , m_endpoint(endpoint)
+    , m_body(nullptr)
+    , m_reply(nullptr)
+    , m_timer(new QTimer(this))
+    , m_timeoutMs(client->defaultTimeout())
+    , m_statusCode(0)
+    , m_finished(false)
+    , m_canceled(false)
+    , m_timedOut(false) {
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, [this]() {
+        if (m_reply && !m_finished) {
+            m_timedOut = true;
+            m_reply->abort();
+        }
+    });
+}
+
+void ApiRequest::setTimeout(int ms) {
+    m_timeoutMs = ms;
+    if (m_reply && !m_finished) {
+        if (ms > 0) {
+            m_timer->start(ms);
+        } else {
+            m_timer->stop();
+        }
+    }
+}
+
+void ApiRequest::cancel() {
+    if (m_finished) return;
+    m_canceled = true;
+    m_client->cancelRequest(this);
+}
+
 ApiClient* ApiClient::instance() {
     static ApiClient client;
     return &client;
@@ -76,6 +173,12 @@ ApiClient::ApiClient() {
     m_manager = new QNetworkAccessManager(this);
     m_baseUrl = CLOUD_API_URL;
     m_authToken = "";
+    m_compressRequests = QSettings().value("network/compressRequests", true).toBool();
+    m_nextRequestId = 1;
+    m_defaultTimeoutMs = API_DEFAULT_TIMEOUT_MS;
+    m_maxInFlight = API_MAX_IN_FLIGHT;
+    NetworkMonitor::instance()->setNetworkManager(m_manager);
+    NetworkMonitor::instance()->setDefaultProbeTarget(m_baseUrl + "/api/health");
 }
 
 ApiClient::~ApiClient() {
@@ -83,6 +186,7 @@ ApiClient::~ApiClient() {
 
 void ApiClient::setBaseUrl(const QString& url) {
     m_baseUrl = url;
+    NetworkMonitor::instance()->setDefaultProbeTarget(m_baseUrl + "/api/health");
 }
 
 void ApiClient::setAuthToken(const QString& token) {
@@ -90,7 +194,12 @@ void ApiClient::setAuthToken(const QString& token) {
     qDebug() << "Auth token set:" << token.left(20) << "...";
 }
 
-void ApiClient::get(const QString& endpoint, const QJsonObject& params) {
+void ApiClient::setMaxInFlight(int count) {
+    m_maxInFlight = qMax(1, count);
+    startQueuedRequests();
+}
+
+ApiRequest* ApiClient::get(const QString& endpoint, const QJsonObject& params) {
     QString url = m_baseUrl + endpoint;
     if (!params.isEmpty()) {
         QUrlQuery query;
@@ -100,53 +209,171 @@ void ApiClient::get(const QString& endpoint, const QJsonObject& params) {
         url += "?" + query.toString();
     }
 
+    ApiRequest* request = new ApiRequest(m_nextRequestId++, "GET", endpoint, this);
+    request->m_request = createRequest(QUrl(url));
+    return enqueue(request);
+}
+
+// 不手动设置 Accept-Encoding：QNetworkAccessManager 会自动声明支持 gzip/deflate 并透明解压响应
+QNetworkRequest ApiClient::createRequest(const QUrl& url) const {
     QNetworkRequest request;
-    request.setUrl(QUrl(url));
+    request.setUrl(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#else
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
 
     if (!m_authToken.isEmpty()) {
         request.setRawHeader("Authorization", ("Bearer " + m_authToken).toUtf8());
     }
+    return request;
+}
 
-    QNetworkReply* reply = m_manager->get(request);
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("requestBody", QString());
-    reply->setProperty("httpMethod", "GET");
-    connect(reply, &QNetworkReply::finished, this, &ApiClient::onReplyFinished);
+ApiRequest* ApiClient::post(const QString& endpoint, const QJsonObject& data) {
+    ApiRequest* request = new ApiRequest(m_nextRequestId++, "POST", endpoint, this);
+    request->m_request = createRequest(QUrl(m_baseUrl + endpoint));
+    setPostBody(request, QVariant(data));
+    return enqueue(request);
 }
 
-void ApiClient::post(const QString& endpoint, const QJsonObject& data) {
-    post(endpoint, QJsonDocument(data).toJson(QJsonDocument::Compact));
+ApiRequest* ApiClient::post(const QString& endpoint, const QString& jsonStr) {
+    ApiRequest* request = new ApiRequest(m_nextRequestId++, "POST", endpoint, this);
+    request->m_request = createRequest(QUrl(m_baseUrl + endpoint));
+    setPostBody(request, QVariant(jsonStr));
+    return enqueue(request);
 }
 
-void ApiClient::post(const QString& endpoint, const QString& jsonStr) {
-    QNetworkRequest request;
-    request.setUrl(QUrl(m_baseUrl + endpoint));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+ApiRequest* ApiClient::deleteResource(const QString& endpoint) {
+    ApiRequest* request = new ApiRequest(m_nextRequestId++, "DELETE", endpoint, this);
+    request->m_request = createRequest(QUrl(m_baseUrl + endpoint));
+    return enqueue(request);
+}
 
-    if (!m_authToken.isEmpty()) {
-        request.setRawHeader("Authorization", ("Bearer " + m_authToken).toUtf8());
+// data 为 QJsonObject 或 JSON 字符串；请求体归请求对象所有
+void ApiClient::setPostBody(ApiRequest* request, const QVariant& data) {
+    // 重发时旧请求体可能仍被上一次的 reply 引用，延迟释放
+    if (request->m_body) {
+        request->m_body->deleteLater();
+        request->m_body = nullptr;
+    }
+    request->m_contentEncoding.clear();
+
+    // 只序列化一次；压缩后未压缩的数据随即释放。
+    // 请求体整体放在内存中：压缩需要完整输入（qCompress 没有增量接口），不再边发送边序列化
+    QByteArray bytes = data.type() == QVariant::String
+        ? data.toString().toUtf8()
+        : QJsonDocument(data.toJsonObject()).toJson(QJsonDocument::Compact);
+    request->m_logBody = bytes.size() <= HTTP_LOG_BODY_LIMIT ? QString::fromUtf8(bytes)
+                                                             : QString("<%1 bytes>").arg(bytes.size());
+
+    if (m_compressRequests && bytes.size() >= REQUEST_COMPRESS_THRESHOLD) {
+        bytes = gzipCompress(bytes);
+        request->m_contentEncoding = "gzip";
     }
+    // 只有压缩的请求可能因 415 重发而需要原始数据；data 可能就是 m_retryData，最后再赋值
+    request->m_retryData = request->m_contentEncoding.isEmpty() ? QVariant() : data;
 
-    QNetworkReply* reply = m_manager->post(request, jsonStr.toUtf8());
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("requestBody", jsonStr);
-    reply->setProperty("httpMethod", "POST");
-    connect(reply, &QNetworkReply::finished, this, &ApiClient::onReplyFinished);
+    QBuffer* buffer = new QBuffer(request);
+    buffer->setData(bytes);
+    buffer->open(QIODevice::ReadOnly);
+    request->m_body = buffer;
+
+    request->m_request.setHeader(QNetworkRequest::ContentLengthHeader, request->m_body->size());
+    if (request->m_contentEncoding.isEmpty()) {
+        request->m_request.setRawHeader("Content-Encoding", QByteArray());
+    } else {
+        request->m_request.setRawHeader("Content-Encoding", request->m_contentEncoding);
+    }
 }
 
-void ApiClient::onReplyFinished() {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) {
-        qDebug() << "[API 响应] reply 为空";
-        return;
+ApiRequest* ApiClient::enqueue(ApiRequest* request) {
+    if (m_queue.size() >= API_MAX_QUEUED) {
+        // 异步报告失败，让调用方有机会先连接信号
+        qWarning() << "[API 请求] 队列已满，丢弃请求:" << request->m_endpoint;
+        QTimer::singleShot(0, request, [this, request]() {
+            finishRequest(request, false, QJsonDocument(), 0, "Request queue full");
+        });
+        return request;
+    }
+
+    m_queue.enqueue(request);
+    // 在下一轮事件循环中发出，调用方连接信号后才可能收到结果
+    QTimer::singleShot(0, this, [this]() { startQueuedRequests(); });
+    return request;
+}
+
+void ApiClient::startQueuedRequests() {
+    while (m_inFlight.size() < m_maxInFlight && !m_queue.isEmpty()) {
+        startRequest(m_queue.dequeue());
+    }
+}
+
+void ApiClient::startRequest(ApiRequest* request) {
+    QNetworkReply* reply;
+    if (request->m_method == "POST") {
+        request->m_body->seek(0);
+        reply = m_manager->post(request->m_request, request->m_body);
+    } else if (request->m_method == "DELETE") {
+        reply = m_manager->deleteResource(request->m_request);
+    } else {
+        reply = m_manager->get(request->m_request);
+    }
+
+    request->m_reply = reply;
+    m_inFlight.insert(request);
+    connect(reply, &QNetworkReply::finished, request, [this, request]() { onReplyFinished(request); });
+    if (request->m_timeoutMs > 0) {
+        request->m_timer->start(request->m_timeoutMs);
+    }
+}
+
+void ApiClient::cancelRequest(ApiRequest* request) {
+    if (request->m_reply) {
+        // abort 会同步触发 finished，由 onReplyFinished 统一收尾
+        request->m_reply->abort();
+    } else {
+        m_queue.removeOne(request);
+        finishRequest(request, false, QJsonDocument(), 0, "Request canceled");
     }
+}
 
-    QString endpoint = reply->property("endpoint").toString();
-    QString requestBody = reply->property("requestBody").toString();
-    QString httpMethod = reply->property("httpMethod").toString();
+void ApiClient::onReplyFinished(ApiRequest* request) {
+    QNetworkReply* reply = request->m_reply;
+    request->m_timer->stop();
+
+    QString endpoint = request->m_endpoint;
+    QString requestBody = request->m_logBody;
+    QString httpMethod = request->m_method;
     int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    qDebug() << "[API 响应]" << "endpoint:" << endpoint << "status:" << statusCode;
+    request->m_statusCode = statusCode;
+    qDebug() << "[API 响应]" << "id:" << request->m_id << "endpoint:" << endpoint << "status:" << statusCode;
+
+    // 收到任何 HTTP 响应都说明服务器可达，连接失败或超时说明不可达，NetworkMonitor 据此省去单独的探测
+    if (!request->m_canceled) {
+        NetworkMonitor::instance()->reportRequestResult(statusCode > 0);
+    }
+
+    if (request->m_canceled || request->m_timedOut) {
+        QString error = request->m_canceled ? "Request canceled" : "Request timed out";
+        qDebug() << "[API 响应]" << error;
+        writeHttpLog(httpMethod, endpoint, requestBody, statusCode, QString(), error);
+        finishRequest(request, false, QJsonDocument(), statusCode, error);
+        return;
+    }
+
+    // 415 Unsupported Media Type：服务器不支持压缩的请求体，本次运行内改为不压缩并重发
+    if (statusCode == 415 && !request->m_contentEncoding.isEmpty()) {
+        qDebug() << "[API 响应] 服务器不接受压缩请求体，改为不压缩重发";
+        m_compressRequests = false;
+        m_inFlight.remove(request);
+        request->m_reply = nullptr;
+        reply->deleteLater();
+        setPostBody(request, request->m_retryData);
+        startRequest(request);
+        return;
+    }
 
     QByteArray data = reply->readAll();
     QString responseBody = QString::fromUtf8(data);
@@ -156,8 +383,7 @@ void ApiClient::onReplyFinished() {
     if (!doc.isNull() && doc.isObject()) {
         qDebug() << "[API 响应] JSON 解析成功，发送 requestSuccess";
         writeHttpLog(httpMethod, endpoint, requestBody, statusCode, responseBody, QString());
-        emit requestSuccess(endpoint, doc);
-        reply->deleteLater();
+        finishRequest(request, true, doc, statusCode, QString());
         return;
     }
 
@@ -165,17 +391,15 @@ void ApiClient::onReplyFinished() {
     if (data.isEmpty()) {
         qDebug() << "[API 响应] 响应为空";
         writeHttpLog(httpMethod, endpoint, requestBody, statusCode, QString(), "Empty response");
-        emit requestFailed(endpoint, statusCode, "Empty response");
-        reply->deleteLater();
+        finishRequest(request, false, QJsonDocument(), statusCode, "Empty response");
         return;
     }
 
-    // 网络错误处理（超时、连接失败等）
+    // 网络错误处理（连接失败等）
     if (reply->error() != QNetworkReply::NoError) {
         qDebug() << "[API 响应] 网络错误:" << reply->errorString();
         writeHttpLog(httpMethod, endpoint, requestBody, statusCode, responseBody, reply->errorString());
-        emit requestFailed(endpoint, statusCode, reply->errorString());
-        reply->deleteLater();
+        finishRequest(request, false, QJsonDocument(), statusCode, reply->errorString());
         return;
     }
 
@@ -184,8 +408,7 @@ void ApiClient::onReplyFinished() {
         QString error = responseBody.isEmpty() ? QString("HTTP %1").arg(statusCode) : responseBody;
         qDebug() << "[API 响应] HTTP 错误:" << error;
         writeHttpLog(httpMethod, endpoint, requestBody, statusCode, responseBody, error);
-        emit requestFailed(endpoint, statusCode, error);
-        reply->deleteLater();
+        finishRequest(request, false, QJsonDocument(), statusCode, error);
         return;
     }
 
@@ -193,8 +416,30 @@ void ApiClient::onReplyFinished() {
     qDebug() << "[API 响应] JSON 解析失败，响应内容:" << responseBody.left(200);
     QString jsonError = "Invalid JSON response";
     writeHttpLog(httpMethod, endpoint, requestBody, statusCode, responseBody, jsonError);
-    emit requestFailed(endpoint, statusCode, jsonError);
-    reply->deleteLater();
+    finishRequest(request, false, QJsonDocument(), statusCode, jsonError);
+}
+
+void ApiClient::finishRequest(ApiRequest* request, bool success, const QJsonDocument& response,
+                              int errorCode, const QString& error) {
+    if (request->m_finished) return;
+    request->m_finished = true;
+    request->m_timer->stop();
+    m_inFlight.remove(request);
+    if (request->m_reply) {
+        request->m_reply->deleteLater();
+        request->m_reply = nullptr;
+    }
+
+    if (success) {
+        emit requestSuccess(request->m_endpoint, response);
+        emit request->succeeded(response);
+    } else {
+        emit requestFailed(request->m_endpoint, errorCode, error);
+        emit request->failed(errorCode, error);
+    }
+
+    request->deleteLater();
+    startQueuedRequests();
 }
 
 UserManager* UserManager::instance() {
@@ -203,9 +448,17 @@ UserManager* UserManager::instance() {
 }
 
 UserManager::UserManager() : QObject(), m_pendingRequest(""), m_isLoggedIn(false) {
-    ApiClient* client = ApiClient::instance();
-    connect(client, &ApiClient::requestSuccess, this, &UserManager::onApiResponse);
-    connect(client, &ApiClient::requestFailed, this, &UserManager::onRequestFailed);
+}
+
+// 只处理自己发出的请求的结果，其他模块对同一 endpoint 的请求不会被误当作登录等操作的响应
+void UserManager::sendRequest(ApiRequest* request) {
+    QString endpoint = request->endpoint();
+    connect(request, &ApiRequest::succeeded, this, [this, endpoint](const QJsonDocument& response) {
+        onApiResponse(endpoint, response);
+    });
+    connect(request, &ApiRequest::failed, this, [this, endpoint](int errorCode, const QString& error) {
+        onRequestFailed(endpoint, errorCode, error);
+    });
 }
 
 void UserManager::login(const QString& email, const QString& password) {
@@ -217,7 +470,7 @@ void UserManager::login(const QString& email, const QString& password) {
     data["password"] = hashPassword(password);
     
     m_pendingRequest = "/api/auth/login";
-    ApiClient::instance()->post("/api/auth/login", data);
+    sendRequest(ApiClient::instance()->post("/api/auth/login", data));
 }
 
 void UserManager::loginByUsername(const QString& username, const QString& password) {
@@ -229,7 +482,7 @@ void UserManager::loginByUsername(const QString& username, const QString& passwo
     data["password"] = hashPassword(password);
     
     m_pendingRequest = "/api/auth/login";
-    ApiClient::instance()->post("/api/auth/login", data);
+    sendRequest(ApiClient::instance()->post("/api/auth/login", data));
 }
 
 void UserManager::loginAuto(const QString& identifier, const QString& password) {
@@ -257,7 +510,7 @@ void UserManager::registerUser(const QString& username, const QString& email, co
     data["password"] = hashPassword(password);
     
     m_pendingRequest = "/api/auth/register";
-    ApiClient::instance()->post("/api/auth/register", data);
+    sendRequest(ApiClient::instance()->post("/api/auth/register", data));
 }
 
 void UserManager::checkEmailExists(const QString& email) {
@@ -266,7 +519,7 @@ void UserManager::checkEmailExists(const QString& email) {
     m_pendingRequest = "/api/auth/check-email";
     QString url = "/api/auth/check-email?email=" + QUrl::toPercentEncoding(email);
     qDebug() << "[检查邮箱] 请求 URL:" << url;
-    ApiClient::instance()->get(url);
+    sendRequest(ApiClient::instance()->get(url));
 }
 
 void UserManager::checkUsernameExists(const QString& username) {
@@ -274,7 +527,7 @@ void UserManager::checkUsernameExists(const QString& username) {
     m_pendingRequest = "/api/auth/check-username";
     QString url = "/api/auth/check-username?username=" + QUrl::toPercentEncoding(username);
     qDebug() << "[检查用户名] 请求 URL:" << url;
-    ApiClient::instance()->get(url);
+    sendRequest(ApiClient::instance()->get(url));
 }
 
 void UserManager::logout() {
@@ -282,7 +535,7 @@ void UserManager::logout() {
     
     // 调用后端 API 记录登出日志（先发送请求，收到响应后再清除本地数据）
     m_pendingRequest = "/api/auth/logout";
-    ApiClient::instance()->post("/api/auth/logout", QJsonObject());
+    sendRequest(ApiClient::instance()->post("/api/auth/logout", QJsonObject()));
     
     qDebug() << "[登出] 已发送登出请求，等待响应";
 }
@@ -294,7 +547,7 @@ void UserManager::fetchProfile() {
     }
     
     m_pendingRequest = "/api/auth/profile";
-    ApiClient::instance()->get("/api/auth/profile");
+    sendRequest(ApiClient::instance()->get("/api/auth/profile"));
 }
 
 void UserManager::autoLogin() {
@@ -309,7 +562,7 @@ void UserManager::autoLogin() {
         m_token = token;
         ApiClient::instance()->setAuthToken(token);
         m_pendingRequest = "/api/auth/profile";
-        ApiClient::instance()->get("/api/auth/profile");
+        sendRequest(ApiClient::instance()->get("/api/auth/profile"));
     } else {
         qDebug() << "[自动登录] 未找到保存的用户信息，跳过自动登录";
     }
@@ -330,7 +583,7 @@ void UserManager::updateProfile(const QString& username, const QString& avatar)
         data["avatar"] = avatar;
     }
     
-    ApiClient::instance()->post("/api/user/update-profile", data);
+    sendRequest(ApiClient::instance()->post("/api/user/update-profile", data));
 }
 
 void UserManager::changePassword(const QString& oldPassword, const QString& newPassword) {
@@ -344,7 +597,7 @@ void UserManager::changePassword(const QString& oldPassword, const QString& newP
     data["old_password"] = hashPassword(oldPassword);
     data["new_password"] = hashPassword(newPassword);
     
-    ApiClient::instance()->post("/api/auth/change-password", data);
+    sendRequest(ApiClient::instance()->post("/api/auth/change-password", data));
 }
 
 void UserManager::requestPasswordReset(const QString& email) {
@@ -353,7 +606,7 @@ void UserManager::requestPasswordReset(const QString& email) {
     QJsonObject data;
     data["email"] = email;
     
-    ApiClient::instance()->post("/api/auth/request-password-reset", data);
+    sendRequest(ApiClient::instance()->post("/api/auth/request-password-reset", data));
 }
 
 void UserManager::resetPassword(const QString& token, const QString& newPassword) {
@@ -363,7 +616,7 @@ void UserManager::resetPassword(const QString& token, const QString& newPassword
     data["token"] = token;
     data["new_password"] = hashPassword(newPassword);
     
-    ApiClient::instance()->post("/api/auth/reset-password", data);
+    sendRequest(ApiClient::instance()->post("/api/auth/reset-password", data));
 }
 
 void UserManager::onApiResponse(const QString& endpoint, const QJsonDocument& response) {
@@ -615,11 +868,6 @@ ConfigSync* ConfigSync::instance() {
 }
 
 ConfigSync::ConfigSync() : QObject(), m_isSyncing(false) {
-    ApiClient* client = ApiClient::instance();
-    connect(client, &ApiClient::requestSuccess, this, &ConfigSync::onConfigLoaded);
-    connect(client, &ApiClient::requestSuccess, this, &ConfigSync::onConfigSaved);
-    connect(client, &ApiClient::requestSuccess, this, &ConfigSync::onFRPCConfigLoaded);
-    connect(client, &ApiClient::requestFailed, this, &ConfigSync::onRequestFailed);
 }
 
 void ConfigSync::loadSettings() {
@@ -631,7 +879,9 @@ void ConfigSync::loadSettings() {
     if (m_isSyncing) return;
     m_isSyncing = true;
 
-    ApiClient::instance()->get("/api/config/get");
+    ApiRequest* request = ApiClient::instance()->get("/api/config/get");
+    connect(request, &ApiRequest::succeeded, this, &ConfigSync::onConfigLoaded);
+    connect(request, &ApiRequest::failed, this, &ConfigSync::onRequestFailed);
 }
 
 void ConfigSync::fetchConfig() {
@@ -643,7 +893,9 @@ void ConfigSync::fetchConfig() {
     if (m_isSyncing) return;
     m_isSyncing = true;
     
-    ApiClient::instance()->get("/api/config/get");
+    ApiRequest* request = ApiClient::instance()->get("/api/config/get");
+    connect(request, &ApiRequest::succeeded, this, &ConfigSync::onConfigLoaded);
+    connect(request, &ApiRequest::failed, this, &ConfigSync::onRequestFailed);
 }
 
 void ConfigSync::saveConfig(const QString& key, const QJsonObject& config) {
@@ -659,22 +911,46 @@ void ConfigSync::saveAllConfig(const QJsonObject& configs) {
     }
     
     if (m_isSyncing) return;
+
+    // 只上传内容与服务器上次确认时不同的段
+    QJsonObject hashes = sectionHashes(configs);
+    QJsonObject acknowledged = acknowledgedHashes();
+    QJsonObject changed;
+    QJsonObject changedHashes;
+    for (auto it = configs.begin(); it != configs.end(); ++it) {
+        QString hash = hashes.value(it.key()).toString();
+        if (acknowledged.value(it.key()).toString() != hash) {
+            changed[it.key()] = it.value();
+            changedHashes[it.key()] = hash;
+        }
+    }
+
+    if (changed.isEmpty()) {
+        qDebug() << "Config unchanged, upload skipped:" << configs.keys();
+        emit configSaved();
+        return;
+    }
+
     m_isSyncing = true;
+    m_pendingHashes = changedHashes;
     
     QJsonObject data;
-    data["configs"] = configs;
+    data["configs"] = changed;
+    data["sectionHashes"] = changedHashes;
     
-    ApiClient::instance()->post("/api/config/save", data);
+    ApiRequest* request = ApiClient::instance()->post("/api/config/save", data);
+    connect(request, &ApiRequest::succeeded, this, &ConfigSync::onConfigSaved);
+    connect(request, &ApiRequest::failed, this, &ConfigSync::onRequestFailed);
 }
 
-void ConfigSync::onConfigLoaded(const QString& endpoint, const QJsonDocument& response) {
-    if (endpoint != "/api/config/get") return;
-    
+void ConfigSync::onConfigLoaded(const QJsonDocument& response) {
     m_isSyncing = false;
     
     QJsonObject obj = response.object();
     if (obj["success"].toBool()) {
         QJsonObject configs = obj["configs"].toObject();
+        // 服务器上的内容即为已确认的状态
+        acknowledgeHashes(sectionHashes(configs), true);
         emit configLoaded(configs);
         qDebug() << "Config loaded successfully";
     } else {
@@ -684,29 +960,30 @@ void ConfigSync::onConfigLoaded(const QString& endpoint, const QJsonDocument& re
     }
 }
 
-void ConfigSync::onConfigSaved(const QString& endpoint, const QJsonDocument& response) {
-    if (endpoint != "/api/config/save") return;
-    
+void ConfigSync::onConfigSaved(const QJsonDocument& response) {
     m_isSyncing = false;
     
     QJsonObject obj = response.object();
     if (obj["success"].toBool()) {
+        // 服务器判定未修改（notModified）的段同样以当前哈希为准
+        acknowledgeHashes(m_pendingHashes, false);
+        m_pendingHashes = QJsonObject();
         emit configSaved();
         qDebug() << "Config saved successfully";
     } else {
+        m_pendingHashes = QJsonObject();
         QString error = obj["error"].toString();
         emit syncFailed(error);
         qDebug() << "Config save failed:" << error;
     }
 }
 
-void ConfigSync::onRequestFailed(const QString& endpoint, int errorCode, const QString& error) {
-    if (endpoint == "/api/config/get" || endpoint == "/api/config/save" ||
-        endpoint == "/api/config/frpc/get" || endpoint == "/api/config/frpc/save") {
-        m_isSyncing = false;
-        emit syncFailed(error);
-        qDebug() << "Config sync failed:" << error;
-    }
+void ConfigSync::onRequestFailed(int errorCode, const QString& error) {
+    Q_UNUSED(errorCode);
+    m_isSyncing = false;
+    m_pendingHashes = QJsonObject();
+    emit syncFailed(error);
+    qDebug() << "Config sync failed:" << error;
 }
 
 void ConfigSync::saveFRPCConfig(const QJsonObject& frpcConfig) {
@@ -715,10 +992,24 @@ void ConfigSync::saveFRPCConfig(const QJsonObject& frpcConfig) {
         return;
     }
 
+    QString hash = sectionHash(frpcConfig);
+    if (acknowledgedHashes().value("frpc").toString() == hash) {
+        qDebug() << "FRPC config unchanged, upload skipped";
+        return;
+    }
+
     QJsonObject data;
     data["frpc"] = frpcConfig;
 
-    ApiClient::instance()->post("/api/config/frpc/save", data);
+    ApiRequest* request = ApiClient::instance()->post("/api/config/frpc/save", data);
+    connect(request, &ApiRequest::succeeded, this, [this, hash](const QJsonDocument& response) {
+        if (response.object()["success"].toBool()) {
+            QJsonObject hashes;
+            hashes["frpc"] = hash;
+            acknowledgeHashes(hashes, false);
+        }
+    });
+    connect(request, &ApiRequest::failed, this, &ConfigSync::onFRPCRequestFailed);
 }
 
 void ConfigSync::loadFRPCConfig() {
@@ -727,17 +1018,25 @@ void ConfigSync::loadFRPCConfig() {
         return;
     }
 
-    ApiClient::instance()->get("/api/config/frpc/get");
+    ApiRequest* request = ApiClient::instance()->get("/api/config/frpc/get");
+    connect(request, &ApiRequest::succeeded, this, &ConfigSync::onFRPCConfigLoaded);
+    connect(request, &ApiRequest::failed, this, &ConfigSync::onFRPCRequestFailed);
 }
 
-void ConfigSync::onFRPCConfigLoaded(const QString& endpoint, const QJsonDocument& response) {
-    if (endpoint != "/api/config/frpc/get") return;
-
-    m_isSyncing = false;
+// FRPC 配置的请求不占用 m_isSyncing，不能清除同时进行的 saveAllConfig 等待确认的状态
+void ConfigSync::onFRPCRequestFailed(int errorCode, const QString& error) {
+    Q_UNUSED(errorCode);
+    emit syncFailed(error);
+    qDebug() << "FRPC config sync failed:" << error;
+}
 
+void ConfigSync::onFRPCConfigLoaded(const QJsonDocument& response) {
     QJsonObject obj = response.object();
     if (obj["success"].toBool()) {
         QJsonObject frpcConfig = obj["frpc"].toObject();
+        QJsonObject hashes;
+        hashes["frpc"] = sectionHash(frpcConfig);
+        acknowledgeHashes(hashes, false);
         emit frpcConfigLoaded(frpcConfig);
         qDebug() << "FRPC config loaded successfully";
     } else {
@@ -747,6 +1046,61 @@ void ConfigSync::onFRPCConfigLoaded(const QString& endpoint, const QJsonDocument
     }
 }
 
+// 紧凑 JSON 中对象的键已按字典序排列，同样的内容总得到同样的文本。
+// QJsonDocument 只能序列化对象或数组，包一层数组后去掉首尾的方括号
+QString ConfigSync::sectionHash(const QJsonValue& value) {
+    QByteArray wrapped = QJsonDocument(QJsonArray{ value }).toJson(QJsonDocument::Compact);
+    QByteArray canonical = wrapped.mid(1, wrapped.size() - 2);
+    return QCryptographicHash::hash(canonical, QCryptographicHash::Sha256).toHex();
+}
+
+QJsonObject ConfigSync::sectionHashes(const QJsonObject& configs) {
+    QJsonObject hashes;
+    for (auto it = configs.begin(); it != configs.end(); ++it) {
+        hashes[it.key()] = sectionHash(it.value());
+    }
+    return hashes;
+}
+
+// 确认记录按用户区分，切换账号后从头上传
+static QString configHashSettingsKey(const QString& name) {
+    return QString("configSync/%1/%2").arg(UserManager::instance()->currentUser().id).arg(name);
+}
+
+QJsonObject ConfigSync::acknowledgedHashes() const {
+    QSettings settings;
+    return QJsonObject::fromVariantMap(settings.value(configHashSettingsKey("sections")).toMap());
+}
+
+void ConfigSync::acknowledgeHashes(const QJsonObject& hashes, bool replace) {
+    QSettings settings;
+    QString key = configHashSettingsKey("sections");
+    QVariantMap stored = replace ? QVariantMap() : settings.value(key).toMap();
+    for (auto it = hashes.begin(); it != hashes.end(); ++it) {
+        stored[it.key()] = it.value().toString();
+    }
+    settings.setValue(key, stored);
+}
+
+QJsonObject ConfigSync::acknowledgedProfileHashes(const QString& configName) const {
+    QSettings settings;
+    QVariantMap profiles = settings.value(configHashSettingsKey("profiles")).toMap();
+    return QJsonObject::fromVariantMap(profiles.value(configName).toMap());
+}
+
+// hashes 为空时清除该备份的记录，下次上传完整内容
+void ConfigSync::acknowledgeProfileHashes(const QString& configName, const QJsonObject& hashes) {
+    QSettings settings;
+    QString key = configHashSettingsKey("profiles");
+    QVariantMap profiles = settings.value(key).toMap();
+    if (hashes.isEmpty()) {
+        profiles.remove(configName);
+    } else {
+        profiles[configName] = hashes.toVariantMap();
+    }
+    settings.setValue(key, profiles);
+}
+
 // TaskSync implementation
 TaskSync* TaskSync::instance() {
     static TaskSync sync;
@@ -754,10 +1108,6 @@ TaskSync* TaskSync::instance() {
 }
 
 TaskSync::TaskSync() : QObject(), m_isSyncing(false) {
-    ApiClient* client = ApiClient::instance();
-    connect(client, &ApiClient::requestSuccess, this, &TaskSync::onTasksLoaded);
-    connect(client, &ApiClient::requestSuccess, this, &TaskSync::onTasksSaved);
-    connect(client, &ApiClient::requestFailed, this, &TaskSync::onRequestFailed);
 }
 
 void TaskSync::syncTasks() {
@@ -769,7 +1119,9 @@ void TaskSync::syncTasks() {
     if (m_isSyncing) return;
     m_isSyncing = true;
 
-    ApiClient::instance()->get("/api/config/tasks/get");
+    ApiRequest* request = ApiClient::instance()->get("/api/config/tasks/get");
+    connect(request, &ApiRequest::succeeded, this, &TaskSync::onTasksLoaded);
+    connect(request, &ApiRequest::failed, this, &TaskSync::onRequestFailed);
 }
 
 void TaskSync::uploadTasks(const QJsonArray& tasks) {
@@ -784,23 +1136,28 @@ void TaskSync::uploadTasks(const QJsonArray& tasks) {
     QJsonObject data;
     data["tasks"] = tasks;
 
-    ApiClient::instance()->post("/api/config/tasks/sync", data);
+    ApiRequest* request = ApiClient::instance()->post("/api/config/tasks/sync", data);
+    connect(request, &ApiRequest::succeeded, this, &TaskSync::onTasksSaved);
+    connect(request, &ApiRequest::failed, this, &TaskSync::onRequestFailed);
 }
 
-void TaskSync::uploadTasksWithDeleted(const QJsonArray& tasks, const QStringList& deletedTaskIds) {
+bool TaskSync::uploadTasksWithDeleted(const QJsonArray& tasks, const QStringList& deletedTaskIds) {
     if (!UserManager::instance()->isLoggedIn()) {
         emit syncFailed("Not logged in");
-        return;
+        return false;
     }
 
-    if (m_isSyncing) return;
+    if (m_isSyncing) return false;
     m_isSyncing = true;
 
     QJsonObject data;
     data["tasks"] = tasks;
     data["deletedTaskIds"] = QJsonArray::fromStringList(deletedTaskIds);
 
-    ApiClient::instance()->post("/api/config/tasks/sync", data);
+    ApiRequest* request = ApiClient::instance()->post("/api/config/tasks/sync", data);
+    connect(request, &ApiRequest::succeeded, this, &TaskSync::onTasksSaved);
+    connect(request, &ApiRequest::failed, this, &TaskSync::onRequestFailed);
+    return true;
 }
 
 void TaskSync::downloadTasks() {
@@ -812,7 +1169,9 @@ void TaskSync::downloadTasks() {
     if (m_isSyncing) return;
     m_isSyncing = true;
 
-    ApiClient::instance()->get("/api/config/tasks/get");
+    ApiRequest* request = ApiClient::instance()->get("/api/config/tasks/get");
+    connect(request, &ApiRequest::succeeded, this, &TaskSync::onTasksLoaded);
+    connect(request, &ApiRequest::failed, this, &TaskSync::onRequestFailed);
 }
 
 // 增量上传任务
@@ -830,11 +1189,13 @@ void TaskSync::uploadIncrementalTasks(const QJsonArray& tasks, const QString& la
     data["lastSyncTime"] = lastSyncTime;
     data["incremental"] = true;
 
-    ApiClient::instance()->post("/api/config/tasks/incremental", data);
+    ApiRequest* request = ApiClient::instance()->post("/api/config/tasks/incremental", data);
+    connect(request, &ApiRequest::succeeded, this, &TaskSync::onTasksLoaded);
+    connect(request, &ApiRequest::failed, this, &TaskSync::onRequestFailed);
 }
 
 // 增量下载任务
-void TaskSync::downloadIncrementalTasks(const QString& lastSyncTime) {
+void TaskSync::downloadIncrementalTasks(qint64 sinceSeq) {
     if (!UserManager::instance()->isLoggedIn()) {
         emit syncFailed("Not logged in");
         return;
@@ -843,22 +1204,23 @@ void TaskSync::downloadIncrementalTasks(const QString& lastSyncTime) {
     if (m_isSyncing) return;
     m_isSyncing = true;
 
+    // 查询参数按字符串取值
     QJsonObject params;
-    params["lastSyncTime"] = lastSyncTime;
-    params["incremental"] = true;
+    params["sinceSeq"] = QString::number(sinceSeq);
 
-    ApiClient::instance()->get("/api/config/tasks/incremental", params);
+    ApiRequest* request = ApiClient::instance()->get("/api/config/tasks/incremental", params);
+    connect(request, &ApiRequest::succeeded, this, &TaskSync::onTasksLoaded);
+    connect(request, &ApiRequest::failed, this, &TaskSync::onRequestFailed);
 }
 
-void TaskSync::onTasksLoaded(const QString& endpoint, const QJsonDocument& response) {
-    if (endpoint != "/api/config/tasks/get") return;
-
+void TaskSync::onTasksLoaded(const QJsonDocument& response) {
     m_isSyncing = false;
 
     QJsonObject obj = response.object();
     if (obj["success"].toBool()) {
         QJsonArray tasks = obj["tasks"].toArray();
-        emit tasksSynced(tasks);
+        qint64 cursor = obj.contains("cursor") ? obj["cursor"].toVariant().toLongLong() : -1;
+        emit tasksSynced(tasks, cursor);
         qDebug() << "Tasks loaded successfully, count:" << tasks.size();
     } else {
         QString error = obj["error"].toString();
@@ -867,9 +1229,7 @@ void TaskSync::onTasksLoaded(const QString& endpoint, const QJsonDocument& respo
     }
 }
 
-void TaskSync::onTasksSaved(const QString& endpoint, const QJsonDocument& response) {
-    if (endpoint != "/api/config/tasks/sync") return;
-
+void TaskSync::onTasksSaved(const QJsonDocument& response) {
     m_isSyncing = false;
 
     QJsonObject obj = response.object();
@@ -883,10 +1243,9 @@ void TaskSync::onTasksSaved(const QString& endpoint, const QJsonDocument& respon
     }
 }
 
-void TaskSync::onRequestFailed(const QString& endpoint, int errorCode, const QString& error) {
-    if (endpoint == "/api/config/tasks/get" || endpoint == "/api/config/tasks/sync") {
-        m_isSyncing = false;
-        emit syncFailed(error);
-        qDebug() << "Tasks sync failed:" << error;
-    }
+void TaskSync::onRequestFailed(int errorCode, const QString& error) {
+    Q_UNUSED(errorCode);
+    m_isSyncing = false;
+    emit syncFailed(error);
+    qDebug() << "Tasks sync failed:" << error;
 }
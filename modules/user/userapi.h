@@ -9,6 +9,10 @@
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QUrl>
+#include <QQueue>
+#include <QSet>
+#include <QTimer>
+#include <QVariant>
 #include <QDebug>
 
 #define CLOUD_API_URL "http://8.163.37.74:8080"
@@ -24,6 +28,54 @@ struct UserInfo {
     UserInfo() : id(0), vipLevel(0) {}
 };
 
+class ApiClient;
+
+// 一次 API 请求。由 ApiClient::get/post 创建并排队，完成（成功、失败、超时或取消）后自动释放，
+// 调用方只需在返回后立即连接信号
+class ApiRequest : public QObject {
+    Q_OBJECT
+public:
+    quint64 id() const { return m_id; }
+    QString endpoint() const { return m_endpoint; }
+    QString method() const { return m_method; }
+    bool isFinished() const { return m_finished; }
+    bool isCanceled() const { return m_canceled; }
+    // 服务器返回的 HTTP 状态码，没有收到响应时为 0
+    int statusCode() const { return m_statusCode; }
+
+    // 超时（毫秒），0 表示不限时；请求已发出时从现在起重新计时
+    void setTimeout(int ms);
+    int timeout() const { return m_timeoutMs; }
+    void cancel();
+
+signals:
+    void succeeded(const QJsonDocument& response);
+    void failed(int errorCode, const QString& error);
+
+private:
+    friend class ApiClient;
+    ApiRequest(quint64 id, const QString& method, const QString& endpoint, ApiClient* client);
+
+    ApiClient* m_client;
+    quint64 m_id;
+    QString m_method;
+    QString m_endpoint;
+    QNetworkRequest m_request;
+    QIODevice* m_body;
+    QByteArray m_contentEncoding;
+    QString m_logBody;
+    QVariant m_retryData;        // 压缩请求被拒绝时用于重建未压缩的请求体
+    QNetworkReply* m_reply;
+    QTimer* m_timer;
+    int m_timeoutMs;
+    int m_statusCode;
+    bool m_finished;
+    bool m_canceled;
+    bool m_timedOut;
+};
+
+// 所有模块共用的 API 客户端：共享一个 QNetworkAccessManager 以复用连接（keep-alive、HTTP/2），
+// 同时进行的请求数有上限，超出的请求排队等待
 class ApiClient : public QObject {
     Q_OBJECT
 public:
@@ -35,24 +87,54 @@ public:
     QString getAuthToken() const { return m_authToken; }
     bool isLoggedIn() const { return !m_authToken.isEmpty(); }
     
-    void get(const QString& endpoint, const QJsonObject& params = {});
-    void post(const QString& endpoint, const QJsonObject& data = {});
-    void post(const QString& endpoint, const QString& jsonStr);
+    ApiRequest* get(const QString& endpoint, const QJsonObject& params = {});
+    ApiRequest* post(const QString& endpoint, const QJsonObject& data = {});
+    ApiRequest* post(const QString& endpoint, const QString& jsonStr);
+    ApiRequest* deleteResource(const QString& endpoint);
+
+    // 较大的请求体以 gzip 压缩上传；服务器返回 415 时自动关闭并以未压缩方式重发
+    void setRequestCompressionEnabled(bool enabled) { m_compressRequests = enabled; }
+    bool isRequestCompressionEnabled() const { return m_compressRequests; }
+
+    // 其他模块访问云端接口时也应使用这个共享的 QNetworkAccessManager
+    QNetworkAccessManager* networkManager() const { return m_manager; }
+
+    void setDefaultTimeout(int ms) { m_defaultTimeoutMs = ms; }
+    int defaultTimeout() const { return m_defaultTimeoutMs; }
+    void setMaxInFlight(int count);
+    int inFlightCount() const { return m_inFlight.size(); }
+    int queuedCount() const { return m_queue.size(); }
     
 signals:
+    // 所有请求的结果，按 endpoint 区分；需要区分同一 endpoint 的并发请求时使用 ApiRequest 的信号
     void requestSuccess(const QString& endpoint, const QJsonDocument& response);
     void requestFailed(const QString& endpoint, int errorCode, const QString& error);
     
-private slots:
-    void onReplyFinished();
-    
 private:
+    friend class ApiRequest;
+
     ApiClient();
     ~ApiClient();
+
+    QNetworkRequest createRequest(const QUrl& url) const;
+    void setPostBody(ApiRequest* request, const QVariant& data);
+    ApiRequest* enqueue(ApiRequest* request);
+    void startQueuedRequests();
+    void startRequest(ApiRequest* request);
+    void cancelRequest(ApiRequest* request);
+    void onReplyFinished(ApiRequest* request);
+    void finishRequest(ApiRequest* request, bool success, const QJsonDocument& response,
+                       int errorCode, const QString& error);
     
     QNetworkAccessManager* m_manager;
     QString m_baseUrl;
     QString m_authToken;
+    bool m_compressRequests;
+    quint64 m_nextRequestId;
+    int m_defaultTimeoutMs;
+    int m_maxInFlight;
+    QQueue<ApiRequest*> m_queue;
+    QSet<ApiRequest*> m_inFlight;
 };
 
 class UserManager : public QObject {
@@ -111,6 +193,7 @@ private slots:
     
 private:
     UserManager();
+    void sendRequest(ApiRequest* request);
     
     QString m_token;
     QString m_pendingRequest;
@@ -133,6 +216,16 @@ public:
     void saveFRPCConfig(const QJsonObject& frpcConfig);
     void loadFRPCConfig();
 
+    // 配置按顶层 key 分段（apps、collections、remoteDesktops、frpc 等），每段计算内容哈希；
+    // 只上传哈希与上次服务器确认的不同的段，请求中附带 sectionHashes 供服务器判断未修改的段
+    static QString sectionHash(const QJsonValue& value);
+    static QJsonObject sectionHashes(const QJsonObject& configs);
+    QJsonObject acknowledgedHashes() const;
+
+    // 命名备份（/api/config/upload）按备份名称分别记录确认过的哈希
+    QJsonObject acknowledgedProfileHashes(const QString& configName) const;
+    void acknowledgeProfileHashes(const QString& configName, const QJsonObject& hashes);
+
 signals:
     void configLoaded(const QJsonObject& configs);
     void configSaved();
@@ -140,14 +233,18 @@ signals:
     void frpcConfigLoaded(const QJsonObject& frpcConfig);
 
 private slots:
-    void onConfigLoaded(const QString& endpoint, const QJsonDocument& response);
-    void onConfigSaved(const QString& endpoint, const QJsonDocument& response);
-    void onFRPCConfigLoaded(const QString& endpoint, const QJsonDocument& response);
-    void onRequestFailed(const QString& endpoint, int errorCode, const QString& error);
+    void onConfigLoaded(const QJsonDocument& response);
+    void onConfigSaved(const QJsonDocument& response);
+    void onFRPCConfigLoaded(const QJsonDocument& response);
+    void onRequestFailed(int errorCode, const QString& error);
+    void onFRPCRequestFailed(int errorCode, const QString& error);
 
 private:
     ConfigSync();
+    void acknowledgeHashes(const QJsonObject& hashes, bool replace);
+
     bool m_isSyncing;
+    QJsonObject m_pendingHashes;    // 已发出、等待服务器确认的段哈希
 };
 
 class TaskSync : public QObject {
@@ -157,23 +254,25 @@ public:
 
     void syncTasks();
     void uploadTasks(const QJsonArray& tasks);
-    void uploadTasksWithDeleted(const QJsonArray& tasks, const QStringList& deletedTaskIds);
+    bool uploadTasksWithDeleted(const QJsonArray& tasks, const QStringList& deletedTaskIds);  // 返回是否已发起上传
     void downloadTasks();
 
     // 增量同步
     void uploadIncrementalTasks(const QJsonArray& tasks, const QString& lastSyncTime);
-    void downloadIncrementalTasks(const QString& lastSyncTime);
+    // 下载服务器修改序号大于 sinceSeq 的任务；sinceSeq 为上次下载收到的 cursor，从未下载过时为 0
+    void downloadIncrementalTasks(qint64 sinceSeq);
 
 signals:
-    void tasksSynced(const QJsonArray& tasks);
+    // cursor 为服务器本次返回的最大修改序号，合并成功后作为下次增量下载的起点；服务器未返回时为 -1
+    void tasksSynced(const QJsonArray& tasks, qint64 cursor);
     void tasksUploadComplete();
     void tasksDownloadComplete(const QJsonArray& tasks);
     void syncFailed(const QString& error);
 
 private slots:
-    void onTasksLoaded(const QString& endpoint, const QJsonDocument& response);
-    void onTasksSaved(const QString& endpoint, const QJsonDocument& response);
-    void onRequestFailed(const QString& endpoint, int errorCode, const QString& error);
+    void onTasksLoaded(const QJsonDocument& response);
+    void onTasksSaved(const QJsonDocument& response);
+    void onRequestFailed(int errorCode, const QString& error);
 
 private:
     TaskSync();
@@ -4,14 +4,23 @@
 #include "changepassworddialog.h"
 #include "../core/database.h"
 #include "../core/networkmonitor.h"
+#include "../widgets/syncconflictdialog.h"
 #include <QApplication>
 #include <QStyle>
 #include <QIcon>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QJsonDocument>
+#include <QSettings>
 #include <QSet>
-#include <QMap>
+#include <QHash>
 #include <QTimer>
+#include <QRandomGenerator>
+
+// 同步失败后的重试等待：从 2 秒起每次翻倍，最长 5 分钟，并加入随机抖动，
+// 避免多台设备在服务恢复时同时重试
+#define SYNC_RETRY_BASE_MS 2000
+#define SYNC_RETRY_MAX_MS (5 * 60 * 1000)
 
 UserMenuWidget::UserMenuWidget(QWidget *parent)
     : QObject(parent)
@@ -23,9 +32,11 @@ UserMenuWidget::UserMenuWidget(QWidget *parent)
     , m_registerAction(nullptr)
     , m_syncTimer(nullptr)
     , m_pendingSync(false)
-    , m_lastSyncTime(QDateTime::fromSecsSinceEpoch(0))
-    , m_deletedTaskIds()
-    , m_previousTaskIds()
+    , m_uploadingVersion(-1)
+    , m_retryTimer(nullptr)
+    , m_retryAttempt(0)
+    , m_retryDownload(false)
+    , m_resolvingConflicts(false)
     , m_networkMonitor(nullptr)
 {
     // 创建用户菜单按钮
@@ -81,6 +92,10 @@ void UserMenuWidget::setDatabase(Database *db)
         m_syncTimer->setInterval(2000); // 2秒防抖
         connect(m_syncTimer, &QTimer::timeout, this, &UserMenuWidget::onSyncTimerTimeout);
 
+        m_retryTimer = new QTimer(this);
+        m_retryTimer->setSingleShot(true);
+        connect(m_retryTimer, &QTimer::timeout, this, &UserMenuWidget::retrySync);
+
         // 连接任务变化信号，实现自动同步（带防抖）
         connect(m_db, &Database::tasksChanged, this, &UserMenuWidget::onTasksChanged);
 
@@ -155,6 +170,13 @@ void UserMenuWidget::onLoginSuccess()
 
 void UserMenuWidget::onLogoutComplete()
 {
+    if (m_retryTimer) {
+        m_retryTimer->stop();
+    }
+    m_retryAttempt = 0;
+    m_retryDownload = false;
+    emit syncQueueDepthChanged(0);
+
     m_userMenu->clear();
 
     // 重新创建登录和注册action
@@ -196,155 +218,525 @@ void UserMenuWidget::updateMenuState()
     }
 }
 
+static QJsonObject taskToSyncJson(const Task &task)
+{
+    QJsonObject taskObj;
+    taskObj["id"] = task.id;
+    taskObj["title"] = task.title;
+    taskObj["description"] = task.description;
+    taskObj["categoryId"] = task.categoryId;
+    taskObj["priority"] = task.priority;
+    taskObj["status"] = task.status;
+    taskObj["workDuration"] = task.workDuration;
+    taskObj["completionTime"] = task.completionTime.toUTC().toString(Qt::ISODate);
+    taskObj["tags"] = QJsonArray::fromStringList(task.tags);
+    taskObj["updatedAt"] = task.updatedAt.toUTC().toString(Qt::ISODate);
+    return taskObj;
+}
+
 void UserMenuWidget::syncTasksToCloud()
 {
-    // 设置同步时间，登录时完整上传所有任务
-    m_lastSyncTime = QDateTime::fromSecsSinceEpoch(0);
+    if (!m_db) return;
 
-    // 先获取本地工作日志并上传，然后拉取云端工作日志
-    if (m_db) {
-        QList<Task> localTasks = m_db->getAllTasks();
+    updateSyncQueueDepth();
 
-        // 初始化上次任务ID列表
-        m_previousTaskIds.clear();
-        for (const Task &task : localTasks) {
-            m_previousTaskIds.append(task.id);
+    // 先上传本地变更，上传完成后再从上次合并成功的位置下载云端工作日志；从未同步过时完整上传一次
+    SyncState state = m_db->getTaskSyncState();
+    if (!uploadPendingTasks(!state.lastSyncTime.isValid()) && m_uploadingVersion < 0) {
+        // 没有需要上传的内容，直接下载
+        TaskSync::instance()->downloadIncrementalTasks(m_db->getTaskDownloadCursor());
+    }
+}
+
+// 上传版本号大于上次同步版本的任务和删除记录，返回是否发起了上传
+bool UserMenuWidget::uploadPendingTasks(bool fullUpload)
+{
+    // 上一次上传尚未完成，完成后再发送这期间的修改
+    if (m_uploadingVersion >= 0) {
+        m_pendingSync = true;
+        return false;
+    }
+
+    qint64 lastSyncVersion = m_db->getTaskSyncState().lastSyncVersion;
+    qint64 version = m_db->currentTaskVersion();
+
+    QList<Task> changedTasks = fullUpload ? m_db->getAllTasks() : m_db->getTasksChangedSince(lastSyncVersion);
+    QStringList deletedIds = m_db->getDeletedTaskIdsSince(fullUpload ? 0 : lastSyncVersion);
+
+    if (changedTasks.isEmpty() && deletedIds.isEmpty()) {
+        qDebug() << "No changed tasks to upload";
+        return false;
+    }
+
+    QJsonArray tasksArray;
+    for (const Task &task : changedTasks) {
+        tasksArray.append(taskToSyncJson(task));
+    }
+
+    qDebug() << "Uploading" << tasksArray.size() << "changed tasks and" << deletedIds.size()
+             << "deletions, version" << lastSyncVersion << "->" << version;
+
+    if (m_networkMonitor) {
+        m_networkMonitor->setSyncing(true);
+    }
+
+    // 上传成功后才把同步版本推进到 version，失败时这些修改下次会再次上传
+    m_uploadingVersion = version;
+    m_uploadingTasks = tasksArray;
+    if (!TaskSync::instance()->uploadTasksWithDeleted(tasksArray, deletedIds)) {
+        // 下载尚未结束或未登录，等下载完成后再上传
+        m_uploadingVersion = -1;
+        m_uploadingTasks = QJsonArray();
+        m_pendingSync = true;
+        if (m_networkMonitor) {
+            m_networkMonitor->setSyncing(false);
         }
+        return false;
+    }
+    return true;
+}
+
+static Task taskFromSyncJson(const QJsonObject &taskObj)
+{
+    Task task;
+    task.id = taskObj["id"].toString();
+    task.title = taskObj["title"].toString();
+    task.description = taskObj["description"].toString();
+    task.categoryId = taskObj["categoryId"].toInt();
+    task.priority = static_cast<TaskPriority>(taskObj["priority"].toInt());
+    task.status = static_cast<TaskStatus>(taskObj["status"].toInt());
+    task.workDuration = taskObj["workDuration"].toDouble();
+    task.completionTime = QDateTime::fromString(taskObj["completionTime"].toString(), Qt::ISODate).toLocalTime();
+
+    // 云端任务的更新时间为 UTC 时间
+    task.updatedAt = QDateTime::fromString(taskObj["updatedAt"].toString(), Qt::ISODate).toLocalTime();
+
+    const QJsonArray tagsArray = taskObj["tags"].toArray();
+    for (const QJsonValue &tagVal : tagsArray) {
+        task.tags.append(tagVal.toString());
+    }
+    return task;
+}
+
+// 判断重复任务用的内容指纹：标题、分类、状态、工时（精确到 0.01 小时）
+static QString taskFingerprint(const Task &task)
+{
+    // 多参数 arg 一次替换，标题中的 %N 不会被再次替换
+    return QString("%1\x1f%2\x1f%3\x1f%4").arg(task.title,
+                                               QString::number(task.categoryId),
+                                               QString::number(static_cast<int>(task.status)),
+                                               QString::number(qRound64(task.workDuration * 100)));
+}
+
+static bool sameTaskContent(const Task &a, const Task &b)
+{
+    return a.title == b.title && a.description == b.description
+        && a.categoryId == b.categoryId && a.priority == b.priority
+        && a.status == b.status && qAbs(a.workDuration - b.workDuration) < 0.01
+        && a.completionTime == b.completionTime && a.tags == b.tags;
+}
+
+// 参与三方合并的字段；updatedAt 不参与比较，合并后由保存时间决定
+static const QStringList TASK_MERGE_FIELDS = {
+    "title", "description", "categoryId", "priority", "status",
+    "workDuration", "completionTime", "tags"
+};
 
-        QJsonArray tasksArray;
-        for (const Task &task : localTasks) {
-            QJsonObject taskObj;
-            taskObj["id"] = task.id;
-            taskObj["title"] = task.title;
-            taskObj["description"] = task.description;
-            taskObj["categoryId"] = task.categoryId;
-            taskObj["priority"] = task.priority;
-            taskObj["status"] = task.status;
-            taskObj["workDuration"] = task.workDuration;
-            taskObj["completionTime"] = task.completionTime.toUTC().toString(Qt::ISODate);
-            taskObj["tags"] = QJsonArray::fromStringList(task.tags);
-            taskObj["updatedAt"] = task.updatedAt.toUTC().toString(Qt::ISODate);
-            tasksArray.append(taskObj);
+static bool sameSyncField(const QString &field, const QJsonValue &a, const QJsonValue &b)
+{
+    // 工时与 sameTaskContent 一致，精确到 0.01 小时
+    if (field == QLatin1String("workDuration")) {
+        return qRound64(a.toDouble() * 100) == qRound64(b.toDouble() * 100);
+    }
+    return a == b;
+}
+
+// 以 base 为共同祖先逐字段合并：只有一方改过的字段取改动的一方，
+// 双方改成不同值的字段记入 conflictFields，合并结果中暂取本地的值
+static QJsonObject mergeSyncTask(const QJsonObject &base, const QJsonObject &local,
+                                 const QJsonObject &cloud, QStringList *conflictFields)
+{
+    QJsonObject merged = cloud;
+    for (const QString &field : TASK_MERGE_FIELDS) {
+        const QJsonValue localValue = local.value(field);
+        const QJsonValue cloudValue = cloud.value(field);
+        if (sameSyncField(field, localValue, cloudValue)) {
+            continue;
+        }
+        const QJsonValue baseValue = base.value(field);
+        if (sameSyncField(field, localValue, baseValue)) {
+            continue;   // 只有云端改过
+        }
+        merged[field] = localValue;
+        if (!sameSyncField(field, cloudValue, baseValue)) {
+            conflictFields->append(field);
         }
-        // 登录时完整上传，清空删除列表
-        TaskSync::instance()->uploadTasksWithDeleted(tasksArray, QStringList());
     }
+    return merged;
+}
+
+static void addConflictLog(Database *db, const QString &taskId, const QJsonObject &before,
+                           const QJsonObject &after, const QString &resolution)
+{
+    SyncLog log;
+    log.id = 0;
+    log.entityType = "task";
+    log.entityId = taskId;
+    log.action = "conflict_resolved";
+    log.beforeData = QString::fromUtf8(QJsonDocument(before).toJson(QJsonDocument::Compact));
+    log.afterData = QString::fromUtf8(QJsonDocument(after).toJson(QJsonDocument::Compact));
+    log.resolution = resolution;
+    log.timestamp = QDateTime::currentDateTime();
+    db->addSyncLog(log);
 }
 
-void UserMenuWidget::onTasksSynced(const QJsonArray& tasks)
+void UserMenuWidget::onTasksSynced(const QJsonArray& tasks, qint64 cursor)
 {
     // 收到云端工作日志，合并到本地数据库
     if (!m_db) return;
 
-    // 获取本地已有的任务
-    QList<Task> localTasks = m_db->getAllTasks();
-    QMap<QString, Task> localTaskMap;
-    for (const Task &task : localTasks) {
-        localTaskMap[task.id] = task;
+    // 下载成功，之前失败的下载不再重试
+    if (m_retryDownload) {
+        m_retryDownload = false;
+        m_retryAttempt = 0;
+    }
+
+    if (tasks.isEmpty()) {
+        // 没有新的修改，不必加载本地任务
+        if (cursor >= 0) {
+            m_db->setTaskDownloadCursor(cursor);
+        }
+        if (m_pendingSync && m_syncTimer && !m_syncTimer->isActive()) {
+            m_syncTimer->start();
+        }
+        return;
     }
 
-    // 处理云端任务：添加新任务或更新已有任务
+    // 本地任务按ID逐个查找，只加载收到的任务所在的分段。
+    // 重复内容的判断限于同一创建月份，每个月份的内容指纹只在第一次用到时建立；
+    // ID 中没有日期的旧任务无法定位分段，才与全部本地任务比较
+    QHash<QString, QSet<QString>> fingerprintsByMonth;
+    auto hasSameContent = [this, &fingerprintsByMonth](const Task &task) {
+        QDate created = Database::taskCreationDate(task.id);
+        QString month = created.isValid() ? created.toString("yyyy-MM") : QString();
+        auto found = fingerprintsByMonth.constFind(month);
+        if (found == fingerprintsByMonth.constEnd()) {
+            QDate monthStart = created.isValid() ? QDate(created.year(), created.month(), 1) : QDate();
+            const QList<Task> candidates = created.isValid()
+                ? m_db->getTasksByDateRange(QDateTime(monthStart), QDateTime(monthStart.addMonths(1).addDays(-1)))
+                : m_db->getAllTasks();
+            QSet<QString> fingerprints;
+            fingerprints.reserve(candidates.size());
+            for (const Task &candidate : candidates) {
+                fingerprints.insert(taskFingerprint(candidate));
+            }
+            found = fingerprintsByMonth.insert(month, fingerprints);
+        }
+        return found.value().contains(taskFingerprint(task));
+    };
+
+    // 本地尚未上传的修改与云端的修改同时存在时，按同步基准逐字段合并；
+    // 没有基准的旧数据仍按更新时间整条取较新的一方
+    qint64 lastSyncVersion = m_db->getTaskSyncState().lastSyncVersion;
+    SyncConflictStrategy strategy = static_cast<SyncConflictStrategy>(
+        QSettings().value("sync/conflictStrategy", static_cast<int>(SyncConflictStrategy_Local)).toInt());
+
+    int added = 0;
+    int updated = 0;
+    int skipped = 0;
+    int conflicts = 0;
+
+    // 整批合并只写一次任务文件、刷新一次界面
+    DatabaseTransaction transaction(m_db);
+
     for (const QJsonValue &taskVal : tasks) {
-        QJsonObject taskObj = taskVal.toObject();
-        QString taskId = taskObj["id"].toString();
-
-        Task task;
-        task.id = taskId;
-        task.title = taskObj["title"].toString();
-        task.description = taskObj["description"].toString();
-        task.categoryId = taskObj["categoryId"].toInt();
-        task.priority = static_cast<TaskPriority>(taskObj["priority"].toInt());
-        task.status = static_cast<TaskStatus>(taskObj["status"].toInt());
-        task.workDuration = taskObj["workDuration"].toDouble();
-        task.completionTime = QDateTime::fromString(taskObj["completionTime"].toString(), Qt::ISODate).toLocalTime();
-
-        // 读取云端任务的更新时间（UTC时间）
-        QString updatedAtStr = taskObj["updatedAt"].toString();
-        task.updatedAt = QDateTime::fromString(updatedAtStr, Qt::ISODate).toLocalTime();
-        
+        const QJsonObject cloudObj = taskVal.toObject();
+        Task task = taskFromSyncJson(cloudObj);
+
+        // 本地已删除但删除尚未上传的任务不再加回来
+        if (m_db->hasTaskTombstone(task.id)) {
+            skipped++;
+            continue;
+        }
+
         // 如果没有有效的更新时间，说明是旧数据，跳过该任务
         if (!task.updatedAt.isValid()) {
-            qDebug() << "Skipping task with invalid updatedAt:" << taskId;
+            qDebug() << "Skipping task with invalid updatedAt:" << task.id;
+            skipped++;
+            continue;
+        }
+
+        const Task localTask = m_db->getTaskById(task.id);
+        if (localTask.id.isEmpty()) {
+            // 本地不存在：内容完全相同的任务视为重复，避免重复添加
+            if (hasSameContent(task)) {
+                skipped++;
+            } else {
+                m_db->addTaskWithId(task);
+                m_db->setTaskSyncBase(task.id, cloudObj);
+                added++;
+            }
             continue;
         }
 
-        QJsonArray tagsArray = taskObj["tags"].toArray();
-        for (const QJsonValue &tagVal : tagsArray) {
-            task.tags.append(tagVal.toString());
+        const QJsonObject base = m_db->getTaskSyncBase(task.id);
+        // 云端当前的内容即为下一次合并的基准
+        m_db->setTaskSyncBase(task.id, cloudObj);
+        if (sameTaskContent(task, localTask)) {
+            skipped++;
+            continue;
         }
 
-        // 如果本地不存在，检查是否完全相同（避免重复添加）
-        if (!localTaskMap.contains(taskId)) {
-            // 检查是否有完全相同的任务（通过标题、分类、状态、工时判断）
-            bool isDuplicate = false;
-            for (const Task &localTask : localTasks) {
-                if (localTask.title == task.title &&
-                    localTask.categoryId == task.categoryId &&
-                    localTask.status == task.status &&
-                    qAbs(localTask.workDuration - task.workDuration) < 0.01) {
-                    isDuplicate = true;
-                    break;
-                }
-            }
-            if (!isDuplicate) {
+        if (base.isEmpty()) {
+            // 比较更新时间，保留最新的数据；本地没有有效更新时间时保留本地数据
+            bool cloudNewer = localTask.updatedAt.isValid() && task.updatedAt > localTask.updatedAt;
+            if (cloudNewer) {
+                // 云端数据更新，覆盖本地（不分配新版本号，避免再上传回去）
                 m_db->addTaskWithId(task);
             }
-        } else {
-            // 如果本地存在，比较更新时间，保留最新的
-            Task localTask = localTaskMap[taskId];
-            // 比较更新时间，保留最新的数据
-            if (task.updatedAt.isValid() && localTask.updatedAt.isValid()) {
-                if (task.updatedAt > localTask.updatedAt) {
-                    // 云端数据更新，覆盖本地
-                    m_db->updateTask(task);
-                } else {
-                    // 本地数据更新，不做处理（下次上传会同步到云端）
+
+            if (localTask.version > lastSyncVersion) {
+                conflicts++;
+            } else if (cloudNewer) {
+                updated++;
+            } else {
+                // 本地数据更新，下次上传会同步到云端
+                skipped++;
+            }
+            continue;
+        }
+
+        const QJsonObject localObj = taskToSyncJson(localTask);
+        QStringList conflictFields;
+        QJsonObject merged = mergeSyncTask(base, localObj, cloudObj, &conflictFields);
+        if (!conflictFields.isEmpty()) {
+            conflicts++;
+            QJsonObject localValues;
+            QJsonObject cloudValues;
+            for (const QString &field : conflictFields) {
+                localValues[field] = localObj.value(field);
+                cloudValues[field] = cloudObj.value(field);
+            }
+
+            if (strategy == SyncConflictStrategy_Manual) {
+                // 先按本地值保存，对话框在整批合并写入后再逐个弹出
+                SyncConflict conflict;
+                conflict.taskId = task.id;
+                conflict.localValues = localValues;
+                conflict.cloudValues = cloudValues;
+                m_pendingConflicts.append(conflict);
+            } else if (strategy == SyncConflictStrategy_Cloud) {
+                for (const QString &field : conflictFields) {
+                    merged[field] = cloudObj.value(field);
                 }
+                addConflictLog(m_db, task.id, localValues, cloudValues, "cloud_wins");
             } else {
-                // 如果没有有效的更新时间，默认保留本地数据
+                addConflictLog(m_db, task.id, cloudValues, localValues, "local_wins");
             }
         }
+
+        Task mergedTask = taskFromSyncJson(merged);
+        if (sameTaskContent(mergedTask, task)) {
+            // 合并结果与云端一致，直接采用云端（不分配新版本号，避免再上传回去）
+            m_db->addTaskWithId(task);
+            updated++;
+        } else if (sameTaskContent(mergedTask, localTask)) {
+            // 云端的修改本地都已包含，本地版本尚未上传时照常上传
+            if (localTask.version <= lastSyncVersion) {
+                m_db->updateTaskVersion(task.id);
+            }
+            skipped++;
+        } else {
+            // 合并了双方的修改，作为一次本地修改保存并上传一次
+            m_db->updateTask(mergedTask);
+            updated++;
+        }
+    }
+
+    if (!transaction.commit()) {
+        qWarning() << "Merge of tasks synced from cloud was rolled back";
+        return;
+    }
+
+    // 合并成功后才推进下载位置；合并失败或下载中断时下次从原位置重新下载
+    if (cursor >= 0) {
+        m_db->setTaskDownloadCursor(cursor);
+    }
+
+    qDebug() << "Tasks synced from cloud, count:" << tasks.size()
+             << "added:" << added << "updated:" << updated
+             << "skipped:" << skipped << "conflicts:" << conflicts;
+    if (added > 0 || updated > 0 || conflicts > 0) {
+        emit statusMessageRequested(QString("工作日志已同步：新增 %1，更新 %2，跳过 %3，冲突 %4")
+                                    .arg(added).arg(updated).arg(skipped).arg(conflicts), 5000);
+    }
+
+    // 下载期间被推迟的上传
+    if (m_pendingSync && m_syncTimer && !m_syncTimer->isActive()) {
+        m_syncTimer->start();
     }
 
-    // 更新同步时间
-    m_lastSyncTime = QDateTime::currentDateTime();
+    resolvePendingConflicts();
+}
+
+// 逐个弹出需要手动选择的字段冲突。合并时冲突字段已按本地值保存，
+// 选择本地或关闭对话框时无需改动；对话框打开期间新到的冲突排在队尾
+void UserMenuWidget::resolvePendingConflicts()
+{
+    if (m_resolvingConflicts || !m_db) return;
+    m_resolvingConflicts = true;
+
+    while (!m_pendingConflicts.isEmpty()) {
+        const SyncConflict conflict = m_pendingConflicts.takeFirst();
+        Task current = m_db->getTaskById(conflict.taskId);
+        if (current.id.isEmpty()) {
+            continue;   // 期间已被删除
+        }
+
+        SyncConflictDialog dialog(conflict.taskId, current.title,
+                                  conflict.localValues, conflict.cloudValues, m_parent);
+        if (dialog.exec() != QDialog::Accepted) {
+            continue;
+        }
+
+        switch (dialog.getResolution()) {
+        case SyncConflictDialog::UseLocal:
+            addConflictLog(m_db, conflict.taskId, conflict.cloudValues, conflict.localValues, "manual");
+            break;
+        case SyncConflictDialog::UseCloud: {
+            QJsonObject taskObj = taskToSyncJson(current);
+            for (auto it = conflict.cloudValues.constBegin(); it != conflict.cloudValues.constEnd(); ++it) {
+                taskObj[it.key()] = it.value();
+            }
+            m_db->updateTask(taskFromSyncJson(taskObj));
+            addConflictLog(m_db, conflict.taskId, conflict.localValues, conflict.cloudValues, "manual");
+            break;
+        }
+        case SyncConflictDialog::KeepBoth: {
+            // 本地任务保持不变，另存一份采用云端值的副本
+            QJsonObject taskObj = taskToSyncJson(current);
+            for (auto it = conflict.cloudValues.constBegin(); it != conflict.cloudValues.constEnd(); ++it) {
+                taskObj[it.key()] = it.value();
+            }
+            m_db->addTask(taskFromSyncJson(taskObj));
+            addConflictLog(m_db, conflict.taskId, conflict.localValues, conflict.cloudValues, "manual");
+            break;
+        }
+        }
+    }
 
-    qDebug() << "Tasks synced from cloud, count:" << tasks.size();
+    m_resolvingConflicts = false;
 }
 
 void UserMenuWidget::onTasksUploadComplete()
 {
-    // 上传成功后更新同步时间，确保上传失败时可以重试
-    m_lastSyncTime = QDateTime::currentDateTime();
-    qDebug() << "Tasks uploaded successfully, sync time updated";
+    // 上传成功后才推进同步版本，确保上传失败时可以重试；
+    // 上传的内容即为云端当前的内容，作为之后合并的基准
+    if (m_db && m_uploadingVersion >= 0) {
+        for (const QJsonValue &taskVal : m_uploadingTasks) {
+            const QJsonObject taskObj = taskVal.toObject();
+            m_db->setTaskSyncBase(taskObj["id"].toString(), taskObj);
+        }
+        m_db->markTasksSynced(m_uploadingVersion);
+    }
+    m_uploadingVersion = -1;
+    m_uploadingTasks = QJsonArray();
+    m_retryAttempt = 0;
+    if (m_retryTimer) {
+        m_retryTimer->stop();
+    }
+    qDebug() << "Tasks uploaded successfully, sync version updated";
+    updateSyncQueueDepth();
 
     // 设置同步状态
     if (m_networkMonitor) {
         m_networkMonitor->setSyncing(false);
     }
 
-    // 上传完成后，增量下载云端最新数据
-    TaskSync::instance()->downloadIncrementalTasks(m_lastSyncTime.toUTC().toString(Qt::ISODate));
+    // 上传完成后，增量下载上次合并以来的云端数据
+    TaskSync::instance()->downloadIncrementalTasks(m_db ? m_db->getTaskDownloadCursor() : 0);
+
+    // 上传期间又有修改，接着同步
+    if (m_pendingSync && m_syncTimer && !m_syncTimer->isActive()) {
+        m_syncTimer->start();
+    }
 }
 
 void UserMenuWidget::onTasksSyncFailed(const QString& error)
 {
     qDebug() << "Tasks sync failed:" << error;
+    // 没有上传在进行时失败的是下载
+    if (m_uploadingVersion < 0) {
+        m_retryDownload = true;
+    }
+    m_uploadingVersion = -1;
+    m_uploadingTasks = QJsonArray();
     if (m_networkMonitor) {
         m_networkMonitor->setSyncing(false);
     }
+    scheduleSyncRetry();
+}
+
+// 未上传的修改保存在任务文件中（版本号和删除记录），失败后按指数退避重试，重启后也不会丢失
+void UserMenuWidget::scheduleSyncRetry()
+{
+    if (!m_db || !m_retryTimer || !UserManager::instance()->isLoggedIn()) {
+        return;
+    }
+    // 离线时不重试，恢复联网后由 onNetworkStatusChanged 立即发送
+    bool isOnline = m_networkMonitor ? m_networkMonitor->isOnline() : true;
+    if (!isOnline || (m_db->getPendingTaskSyncCount() == 0 && !m_retryDownload)) {
+        return;
+    }
+
+    qint64 delay = qMin<qint64>(SYNC_RETRY_MAX_MS, static_cast<qint64>(SYNC_RETRY_BASE_MS) << qMin(m_retryAttempt, 16));
+    // 在 [delay/2, delay] 范围内随机取值
+    delay = delay / 2 + QRandomGenerator::global()->bounded(delay / 2 + 1);
+    m_retryAttempt++;
+
+    qDebug() << "Retrying task sync in" << delay << "ms, attempt" << m_retryAttempt;
+    m_retryTimer->start(static_cast<int>(delay));
+}
+
+// 有待上传的修改时先上传，上传完成后会接着下载；只有下载失败时直接重新下载
+void UserMenuWidget::retrySync()
+{
+    if (m_db && m_db->getPendingTaskSyncCount() > 0) {
+        m_pendingSync = true;
+        onSyncTimerTimeout();
+        return;
+    }
+
+    bool isOnline = m_networkMonitor ? m_networkMonitor->isOnline() : true;
+    if (m_db && m_retryDownload && isOnline && UserManager::instance()->isLoggedIn()) {
+        qDebug() << "Retrying task download";
+        TaskSync::instance()->downloadIncrementalTasks(m_db->getTaskDownloadCursor());
+    }
+}
+
+void UserMenuWidget::updateSyncQueueDepth()
+{
+    if (m_db) {
+        emit syncQueueDepthChanged(m_db->getPendingTaskSyncCount());
+    }
 }
 
 void UserMenuWidget::onNetworkStatusChanged(bool online)
 {
     if (online) {
         qDebug() << "Network became online, checking for pending sync...";
-        // 如果有待同步的数据，立即触发同步
-        if (m_pendingSync && UserManager::instance()->isLoggedIn()) {
-            onSyncTimerTimeout();
+        // 如果有待同步的数据或失败的下载，立即重试，不再等待退避
+        if (UserManager::instance()->isLoggedIn() && m_db
+            && (m_db->getPendingTaskSyncCount() > 0 || m_retryDownload)) {
+            m_retryAttempt = 0;
+            m_retryTimer->stop();
+            retrySync();
         }
     } else {
         qDebug() << "Network became offline";
+        if (m_retryTimer) {
+            m_retryTimer->stop();
+        }
     }
 }
 
@@ -352,6 +744,9 @@ void UserMenuWidget::onSyncRequested()
 {
     if (UserManager::instance()->isLoggedIn() && m_db) {
         qDebug() << "Sync requested from NetworkMonitor";
+        if (m_db->getPendingTaskSyncCount() > 0) {
+            m_pendingSync = true;
+        }
         if (!m_syncTimer->isActive()) {
             m_syncTimer->start();
         }
@@ -360,8 +755,10 @@ void UserMenuWidget::onSyncRequested()
 
 void UserMenuWidget::onTasksChanged()
 {
+    updateSyncQueueDepth();
+
     // 当本地任务发生变化时，触发防抖同步
-    // 检查网络状态：离线时不触发同步
+    // 检查网络状态：离线时不触发同步，修改留在待同步队列中，联网后发送
     bool isOnline = m_networkMonitor ? m_networkMonitor->isOnline() : true;
     if (UserManager::instance()->isLoggedIn() && m_db && isOnline) {
         // 标记有待同步的数据
@@ -392,61 +789,9 @@ void UserMenuWidget::onSyncTimerTimeout()
     if (m_pendingSync && UserManager::instance()->isLoggedIn() && m_db) {
         m_pendingSync = false;
 
-        // 设置同步状态
-        if (m_networkMonitor) {
-            m_networkMonitor->setSyncing(true);
-        }
-
         qDebug() << "Sync timer timeout, uploading changed tasks to cloud...";
 
-        // 增量上传：只上传自上次同步以来变化的任务
-        QList<Task> localTasks = m_db->getAllTasks();
-
-        // 检测被删除的任务：比较当前任务ID列表和上次同步时的任务ID列表
-        QStringList currentTaskIds;
-        for (const Task &task : localTasks) {
-            currentTaskIds.append(task.id);
-        }
-
-        // 找出被删除的任务ID（在previous中但不在current中）
-        QStringList deletedIds;
-        for (const QString &prevId : m_previousTaskIds) {
-            if (!currentTaskIds.contains(prevId)) {
-                deletedIds.append(prevId);
-                qDebug() << "Detected deleted task:" << prevId;
-            }
-        }
-
-        QJsonArray tasksArray;
-        for (const Task &task : localTasks) {
-            // 检查任务是否在上次同步后有更新
-            if (task.updatedAt.isValid() && task.updatedAt > m_lastSyncTime) {
-                QJsonObject taskObj;
-                taskObj["id"] = task.id;
-                taskObj["title"] = task.title;
-                taskObj["description"] = task.description;
-                taskObj["categoryId"] = task.categoryId;
-                taskObj["priority"] = task.priority;
-                taskObj["status"] = task.status;
-                taskObj["workDuration"] = task.workDuration;
-                taskObj["completionTime"] = task.completionTime.toUTC().toString(Qt::ISODate);
-                taskObj["tags"] = QJsonArray::fromStringList(task.tags);
-                taskObj["updatedAt"] = task.updatedAt.toUTC().toString(Qt::ISODate);
-                tasksArray.append(taskObj);
-                qDebug() << "Uploading changed task:" << task.title;
-            }
-        }
-
-        // 保存当前任务ID列表供下次比较
-        m_previousTaskIds = currentTaskIds;
-
-        if (tasksArray.size() > 0 || deletedIds.size() > 0) {
-            // 使用新函数上传任务和删除列表
-            TaskSync::instance()->uploadTasksWithDeleted(tasksArray, deletedIds);
-            // 注意：m_lastSyncTime 在 uploadTasks 成功完成后更新
-            // 以确保上传失败时可以重试
-        } else {
-            qDebug() << "No changed tasks to upload";
-        }
+        // 增量上传：只上传版本号大于上次同步版本的任务和删除记录
+        uploadPendingTasks(false);
     }
 }
@@ -6,6 +6,9 @@
 #include <QMenu>
 #include <QAction>
 #include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
 
 class ChangePasswordDialog;
 class Database;
@@ -24,6 +27,7 @@ public:
 
 signals:
     void statusMessageRequested(const QString &message, int durationMs = 3000);
+    void syncQueueDepthChanged(int depth);  // 尚未上传到云端的任务修改数
     void showBackupVersionsDialogRequested();
 
 public slots:
@@ -41,13 +45,27 @@ private slots:
     void onSyncRequested();
 
 private:
+    // 同步基准直接调用上传和合并，测量应用内的同步路径
+    friend class SyncBenchmark;
+
+    // 三方合并后仍需手动选择的任务，只包含冲突字段
+    struct SyncConflict {
+        QString taskId;
+        QJsonObject localValues;
+        QJsonObject cloudValues;
+    };
+
     void updateMenuState();
     void syncTasksToCloud();
-    void syncTasksIncremental();
-    void onTasksSynced(const QJsonArray& tasks);
+    bool uploadPendingTasks(bool fullUpload);
+    void onTasksSynced(const QJsonArray& tasks, qint64 cursor);
     void onTasksUploadComplete();
     void onTasksSyncFailed(const QString& error);
+    void resolvePendingConflicts();
     void onSyncTimerTimeout();
+    void scheduleSyncRetry();
+    void retrySync();
+    void updateSyncQueueDepth();
 
     QWidget *m_parent;
     Database *m_db;
@@ -57,9 +75,13 @@ private:
     QAction *m_registerAction;
     QTimer *m_syncTimer;
     bool m_pendingSync;
-    QDateTime m_lastSyncTime;
-    QStringList m_deletedTaskIds;  // 跟踪已删除的任务ID，用于同步删除到云端
-    QStringList m_previousTaskIds;  // 上次同步时的任务ID列表，用于检测删除
+    qint64 m_uploadingVersion;  // 正在上传的任务版本号，-1 表示没有上传在进行
+    QJsonArray m_uploadingTasks;  // 正在上传的任务内容，上传成功后作为合并基准
+    QTimer *m_retryTimer;       // 同步失败后的重试定时器
+    int m_retryAttempt;         // 连续失败次数，决定下次重试的等待时间
+    bool m_retryDownload;       // 下载失败，重试时需要重新下载
+    QList<SyncConflict> m_pendingConflicts;
+    bool m_resolvingConflicts;  // 正在逐个弹出冲突对话框
     NetworkMonitor* m_networkMonitor;
 };
 
@@ -568,6 +568,7 @@ void AppManagerWidget::onMoveDown()
 
 void AppManagerWidget::saveAppOrder()
 {
+    DatabaseTransaction transaction(db);
     for (int i = 0; i < appModel->rowCount(); ++i) {
         QStandardItem *item = appModel->item(i);
         int appId = item->data(Qt::UserRole).toInt();
@@ -575,6 +576,7 @@ void AppManagerWidget::saveAppOrder()
         app.sortOrder = i;
         db->updateApp(app);
     }
+    transaction.commit();
 }
 
 void AppManagerWidget::refreshAppList()
@@ -323,9 +323,12 @@ void RemoteDesktopWidget::refreshConnectionList()
         connections = filtered;
     }
     
-    std::sort(connections.begin(), connections.end(), [](const RemoteDesktopConnection &a, const RemoteDesktopConnection &b) {
-        return a.sortOrder < b.sortOrder;
-    });
+    // 搜索结果保持相关度顺序
+    if (searchText.isEmpty()) {
+        std::sort(connections.begin(), connections.end(), [](const RemoteDesktopConnection &a, const RemoteDesktopConnection &b) {
+            return a.sortOrder < b.sortOrder;
+        });
+    }
 
     loadConnections(connections);
 }
@@ -239,6 +239,24 @@ QWidget *SettingsWidget::createGeneralPage()
 
     layout->addWidget(trayGroup);
 
+    QGroupBox *storageGroup = new QGroupBox("数据存储", page);
+    QVBoxLayout *storageLayout = new QVBoxLayout(storageGroup);
+    storageLayout->setSpacing(10);
+
+    QCheckBox *compactStorageCheck = new QCheckBox("使用紧凑二进制格式保存数据", storageGroup);
+    compactStorageCheck->setChecked(db->getStorageFormat() == StorageCodec::Cbor);
+    connect(compactStorageCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        db->setStorageFormat(checked ? StorageCodec::Cbor : StorageCodec::Json);
+    });
+    storageLayout->addWidget(compactStorageCheck);
+
+    QLabel *storageHint = new QLabel("二进制格式文件更小、加载更快；切换后现有数据会自动转换为新格式。", page);
+    storageHint->setStyleSheet("color: #666; font-size: 12px; padding: 5px;");
+    storageHint->setWordWrap(true);
+    storageLayout->addWidget(storageHint);
+
+    layout->addWidget(storageGroup);
+
     layout->addStretch();
     return page;
 }
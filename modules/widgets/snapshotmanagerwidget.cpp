@@ -15,6 +15,7 @@
 #include <QDirIterator>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSet>
 
 SnapshotIconDelegate::SnapshotIconDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
@@ -236,11 +237,13 @@ void SnapshotManagerWidget::refreshSnapshotList()
     if (searchText.isEmpty()) {
         filteredSnapshots = snapshots;
     } else {
+        // 按相关度排序，只保留当前视图中的快照
+        QSet<int> visibleIds;
         for (const SnapshotInfo &snapshot : snapshots) {
-            if (snapshot.name.toLower().contains(searchText.toLower()) ||
-                snapshot.description.toLower().contains(searchText.toLower()) ||
-                snapshot.tags.toLower().contains(searchText.toLower()) ||
-                snapshot.path.toLower().contains(searchText.toLower())) {
+            visibleIds.insert(snapshot.id);
+        }
+        for (const SnapshotInfo &snapshot : db->searchSnapshots(searchText)) {
+            if (visibleIds.contains(snapshot.id)) {
                 filteredSnapshots.append(snapshot);
             }
         }
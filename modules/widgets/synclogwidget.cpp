@@ -7,13 +7,18 @@
 #include <QComboBox>
 #include <QLabel>
 #include <QHeaderView>
+#include <QScrollBar>
 #include <QMessageBox>
 #include <QJsonDocument>
 #include <QJsonObject>
 
+// 每次从日志文件读取的条数
+#define SYNC_LOG_PAGE_SIZE 100
+
 SyncLogWidget::SyncLogWidget(Database* db, QWidget *parent)
     : QWidget(parent)
     , m_db(db)
+    , m_totalCount(0)
 {
     setupUi();
     loadLogs();
@@ -68,6 +73,8 @@ void SyncLogWidget::setupUi()
             this, &SyncLogWidget::onEntityTypeChanged);
     connect(m_table, &QTableWidget::cellDoubleClicked,
             this, &SyncLogWidget::onRowDoubleClicked);
+    connect(m_table->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &SyncLogWidget::onScrolled);
 }
 
 void SyncLogWidget::loadLogs()
@@ -75,13 +82,31 @@ void SyncLogWidget::loadLogs()
     if (!m_db) return;
 
     QString entityType = m_entityTypeCombo->currentData().toString();
-    QList<SyncLog> logs = m_db->getSyncLogs(entityType, 100);
+    m_loadedBefore = QDateTime::currentDateTime().addMSecs(1);
+    m_totalCount = m_db->getSyncLogCount(entityType, m_loadedBefore);
+
+    m_table->setRowCount(0);
+    m_countLabel->setText(QString("共 %1 条").arg(m_totalCount));
+    loadMoreLogs();
+}
 
-    m_table->setRowCount(logs.size());
-    m_countLabel->setText(QString("共 %1 条").arg(logs.size()));
+void SyncLogWidget::loadMoreLogs()
+{
+    int offset = m_table->rowCount();
+    if (!m_db || offset >= m_totalCount) return;
 
-    for (int i = 0; i < logs.size(); ++i) {
-        const SyncLog& log = logs.at(i);
+    QString entityType = m_entityTypeCombo->currentData().toString();
+    QList<SyncLog> logs = m_db->getSyncLogs(entityType, SYNC_LOG_PAGE_SIZE, offset, m_loadedBefore);
+    if (logs.isEmpty()) {
+        // 日志已被清空或覆盖，不再继续读取
+        m_totalCount = offset;
+        return;
+    }
+
+    m_table->setRowCount(offset + logs.size());
+    for (int j = 0; j < logs.size(); ++j) {
+        const SyncLog& log = logs.at(j);
+        int i = offset + j;
 
         m_table->setItem(i, 0, new QTableWidgetItem(log.timestamp.toString("yyyy-MM-dd HH:mm:ss")));
         m_table->setItem(i, 1, new QTableWidgetItem(log.entityType));
@@ -92,6 +117,15 @@ void SyncLogWidget::loadLogs()
     }
 }
 
+void SyncLogWidget::onScrolled(int value)
+{
+    // 接近底部时读取下一页
+    QScrollBar* bar = m_table->verticalScrollBar();
+    if (value >= bar->maximum() - bar->pageStep() / 2) {
+        loadMoreLogs();
+    }
+}
+
 void SyncLogWidget::onRefreshClicked()
 {
     loadLogs();
@@ -9,6 +9,7 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
+#include <QDateTime>
 
 class Database;
 struct SyncLog;
@@ -28,9 +29,11 @@ private slots:
     void onClearClicked();
     void onEntityTypeChanged(int index);
     void onRowDoubleClicked(int row, int column);
+    void onScrolled(int value);
 
 private:
     void setupUi();
+    void loadMoreLogs();
     QString getActionText(const QString& action);
     QString getResolutionText(const QString& resolution);
 
@@ -40,6 +43,11 @@ private:
     QPushButton* m_clearBtn;
     QComboBox* m_entityTypeCombo;
     QLabel* m_countLabel;
+
+    // 日志按页读取：滚动到底部时再读下一页。以打开列表的时间为界，
+    // 期间新写入的日志不会打乱分页，刷新后才显示
+    QDateTime m_loadedBefore;
+    int m_totalCount;
 };
 
 #endif // SYNCLOGWIDGET_H
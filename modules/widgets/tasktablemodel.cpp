@@ -0,0 +1,253 @@
+#include "tasktablemodel.h"
+#include <algorithm>
+
+TaskTableModel::TaskTableModel(Database *db, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_db(db)
+    , m_viewDate(QDate::currentDate())
+{
+    connect(m_db, &Database::taskChanged, this, &TaskTableModel::refreshTask);
+    connect(m_db, &Database::tasksReset, this, &TaskTableModel::reload);
+}
+
+void TaskTableModel::setViewDate(const QDate &date)
+{
+    m_viewDate = date;
+    reload();
+}
+
+QString TaskTableModel::taskIdAt(int row) const
+{
+    return row >= 0 && row < m_taskIds.size() ? m_taskIds.at(row) : QString();
+}
+
+void TaskTableModel::reload()
+{
+    beginResetModel();
+    const QList<Task> tasks = m_db->getTasksForDate(m_viewDate);
+    m_taskIds.clear();
+    m_taskIds.reserve(tasks.size());
+    for (const Task &task : tasks) {
+        m_taskIds.append(task.id);
+    }
+    m_rows.clear();
+    reindexFrom(0);
+    endResetModel();
+}
+
+// 单个任务变化：只通知受影响的一行，新任务按ID插入到对应位置
+void TaskTableModel::refreshTask(const QString &id)
+{
+    const Task *task = m_db->findLoadedTask(id);
+    bool shown = task && Database::isTaskShownOnDate(*task, m_viewDate);
+    int row = m_rows.value(id, -1);
+
+    if (row >= 0) {
+        if (shown) {
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        } else {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_taskIds.remove(row);
+            m_rows.remove(id);
+            reindexFrom(row);
+            endRemoveRows();
+        }
+        return;
+    }
+
+    if (!shown) {
+        return;
+    }
+
+    // 新建的任务ID最大，通常追加在末尾
+    row = static_cast<int>(std::lower_bound(m_taskIds.constBegin(), m_taskIds.constEnd(), id) - m_taskIds.constBegin());
+    beginInsertRows(QModelIndex(), row, row);
+    m_taskIds.insert(row, id);
+    reindexFrom(row);
+    endInsertRows();
+}
+
+void TaskTableModel::reindexFrom(int row)
+{
+    for (int i = row; i < m_taskIds.size(); ++i) {
+        m_rows.insert(m_taskIds.at(i), i);
+    }
+}
+
+int TaskTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_taskIds.size();
+}
+
+int TaskTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TaskTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_taskIds.size()) {
+        return QVariant();
+    }
+
+    const QString &id = m_taskIds.at(index.row());
+    if (role == TaskIdRole) {
+        return id;
+    }
+
+    const Task *task = m_db->findLoadedTask(id);
+    if (!task) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case IndexColumn: return index.row() + 1;
+        case TitleColumn: return task->title;
+        case CategoryColumn: return Database::categoryName(task->categoryId);
+        case PriorityColumn: return priorityText(task->priority);
+        case StatusColumn: return statusText(task->status);
+        case DurationColumn: return durationText(task->workDuration);
+        case TagsColumn: return task->tags.join(", ");
+        case CompletionColumn:
+            return task->completionTime.isValid() ? task->completionTime.toString("yyyy-MM-dd hh:mm:ss") : QString("-");
+        }
+        break;
+    case Qt::TextAlignmentRole:
+        if (index.column() == IndexColumn) {
+            return static_cast<int>(Qt::AlignCenter);
+        }
+        break;
+    case SortRole:
+        switch (index.column()) {
+        case IndexColumn: return index.row();
+        case TitleColumn: return task->title;
+        case CategoryColumn: return Database::categoryName(task->categoryId);
+        case PriorityColumn: return static_cast<int>(task->priority);
+        case StatusColumn: return static_cast<int>(task->status);
+        case DurationColumn: return task->workDuration;
+        case TagsColumn: return task->tags.join(", ");
+        case CompletionColumn: return task->completionTime;
+        }
+        break;
+    case StatusRole:
+        return static_cast<int>(task->status);
+    case PriorityRole:
+        return static_cast<int>(task->priority);
+    case CategoryRole:
+        return task->categoryId;
+    }
+    return QVariant();
+}
+
+QVariant TaskTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const QStringList headers = {"🔢 序号", "📝 标题", "📁 分类", "🎯 优先级", "📊 状态", "⏱️ 工时", "🏷️ 标签", "📅 完成时间"};
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < headers.size()) {
+        return headers.at(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+QString TaskTableModel::priorityText(TaskPriority priority)
+{
+    switch (priority) {
+        case TaskPriority_Low: return "低";
+        case TaskPriority_Medium: return "中";
+        case TaskPriority_High: return "高";
+        default: return "中";
+    }
+}
+
+QString TaskTableModel::statusText(TaskStatus status)
+{
+    switch (status) {
+        case TaskStatus_Todo: return "待办";
+        case TaskStatus_InProgress: return "进行中";
+        case TaskStatus_Paused: return "暂停";
+        case TaskStatus_Completed: return "已完成";
+        default: return "待办";
+    }
+}
+
+QString TaskTableModel::durationText(double hours)
+{
+    if (hours < 1.0) {
+        int minutes = static_cast<int>(hours * 60);
+        return QString("%1分钟").arg(minutes);
+    } else {
+        return QString("%1小时").arg(hours, 0, 'f', 1);
+    }
+}
+
+TaskFilterProxyModel::TaskFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_status(-1)
+    , m_priority(-1)
+    , m_categoryId(-1)
+    , m_searching(false)
+{
+    setSortRole(TaskTableModel::SortRole);
+}
+
+void TaskFilterProxyModel::setFilters(int status, int priority, int categoryId)
+{
+    m_status = status;
+    m_priority = priority;
+    m_categoryId = categoryId;
+    invalidateFilter();
+}
+
+void TaskFilterProxyModel::setSearchScores(bool searching, const QHash<QString, int> &scores)
+{
+    m_searching = searching;
+    m_searchScores = scores;
+    invalidate();
+}
+
+QVariant TaskFilterProxyModel::data(const QModelIndex &index, int role) const
+{
+    // 序号按筛选排序后的行号显示
+    if (role == Qt::DisplayRole && index.column() == TaskTableModel::IndexColumn) {
+        return index.row() + 1;
+    }
+    return QSortFilterProxyModel::data(index, role);
+}
+
+bool TaskFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+
+    if (m_searching && !m_searchScores.contains(index.data(TaskTableModel::TaskIdRole).toString())) {
+        return false;
+    }
+    if (m_status != -1 && index.data(TaskTableModel::StatusRole).toInt() != m_status) {
+        return false;
+    }
+    if (m_priority != -1 && index.data(TaskTableModel::PriorityRole).toInt() != m_priority) {
+        return false;
+    }
+    // 分类筛选：如果选中了分类（不为-1），则只显示该分类
+    if (m_categoryId != -1 && index.data(TaskTableModel::CategoryRole).toInt() != m_categoryId) {
+        return false;
+    }
+    return true;
+}
+
+bool TaskFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (left.column() != TaskTableModel::IndexColumn) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+
+    // 默认顺序：搜索时按相关度从高到低，相关度相同或不在搜索时按任务ID
+    if (m_searching) {
+        int leftScore = m_searchScores.value(left.data(TaskTableModel::TaskIdRole).toString());
+        int rightScore = m_searchScores.value(right.data(TaskTableModel::TaskIdRole).toString());
+        if (leftScore != rightScore) {
+            return leftScore > rightScore;
+        }
+    }
+    return left.row() < right.row();
+}
@@ -0,0 +1,96 @@
+#ifndef TASKTABLEMODEL_H
+#define TASKTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QDate>
+#include <QHash>
+#include <QVector>
+#include "modules/core/database.h"
+
+// 工作日志任务表的数据模型：只保存查看日期下任务ID的有序列表，单元格内容在绘制时直接从数据库的
+// 任务存储中读取，不为每个单元格创建对象。单个任务的增删改通过 Database::taskChanged
+// 转为对应行的 dataChanged、rowsInserted 或 rowsRemoved，整体变化时才重建列表
+class TaskTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IndexColumn,
+        TitleColumn,
+        CategoryColumn,
+        PriorityColumn,
+        StatusColumn,
+        DurationColumn,
+        TagsColumn,
+        CompletionColumn,
+        ColumnCount
+    };
+
+    enum Role {
+        TaskIdRole = Qt::UserRole,      // 任务ID，所有列都可取
+        SortRole,                       // 排序用的原始值
+        StatusRole,
+        PriorityRole,
+        CategoryRole
+    };
+
+    explicit TaskTableModel(Database *db, QObject *parent = nullptr);
+
+    void setViewDate(const QDate &date);
+    QDate viewDate() const { return m_viewDate; }
+    QString taskIdAt(int row) const;
+    int rowOfTask(const QString &id) const { return m_rows.value(id, -1); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    static QString priorityText(TaskPriority priority);
+    static QString statusText(TaskStatus status);
+    static QString durationText(double hours);
+
+public slots:
+    void reload();
+    void refreshTask(const QString &id);
+
+private:
+    void reindexFrom(int row);
+
+    Database *m_db;
+    QDate m_viewDate;
+    QVector<QString> m_taskIds;         // 按任务ID排序，与 getTasksForDate 一致
+    QHash<QString, int> m_rows;         // 任务ID -> 行号
+};
+
+// 任务表的筛选和排序：按状态、优先级、分类和搜索结果筛选。
+// 第一列按默认顺序排序，搜索时默认顺序为相关度从高到低
+class TaskFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit TaskFilterProxyModel(QObject *parent = nullptr);
+
+    // -1 表示不按该项筛选
+    void setFilters(int status, int priority, int categoryId);
+    // searching 为 false 时不按搜索结果筛选
+    void setSearchScores(bool searching, const QHash<QString, int> &scores);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    int m_status;
+    int m_priority;
+    int m_categoryId;
+    bool m_searching;
+    QHash<QString, int> m_searchScores;
+};
+
+#endif // TASKTABLEMODEL_H
@@ -10,8 +10,6 @@
 #include <QList>
 #include <QTableWidget>
 #include <QHeaderView>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QSettings>
@@ -369,6 +367,11 @@ void UserWidget::onSyncConfigLoaded(const QJsonObject &configs)
 
     int addedCount = 0;
 
+    // 云端配置整批合并，只写一次数据文件
+    if (m_db) {
+        m_db->beginBatch();
+    }
+
     // 处理应用列表
     if (configs.contains("apps") && m_db) {
         QJsonArray cloudApps = configs["apps"].toArray();
@@ -492,6 +495,11 @@ void UserWidget::onSyncConfigLoaded(const QJsonObject &configs)
         }
     }
 
+    if (m_db && !m_db->commitBatch()) {
+        addedCount = 0;
+        m_syncLogText->append(QString("[%1] 本次合并已撤销").arg(QDateTime::currentDateTime().toString("HH:mm:ss")));
+    }
+
     // 处理其他配置保存到 QSettings
     QSettings settings;
     for (auto it = configs.begin(); it != configs.end(); ++it) {
@@ -611,6 +619,20 @@ BackupVersionsDialog::BackupVersionsDialog(QWidget *parent)
 
 BackupVersionsDialog::~BackupVersionsDialog()
 {
+    // 对话框关闭后不再需要结果，取消仍在排队或进行中的请求
+    for (const QPointer<ApiRequest> &request : m_requests) {
+        if (request) {
+            disconnect(request, nullptr, this, nullptr);
+            request->cancel();
+        }
+    }
+}
+
+ApiRequest *BackupVersionsDialog::trackRequest(ApiRequest *request)
+{
+    m_requests.removeAll(QPointer<ApiRequest>());
+    m_requests.append(request);
+    return request;
 }
 
 void BackupVersionsDialog::setDatabase(Database *db)
@@ -732,26 +754,14 @@ void BackupVersionsDialog::loadVersions()
         return;
     }
 
-    QUrl url(QString(CLOUD_API_URL) + "/api/config/profiles");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + token).toUtf8());
-
-    QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-    QNetworkReply *reply = manager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        reply->deleteLater();
+    ApiRequest *request = trackRequest(ApiClient::instance()->get("/api/config/profiles"));
+    connect(request, &ApiRequest::failed, this, [this](int errorCode, const QString &error) {
+        Q_UNUSED(errorCode);
+        m_statusLabel->setText("加载失败: " + error);
+        m_statusLabel->setStyleSheet("color: red;");
+    });
+    connect(request, &ApiRequest::succeeded, this, [this](const QJsonDocument &doc) {
         m_statusLabel->setText("");
-
-        if (reply->error() != QNetworkReply::NoError) {
-            m_statusLabel->setText("加载失败: " + reply->errorString());
-            m_statusLabel->setStyleSheet("color: red;");
-            return;
-        }
-
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
         QJsonObject obj = doc.object();
 
         if (!obj["success"].toBool()) {
@@ -838,39 +848,35 @@ void BackupVersionsDialog::downloadConfig(const QString &configName)
         return;
     }
 
-    QUrl url(QString(CLOUD_API_URL) + "/api/config/profiles/" + QUrl::toPercentEncoding(configName));
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + token).toUtf8());
-
-    QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-    QNetworkReply *reply = manager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, configName, reply]() {
+    QString endpoint = "/api/config/profiles/" + QUrl::toPercentEncoding(configName);
+    ApiRequest *request = trackRequest(ApiClient::instance()->get(endpoint));
+    connect(request, &ApiRequest::failed, this, [this](int errorCode, const QString &error) {
+        Q_UNUSED(errorCode);
+        m_progressBar->setVisible(false);
+        m_statusLabel->setText("下载失败: " + error);
+        m_statusLabel->setStyleSheet("color: red;");
+    });
+    connect(request, &ApiRequest::succeeded, this, [this, configName](const QJsonDocument &doc) {
         m_progressBar->setVisible(false);
-
-        if (reply->error() != QNetworkReply::NoError) {
-            m_statusLabel->setText("下载失败: " + reply->errorString());
-            m_statusLabel->setStyleSheet("color: red;");
-            reply->deleteLater();
-            return;
-        }
-
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
         QJsonObject obj = doc.object();
 
         if (!obj["success"].toBool()) {
             m_statusLabel->setText("下载失败: " + obj["error"].toString());
             m_statusLabel->setStyleSheet("color: red;");
-            reply->deleteLater();
             return;
         }
 
         QJsonObject configs = obj["configs"].toObject();
 
+        // 下载到的即为服务器上的内容；服务器按段保存时记录哈希，下次上传只传变化的段
+        if (obj.contains("sectionHashes")) {
+            ConfigSync::instance()->acknowledgeProfileHashes(configName, ConfigSync::sectionHashes(configs));
+        }
+
         // 合并到本地数据库
         if (m_db) {
+            DatabaseTransaction transaction(m_db);
+
             // 处理应用列表
             if (configs.contains("apps")) {
                 QJsonArray cloudApps = configs["apps"].toArray();
@@ -969,6 +975,12 @@ void BackupVersionsDialog::downloadConfig(const QString &configName)
                 }
             }
 
+            if (!transaction.commit()) {
+                m_statusLabel->setText("合并失败: 本次合并已撤销");
+                m_statusLabel->setStyleSheet("color: red;");
+                return;
+            }
+
             // 处理其他配置保存到 QSettings
             QSettings settings;
             for (auto it = configs.begin(); it != configs.end(); ++it) {
@@ -1004,8 +1016,6 @@ void BackupVersionsDialog::downloadConfig(const QString &configName)
         if (m_mainWindow) {
             m_mainWindow->refreshAllWidgets();
         }
-
-        reply->deleteLater();
     });
 }
 
@@ -1020,40 +1030,29 @@ void BackupVersionsDialog::deleteConfig(const QString &configName)
         return;
     }
 
-    QUrl url(QString(CLOUD_API_URL) + "/api/config/profiles/" + QUrl::toPercentEncoding(configName));
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + token).toUtf8());
-
-    QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-    QNetworkReply *reply = manager->deleteResource(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, configName, reply]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            m_statusLabel->setText("删除失败: " + reply->errorString());
-            m_statusLabel->setStyleSheet("color: red;");
-            reply->deleteLater();
-            return;
-        }
-
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
+    QString endpoint = "/api/config/profiles/" + QUrl::toPercentEncoding(configName);
+    ApiRequest *request = trackRequest(ApiClient::instance()->deleteResource(endpoint));
+    connect(request, &ApiRequest::failed, this, [this](int errorCode, const QString &error) {
+        Q_UNUSED(errorCode);
+        m_statusLabel->setText("删除失败: " + error);
+        m_statusLabel->setStyleSheet("color: red;");
+    });
+    connect(request, &ApiRequest::succeeded, this, [this, configName](const QJsonDocument &doc) {
         QJsonObject obj = doc.object();
 
         if (!obj["success"].toBool()) {
             m_statusLabel->setText("删除失败: " + obj["error"].toString());
             m_statusLabel->setStyleSheet("color: red;");
-            reply->deleteLater();
             return;
         }
 
+        ConfigSync::instance()->acknowledgeProfileHashes(configName, QJsonObject());
+
         m_statusLabel->setText(QString("配置 [%1] 已删除").arg(configName));
         m_statusLabel->setStyleSheet("color: #28a745;");
 
         // 刷新列表
         loadVersions();
-
-        reply->deleteLater();
     });
 }
 
@@ -1153,39 +1152,69 @@ void BackupVersionsDialog::onUploadWithNameClicked()
         return;
     }
 
-    QUrl url(QString(CLOUD_API_URL) + "/api/config/upload");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + token).toUtf8());
+    uploadConfigProfile(configName, localConfigs, false);
+}
+
+// 只上传与该备份上次确认内容不同的段，服务器按 sectionHashes 保留未上传的段；
+// 服务器缺少某些段（备份在别处被修改或删除）时以完整内容重传一次
+void BackupVersionsDialog::uploadConfigProfile(const QString &configName, const QJsonObject &configs, bool fullUpload)
+{
+    QJsonObject hashes = ConfigSync::sectionHashes(configs);
+    QJsonObject acknowledged = fullUpload ? QJsonObject() : ConfigSync::instance()->acknowledgedProfileHashes(configName);
+    if (!acknowledged.isEmpty() && acknowledged == hashes) {
+        m_progressBar->setVisible(false);
+        m_statusLabel->setText(QString("配置 [%1] 没有变化，无需上传").arg(configName));
+        m_statusLabel->setStyleSheet("color: #28a745;");
+        return;
+    }
+
+    QJsonObject changed;
+    for (auto it = configs.begin(); it != configs.end(); ++it) {
+        if (acknowledged.value(it.key()).toString() != hashes.value(it.key()).toString()) {
+            changed[it.key()] = it.value();
+        }
+    }
 
     QJsonObject body;
-    body["configs"] = localConfigs;
+    body["configs"] = changed;
     body["config_name"] = configName;
+    body["sectionHashes"] = hashes;
+
+    ApiRequest *request = trackRequest(ApiClient::instance()->post("/api/config/upload", body));
+    connect(request, &ApiRequest::failed, this, [this, configName, configs, fullUpload](int errorCode, const QString &error) {
+        // 409：服务器上的备份缺少未上传的段
+        if (errorCode == 409 && !fullUpload) {
+            qDebug() << "Config profile missing sections, uploading in full:" << configName;
+            uploadConfigProfile(configName, configs, true);
+            return;
+        }
 
-    QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-    QNetworkReply *reply = manager->post(request, QJsonDocument(body).toJson());
-
-    connect(reply, &QNetworkReply::finished, this, [this, configName, reply]() {
         m_progressBar->setVisible(false);
+        m_statusLabel->setText("上传失败: " + error);
+        m_statusLabel->setStyleSheet("color: red;");
+    });
+    connect(request, &ApiRequest::succeeded, this, [this, request, configName, configs, hashes, fullUpload](const QJsonDocument &doc) {
+        QJsonObject obj = doc.object();
 
-        if (reply->error() != QNetworkReply::NoError) {
-            m_statusLabel->setText("上传失败: " + reply->errorString());
-            m_statusLabel->setStyleSheet("color: red;");
-            reply->deleteLater();
+        // 409 的响应带有 JSON 内容时同样按成功返回，由状态码区分
+        if (request->statusCode() == 409 && !fullUpload) {
+            qDebug() << "Config profile missing sections, uploading in full:" << obj["missingSections"].toArray();
+            uploadConfigProfile(configName, configs, true);
             return;
         }
 
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        QJsonObject obj = doc.object();
+        m_progressBar->setVisible(false);
 
         if (!obj["success"].toBool()) {
             m_statusLabel->setText("上传失败: " + obj["error"].toString());
             m_statusLabel->setStyleSheet("color: red;");
-            reply->deleteLater();
             return;
         }
 
+        // 服务器回传 sectionHashes 说明它按段保存，下次可以只传变化的段；旧版服务器整体覆盖，不记录
+        ConfigSync::instance()->acknowledgeProfileHashes(configName,
+            obj.contains("sectionHashes") ? hashes : QJsonObject());
+
         m_statusLabel->setText(QString("上传成功！配置 [%1]").arg(configName));
         m_statusLabel->setStyleSheet("color: #28a745;");
 
@@ -1194,7 +1223,5 @@ void BackupVersionsDialog::onUploadWithNameClicked()
 
         // 刷新配置列表
         loadVersions();
-
-        reply->deleteLater();
     });
 }
@@ -20,6 +20,7 @@
 #include <QNetworkAccessManager>
 #include <QCheckBox>
 #include <QNetworkReply>
+#include <QPointer>
 #include "modules/core/database.h"
 #include "modules/user/userapi.h"
 #include "modules/user/changepassworddialog.h"
@@ -104,6 +105,8 @@ private:
     void loadVersions();
     void downloadConfig(const QString &configName);
     void deleteConfig(const QString &configName);
+    void uploadConfigProfile(const QString &configName, const QJsonObject &configs, bool fullUpload);
+    ApiRequest *trackRequest(ApiRequest *request);
 
 private slots:
     void onRefreshClicked();
@@ -127,6 +130,7 @@ private:
     QCheckBox *m_includeSettingsCheck;
 
     QList<QVariantMap> m_versions;
+    QList<QPointer<ApiRequest>> m_requests;     // 尚未完成的请求，关闭对话框时取消
 };
 
 #endif // USERWIDGET_H
@@ -55,14 +55,9 @@ void updateCategoryFilterText(QComboBox *comboBox, QStandardItemModel *model)
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QPointer>
+#include <QSharedPointer>
 #include <QFile>
 #include <QDir>
-#include <QPrinter>
-#include <QTextDocument>
-#include <QMarginsF>
-#include <QPageSize>
-#include <QPageLayout>
-#include <QRegularExpression>
 #include <QCoreApplication>
 using namespace QtCharts;
 
@@ -75,6 +70,8 @@ WorkLogWidget::WorkLogWidget(Database *database, QWidget *parent)
     leftPanel = nullptr;
     rightPanel = nullptr;
     taskTable = nullptr;
+    taskModel = nullptr;
+    taskProxy = nullptr;
     viewStacker = nullptr;
     calendarViewContainer = nullptr;
     calendarWidget = nullptr;
@@ -119,6 +116,9 @@ WorkLogWidget::WorkLogWidget(Database *database, QWidget *parent)
 
     // 初始化当前日历月份
     currentCalendarMonth = QDate::currentDate();
+    calendarPrefetchPending = false;
+
+    reportEngine = new ReportEngine(db, this);
 
     // 初始化统计标签数组
     for (int i = 0; i < 4; i++) {
@@ -130,8 +130,24 @@ WorkLogWidget::WorkLogWidget(Database *database, QWidget *parent)
     loadTasks();
     updateStatistics();
 
-    // 连接数据库任务变化信号，用户切换时自动刷新
-    connect(db, &Database::tasksChanged, this, &WorkLogWidget::onRefreshTasks);
+    // 日历缓存按任务的创建月份组织：单个任务变化只作废它所在的月份，整体变化时全部作废
+    connect(db, &Database::taskChanged, this, [this](const QString &id) {
+        QDate created = Database::taskCreationDate(id);
+        if (created.isValid()) {
+            calendarMonthCache.remove(QDate(created.year(), created.month(), 1));
+        } else {
+            calendarMonthCache.clear();
+        }
+    });
+    connect(db, &Database::tasksReset, this, [this]() {
+        calendarMonthCache.clear();
+    });
+
+    // 任务表由模型跟随数据库更新，这里只刷新统计和日历；日历只重新查询被作废的月份
+    connect(db, &Database::tasksChanged, this, [this]() {
+        updateStatistics();
+        refreshCalendarView();
+    });
 
     taskTimer = new QTimer(this);
     networkManager = new QNetworkAccessManager(this);
@@ -379,7 +395,7 @@ void WorkLogWidget::setupUI()
         }
 
         /* 表格样式 */
-        QTableWidget {
+        QTableView {
             border: 1px solid #dfe6e9;
             border-radius: 4px;
             background-color: #ffffff;
@@ -388,12 +404,12 @@ void WorkLogWidget::setupUI()
             selection-color: white;
         }
 
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
             border: none;
         }
 
-        QTableWidget::item:selected {
+        QTableView::item:selected {
             background-color: #3498db;
             color: white;
         }
@@ -871,8 +887,8 @@ void WorkLogWidget::setupUI()
     connect(nextDayBtn, &QPushButton::clicked, this, &WorkLogWidget::onNextDay);
     connect(todayBtn, &QPushButton::clicked, this, &WorkLogWidget::onToday);
 
-    connect(taskTable, &QTableWidget::itemSelectionChanged, this, &WorkLogWidget::onTaskSelectionChanged);
-    connect(taskTable, &QTableWidget::cellDoubleClicked, this, &WorkLogWidget::onTaskDoubleClicked);
+    connect(taskTable->selectionModel(), &QItemSelectionModel::selectionChanged, this, &WorkLogWidget::onTaskSelectionChanged);
+    connect(taskTable, &QTableView::doubleClicked, this, &WorkLogWidget::onTaskDoubleClicked);
 
     connect(searchEdit, &QLineEdit::textChanged, this, &WorkLogWidget::onFilterChanged);
     connect(statusFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &WorkLogWidget::onFilterChanged);
@@ -883,7 +899,7 @@ void WorkLogWidget::setupUI()
     connect(customEndDate, &QDateEdit::dateChanged, this, &WorkLogWidget::updateStatistics);
 
     taskTable->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(taskTable, &QTableWidget::customContextMenuRequested, this, &WorkLogWidget::onTaskContextMenu);
+    connect(taskTable, &QTableView::customContextMenuRequested, this, &WorkLogWidget::onTaskContextMenu);
 }
 
 void WorkLogWidget::setupToolbar()
@@ -892,9 +908,14 @@ void WorkLogWidget::setupToolbar()
 
 void WorkLogWidget::setupTaskTable()
 {
-    taskTable = new QTableWidget();
-    taskTable->setColumnCount(8);
-    taskTable->setHorizontalHeaderLabels({"🔢 序号", "📝 标题", "📁 分类", "🎯 优先级", "📊 状态", "⏱️ 工时", "🏷️ 标签", "📅 完成时间"});
+    // 任务表直接显示数据库中的任务，筛选和排序由代理模型完成
+    taskModel = new TaskTableModel(db, this);
+    taskModel->setViewDate(taskViewDate ? taskViewDate->date() : QDate::currentDate());
+    taskProxy = new TaskFilterProxyModel(this);
+    taskProxy->setSourceModel(taskModel);
+
+    taskTable = new QTableView();
+    taskTable->setModel(taskProxy);
 
     taskTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     taskTable->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -904,7 +925,8 @@ void WorkLogWidget::setupTaskTable()
     taskTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
     taskTable->verticalHeader()->setVisible(false);
     taskTable->setShowGrid(true);
-    taskTable->setSortingEnabled(false);
+    taskTable->setSortingEnabled(true);
+    taskTable->sortByColumn(TaskTableModel::IndexColumn, Qt::AscendingOrder);
 
     // 设置列宽
     taskTable->setColumnWidth(0, 60);
@@ -979,19 +1001,28 @@ void WorkLogWidget::refreshCalendarView()
     // 更新年月选择器
     monthDateEdit->setDate(currentCalendarMonth);
 
-    // 设置日历月份
+    // 设置日历月份和任务信息
     calendarWidget->setMonth(currentCalendarMonth);
+    calendarWidget->setTaskInfos(calendarTasksForMonth(currentCalendarMonth));
 
-    // 获取当前月份的任务
-    QDate firstDayOfMonth(currentCalendarMonth.year(), currentCalendarMonth.month(), 1);
-    QDate lastDayOfMonth = firstDayOfMonth.addMonths(1).addDays(-1);
+    prefetchCalendarMonths();
+}
+
+const CalendarTaskMap &WorkLogWidget::calendarTasksForMonth(const QDate &month)
+{
+    QDate firstDayOfMonth(month.year(), month.month(), 1);
+    auto cached = calendarMonthCache.constFind(firstDayOfMonth);
+    if (cached != calendarMonthCache.constEnd()) {
+        return cached.value();
+    }
 
+    QDate lastDayOfMonth = firstDayOfMonth.addMonths(1).addDays(-1);
     QList<Task> monthTasks = db->getTasksByDateRange(
         QDateTime(firstDayOfMonth, QTime(0, 0, 0)),
         QDateTime(lastDayOfMonth, QTime(23, 59, 59)));
 
     // 按日期组织任务 - 显示所有任务（已完成的使用completionTime，未完成的显示在今天或updatedAt）
-    QMap<QDate, QVector<QPair<QString, QPair<TaskStatus, double>>>> tasksByDate;
+    CalendarTaskMap tasksByDate;
     for (const Task &task : monthTasks) {
         QDate taskDate;
         if (task.completionTime.isValid()) {
@@ -1004,8 +1035,21 @@ void WorkLogWidget::refreshCalendarView()
         tasksByDate[taskDate].append(qMakePair(task.title, qMakePair(task.status, task.workDuration)));
     }
 
-    // 设置任务信息到日历
-    calendarWidget->setTaskInfos(tasksByDate);
+    return calendarMonthCache.insert(firstDayOfMonth, tasksByDate).value();
+}
+
+// 在事件循环空闲时准备前后两个月的数据，翻月时直接使用缓存
+void WorkLogWidget::prefetchCalendarMonths()
+{
+    if (calendarPrefetchPending) {
+        return;
+    }
+    calendarPrefetchPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        calendarPrefetchPending = false;
+        calendarTasksForMonth(currentCalendarMonth.addMonths(-1));
+        calendarTasksForMonth(currentCalendarMonth.addMonths(1));
+    });
 }
 
 void WorkLogWidget::onPrevMonth()
@@ -1026,25 +1070,8 @@ void WorkLogWidget::onMonthChanged(const QDate &date)
     calendarWidget->setMonth(currentCalendarMonth);
 
     // 刷新任务数据
-    QDate firstDayOfMonth = currentCalendarMonth;
-    QDate lastDayOfMonth = firstDayOfMonth.addMonths(1).addDays(-1);
-
-    QList<Task> monthTasks = db->getTasksByDateRange(
-        QDateTime(firstDayOfMonth, QTime(0, 0, 0)),
-        QDateTime(lastDayOfMonth, QTime(23, 59, 59)));
-
-    QMap<QDate, QVector<QPair<QString, QPair<TaskStatus, double>>>> tasksByDate;
-    for (const Task &task : monthTasks) {
-        QDate taskDate;
-        if (task.completionTime.isValid()) {
-            taskDate = task.completionTime.date();
-        } else {
-            // 未完成的任务显示在今天或updatedAt的日期
-            taskDate = task.updatedAt.isValid() ? task.updatedAt.date() : QDate::currentDate();
-        }
-        tasksByDate[taskDate].append(qMakePair(task.title, qMakePair(task.status, task.workDuration)));
-    }
-    calendarWidget->setTaskInfos(tasksByDate);
+    calendarWidget->setTaskInfos(calendarTasksForMonth(currentCalendarMonth));
+    prefetchCalendarMonths();
 }
 
 void WorkLogWidget::onGoToToday()
@@ -1119,92 +1146,28 @@ void WorkLogWidget::loadTasks()
 
 void WorkLogWidget::refreshTaskTable()
 {
-    taskTable->setRowCount(0);
-
     QDate viewDate = taskViewDate->date();
-    QList<Task> allTasks = db->getTasksForDate(viewDate);
+    if (taskModel->viewDate() != viewDate) {
+        taskModel->setViewDate(viewDate);
+    }
 
-    QString searchText = searchEdit->text().toLower();
+    QString searchText = searchEdit->text().trimmed();
+    QHash<QString, int> searchScores;
+    if (!searchText.isEmpty()) {
+        searchScores = db->matchTaskIds(searchText);
+    }
     int statusValue = statusFilter->currentData().toInt();
     int priorityValue = priorityFilter->currentData().toInt();
 
-    QString viewDateStr = viewDate.toString("yyyyMMdd");
-
     // 获取选中的分类ID
     int selectedCategoryId = categoryFilter->currentData().toInt();
 
-    QSet<QString> displayedTaskIds;
-
-    for (const Task &task : allTasks) {
-        QString taskDateStr = task.id.left(8);
-
-        if (!searchText.isEmpty()) {
-            if (!task.title.toLower().contains(searchText) &&
-                !task.description.toLower().contains(searchText)) {
-                continue;
-            }
-        }
-
-        if (statusValue != -1 && static_cast<int>(task.status) != statusValue) {
-            continue;
-        }
-
-        if (priorityValue != -1 && static_cast<int>(task.priority) != priorityValue) {
-            continue;
-        }
-
-        // 分类筛选：如果选中了分类（不为-1），则只显示该分类
-        if (selectedCategoryId != -1 && task.categoryId != selectedCategoryId) {
-            continue;
-        }
-
-        if (displayedTaskIds.contains(task.id)) {
-            continue;
-        }
+    taskProxy->setFilters(statusValue, priorityValue, selectedCategoryId);
+    taskProxy->setSearchScores(!searchText.isEmpty(), searchScores);
 
-        int row = taskTable->rowCount();
-        taskTable->insertRow(row);
-        updateTaskRow(row, task);
-        displayedTaskIds.insert(task.id);
-    }
-}
-
-void WorkLogWidget::updateTaskRow(int row, const Task &task)
-{
-    taskTable->setItem(row, 0, new QTableWidgetItem(QString::number(row + 1)));
-    taskTable->item(row, 0)->setTextAlignment(Qt::AlignCenter);
-
-    taskTable->setItem(row, 1, new QTableWidgetItem(task.title));
-
-    // 从内置分类中查找
-    QString categoryName = "未分类";
-    for (const Category &cat : Database::getBuiltinCategories()) {
-        if (cat.id == task.categoryId) {
-            categoryName = cat.name;
-            break;
-        }
-    }
-    taskTable->setItem(row, 2, new QTableWidgetItem(categoryName));
-
-    taskTable->setItem(row, 3, new QTableWidgetItem(getPriorityString(task.priority)));
-    taskTable->setItem(row, 4, new QTableWidgetItem(getStatusString(task.status)));
-    taskTable->setItem(row, 5, new QTableWidgetItem(getDurationString(task.workDuration)));
-
-    QString tags = task.tags.join(", ");
-    taskTable->setItem(row, 6, new QTableWidgetItem(tags));
-    
-    QString completionText;
-    if (task.completionTime.isValid()) {
-        completionText = task.completionTime.toString("yyyy-MM-dd hh:mm:ss");
-    } else {
-        completionText = "-";
-    }
-    taskTable->setItem(row, 7, new QTableWidgetItem(completionText));
-
-    for (int col = 0; col < taskTable->columnCount(); ++col) {
-        if (taskTable->item(row, col)) {
-            taskTable->item(row, col)->setData(Qt::UserRole, task.id);
-        }
+    // 搜索时按相关度排序
+    if (!searchText.isEmpty()) {
+        taskTable->sortByColumn(TaskTableModel::IndexColumn, Qt::AscendingOrder);
     }
 }
 
@@ -1212,18 +1175,12 @@ void WorkLogWidget::updateStatistics()
 {
     if (!db) return;
 
-    QList<Task> allTasks = db->getAllTasks();
-
-    int totalTasks = allTasks.size();
-    int completedTasks = 0;
-    double totalHours = 0.0;
+    // 统计数据由 Database 按日期增量维护，这里只合并所需区间的每日汇总
+    TaskStats overallStats = db->getTaskStats();
 
-    for (const Task &task : allTasks) {
-        if (task.status == TaskStatus_Completed) {
-            completedTasks++;
-            totalHours += task.workDuration;
-        }
-    }
+    int totalTasks = overallStats.taskCount;
+    int completedTasks = overallStats.completedCount;
+    double totalHours = overallStats.completedHours;
 
     if (totalTasksLabel) {
         totalTasksLabel->setText(QString("总任务数: %1").arg(totalTasks));
@@ -1267,44 +1224,18 @@ void WorkLogWidget::updateStatistics()
                 break;
         }
 
-        QList<Task> filteredTasks;
-        for (const Task &task : allTasks) {
-            if (task.id.length() >= 8) {
-                QString dateStr = task.id.left(8);
-                QDate taskDate = QDate::fromString(dateStr, "yyyyMMdd");
-                if (taskDate.isValid() && taskDate >= startDate && taskDate <= endDate) {
-                    filteredTasks.append(task);
-                }
-            }
-        }
-
-        int periodTotalTasks = filteredTasks.size();
-        int periodCompletedTasks = 0;
-        double periodHours = 0.0;
-
-        for (const Task &task : filteredTasks) {
-            if (task.status == TaskStatus_Completed) {
-                periodCompletedTasks++;
-                periodHours += task.workDuration;
-            }
-        }
+        TaskStats periodStats = db->getTaskStatsByCreatedDate(startDate, endDate);
+        double periodHours = periodStats.completedHours;
 
         // 更新饼图显示分类时间分布
         if (pieChart) {
             pieChart->removeAllSeries();
 
             QMap<QString, double> categoryHours;
-            for (const Task &task : filteredTasks) {
-                if (task.status == TaskStatus_Completed) {
-                    // 从内置分类中查找
-                    QString catName = "未分类";
-                    for (const Category &cat : Database::getBuiltinCategories()) {
-                        if (cat.id == task.categoryId) {
-                            catName = cat.name;
-                            break;
-                        }
-                    }
-                    categoryHours[catName] += task.workDuration;
+            for (auto it = periodStats.categories.constBegin(); it != periodStats.categories.constEnd(); ++it) {
+                if (it.value().completedCount > 0) {
+                    QString catName = Database::categoryName(it.key());
+                    categoryHours[catName] += it.value().completedHours;
                 }
             }
 
@@ -1383,16 +1314,7 @@ void WorkLogWidget::updateStatistics()
 
     // 更新今日工时
     QDate today = QDate::currentDate();
-    double todayHours = 0.0;
-    for (const Task &task : allTasks) {
-        if (task.id.length() >= 8) {
-            QString dateStr = task.id.left(8);
-            QDate taskDate = QDate::fromString(dateStr, "yyyyMMdd");
-            if (task.status == TaskStatus_Completed && taskDate.isValid() && taskDate == today) {
-                todayHours += task.workDuration;
-            }
-        }
-    }
+    double todayHours = db->getTaskStatsByCreatedDate(today, today).completedHours;
     if (todayProgress) {
         int targetHours = 8;
         int percentage = static_cast<int>((todayHours / targetHours) * 100);
@@ -1417,16 +1339,7 @@ void WorkLogWidget::updateStatistics()
 
     // 更新本周工时
     QDate weekStart = QDate::currentDate().addDays(-(QDate::currentDate().dayOfWeek() - 1));
-    double weekHours = 0.0;
-    for (const Task &task : allTasks) {
-        if (task.id.length() >= 8) {
-            QString dateStr = task.id.left(8);
-            QDate taskDate = QDate::fromString(dateStr, "yyyyMMdd");
-            if (task.status == TaskStatus_Completed && taskDate.isValid() && taskDate >= weekStart && taskDate <= today) {
-                weekHours += task.workDuration;
-            }
-        }
-    }
+    double weekHours = db->getTaskStatsByCreatedDate(weekStart, today).completedHours;
     if (weekProgress) {
         int targetHours = 40;
         int percentage = static_cast<int>((weekHours / targetHours) * 100);
@@ -1474,7 +1387,6 @@ void WorkLogWidget::onDeleteTask()
                                      QMessageBox::Yes | QMessageBox::No);
     if (ret == QMessageBox::Yes) {
         db->deleteTask(task.id);
-        refreshTaskTable();
         updateStatistics();
         refreshCalendarView();
     }
@@ -1495,7 +1407,6 @@ void WorkLogWidget::onCompleteTask()
 
     db->updateTaskStatus(task.id, TaskStatus_Completed);
 
-    refreshTaskTable();
     updateStatistics();
     refreshCalendarView();
 }
@@ -1515,7 +1426,6 @@ void WorkLogWidget::onPauseTask()
 
     db->updateTaskStatus(task.id, TaskStatus_Paused);
 
-    refreshTaskTable();
     updateStatistics();
 }
 
@@ -1523,11 +1433,10 @@ void WorkLogWidget::onTaskSelectionChanged()
 {
 }
 
-void WorkLogWidget::onTaskDoubleClicked(int row, int column)
+void WorkLogWidget::onTaskDoubleClicked(const QModelIndex &index)
 {
-    QTableWidgetItem *item = taskTable->item(row, 0);
-    if (item) {
-        QString taskId = item->data(Qt::UserRole).toString();
+    if (index.isValid()) {
+        QString taskId = index.data(TaskTableModel::TaskIdRole).toString();
         Task task = db->getTaskById(taskId);
         if (!task.id.isEmpty()) {
             showTaskDialog(&task);
@@ -1537,6 +1446,7 @@ void WorkLogWidget::onTaskDoubleClicked(int row, int column)
 
 void WorkLogWidget::onRefreshTasks()
 {
+    taskModel->reload();
     refreshTaskTable();
     updateStatistics();
     refreshCalendarView();
@@ -1578,26 +1488,19 @@ void WorkLogWidget::onGenerateReport()
         endDate = QDate(today.year(), startMonth + 2, 1).addDays(-1);
     }
 
-    QString cacheKey = QString("%1_%2_%3").arg(reportType).arg(startDate.toString("yyyyMMdd")).arg(endDate.toString("yyyyMMdd"));
-    QString reportContent = getCachedReport(cacheKey);
-    
-    bool fromCache = !reportContent.isEmpty();
-    
-    if (!fromCache) {
-        if (reportType == "周报") {
-            reportContent = generateWeeklyReport(QDateTime(startDate), QDateTime(endDate));
-        } else if (reportType == "月报") {
-            reportContent = generateMonthlyReport(QDateTime(startDate), QDateTime(endDate));
-        } else {
-            reportContent = generateQuarterlyReport(QDateTime(startDate), QDateTime(endDate));
-        }
-        cacheReport(cacheKey, reportContent);
-        logOperation("generate_report", QString("类型: %1, 时间范围: %2 - %3, 来源: %4")
-                    .arg(reportType)
-                    .arg(startDate.toString("yyyy-MM-dd"))
-                    .arg(endDate.toString("yyyy-MM-dd"))
-                    .arg(fromCache ? "缓存" : "新生成"));
+    // 统计数据由 reportEngine 按天缓存并随任务修改失效，每次生成的报告都是最新的
+    QString reportContent;
+    if (reportType == "周报") {
+        reportContent = generateWeeklyReport(QDateTime(startDate), QDateTime(endDate));
+    } else if (reportType == "月报") {
+        reportContent = generateMonthlyReport(QDateTime(startDate), QDateTime(endDate));
+    } else {
+        reportContent = generateQuarterlyReport(QDateTime(startDate), QDateTime(endDate));
     }
+    logOperation("generate_report", QString("类型: %1, 时间范围: %2 - %3")
+                .arg(reportType)
+                .arg(startDate.toString("yyyy-MM-dd"))
+                .arg(endDate.toString("yyyy-MM-dd")));
 
     QDialog reportDialog(this);
     reportDialog.setWindowTitle(reportType);
@@ -1634,53 +1537,47 @@ void WorkLogWidget::onGenerateReport()
     layout->addLayout(btnLayout);
 
     QLabel *cacheLabel = new QLabel(&reportDialog);
-    if (fromCache) {
-        cacheLabel->setText("💾 从缓存加载");
-        cacheLabel->setStyleSheet("color: #666; font-size: 11px;");
-    }
     layout->addWidget(cacheLabel);
 
     QTextEdit *reportEdit = new QTextEdit(&reportDialog);
     reportEdit->setPlainText(reportContent);
     layout->addWidget(reportEdit);
 
-    connect(reportEdit, &QTextEdit::textChanged, [this, cacheLabel, cacheKey]() {
-        clearReportCache();
+    connect(reportEdit, &QTextEdit::textChanged, [cacheLabel]() {
         if (cacheLabel) {
             cacheLabel->setText("✏️ 已编辑");
         }
     });
 
-    connect(aiGenerateBtn, &QPushButton::clicked, [this, reportEdit, reportType, reportContent, aiModelCombo]() {
+    connect(aiGenerateBtn, &QPushButton::clicked, [this, reportEdit, reportType, reportContent, aiModelCombo,
+                                                   aiGenerateBtn, exportPDFBtn, exportWordBtn, exportMarkdownBtn]() {
         QString currentModel = aiModelCombo->currentData().toString();
-        onAIGenerateReport(currentModel, reportEdit, reportType, reportContent);
+        // 生成过程中报告内容不完整，不能再次生成或导出
+        onAIGenerateReport(currentModel, reportEdit, reportType, reportContent,
+                           { aiGenerateBtn, aiModelCombo, exportPDFBtn, exportWordBtn, exportMarkdownBtn });
     });
 
-    connect(exportPDFBtn, &QPushButton::clicked, [this, reportEdit, reportType]() {
+    connect(exportPDFBtn, &QPushButton::clicked, [this, reportEdit, reportType, &reportDialog]() {
         QString defaultName = reportType + "_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".pdf";
         QString fileName = QFileDialog::getSaveFileName(this, "导出PDF", defaultName, "PDF文件 (*.pdf)");
         if (!fileName.isEmpty()) {
-            if (exportToPDF(reportEdit->toPlainText(), fileName)) {
-                QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
-            }
+            exportReport(reportEdit->toPlainText(), fileName, ReportExporter::Pdf, true, &reportDialog);
         }
     });
 
-    connect(exportWordBtn, &QPushButton::clicked, [this, reportEdit, reportType]() {
+    connect(exportWordBtn, &QPushButton::clicked, [this, reportEdit, reportType, &reportDialog]() {
         QString defaultName = reportType + "_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".docx";
         QString fileName = QFileDialog::getSaveFileName(this, "导出Word", defaultName, "Word文件 (*.docx)");
         if (!fileName.isEmpty()) {
-            if (exportToWord(reportEdit->toPlainText(), fileName)) {
-                QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
-            }
+            exportReport(reportEdit->toPlainText(), fileName, ReportExporter::Word, true, &reportDialog);
         }
     });
 
-    connect(exportMarkdownBtn, &QPushButton::clicked, [this, reportEdit, reportType]() {
+    connect(exportMarkdownBtn, &QPushButton::clicked, [this, reportEdit, reportType, &reportDialog]() {
         QString defaultName = reportType + "_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".md";
         QString fileName = QFileDialog::getSaveFileName(this, "导出Markdown", defaultName, "Markdown文件 (*.md)");
         if (!fileName.isEmpty()) {
-            exportToMarkdown(reportEdit->toPlainText(), fileName);
+            exportReport(reportEdit->toPlainText(), fileName, ReportExporter::Markdown, false, &reportDialog);
         }
     });
 
@@ -1735,11 +1632,7 @@ void WorkLogWidget::onExportReport()
                                                      "Markdown文件 (*.md);;文本文件 (*.txt)");
     if (fileName.isEmpty()) return;
 
-    if (fileName.endsWith(".md")) {
-        exportToMarkdown(reportContent, fileName);
-    } else {
-        exportToText(reportContent, fileName);
-    }
+    exportReport(reportContent, fileName, fileName.endsWith(".md") ? ReportExporter::Markdown : ReportExporter::Text);
 }
 
 void WorkLogWidget::onShowStatistics()
@@ -1761,7 +1654,6 @@ void WorkLogWidget::onQuickAddTask()
     task.workDuration = 0.0;
 
     db->addTask(task);
-    refreshTaskTable();
     updateStatistics();
     refreshCalendarView();
 }
@@ -1776,33 +1668,29 @@ void WorkLogWidget::onStopTask()
 
 void WorkLogWidget::onTaskContextMenu(const QPoint &pos)
 {
-    QTableWidgetItem *item = taskTable->itemAt(pos);
-    if (!item) {
+    QModelIndex index = taskTable->indexAt(pos);
+    if (!index.isValid()) {
         return;
     }
 
-    int row = item->row();
-    QString taskId = taskTable->item(row, 0)->data(Qt::UserRole).toString();
+    QString taskId = index.data(TaskTableModel::TaskIdRole).toString();
 
     QMenu menu(this);
 
     menu.addAction("▶️ 开始任务", this, [this, taskId]() {
         db->updateTaskStatus(taskId, TaskStatus_InProgress);
-        refreshTaskTable();
         updateStatistics();
         refreshCalendarView();
     });
 
     menu.addAction("⏸️ 暂停任务", this, [this, taskId]() {
         db->updateTaskStatus(taskId, TaskStatus_Paused);
-        refreshTaskTable();
         updateStatistics();
         refreshCalendarView();
     });
 
     menu.addAction("✅ 完成任务", this, [this, taskId]() {
         db->updateTaskStatus(taskId, TaskStatus_Completed);
-        refreshTaskTable();
         updateStatistics();
         refreshCalendarView();
     });
@@ -1813,7 +1701,6 @@ void WorkLogWidget::onTaskContextMenu(const QPoint &pos)
         Task task = db->getTaskById(taskId);
         if (!task.id.isEmpty()) {
             showTaskDialog(&task);
-            refreshTaskTable();
             updateStatistics();
             refreshCalendarView();
         }
@@ -1828,7 +1715,6 @@ void WorkLogWidget::onTaskContextMenu(const QPoint &pos)
 
             if (ret == QMessageBox::Yes) {
                 if (db->deleteTask(taskId)) {
-                    refreshTaskTable();
                     updateStatistics();
                     refreshCalendarView();
                     //QMessageBox::information(this, "成功", "任务已删除");
@@ -1844,23 +1730,15 @@ void WorkLogWidget::onTaskContextMenu(const QPoint &pos)
 
 Task WorkLogWidget::getCurrentTask()
 {
-    QList<QTableWidgetItem*> selectedItems = taskTable->selectedItems();
-    if (selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = taskTable->selectionModel()->selectedRows();
+    if (selectedRows.isEmpty()) {
         Task task;
         task.id = "";
         return task;
     }
 
-    int row = selectedItems.first()->row();
-    QTableWidgetItem *item = taskTable->item(row, 0);
-    if (item) {
-        QString taskId = item->data(Qt::UserRole).toString();
-        return db->getTaskById(taskId);
-    }
-
-    Task task;
-    task.id = "";
-    return task;
+    QString taskId = selectedRows.first().data(TaskTableModel::TaskIdRole).toString();
+    return db->getTaskById(taskId);
 }
 
 Category WorkLogWidget::getCurrentCategory()
@@ -1882,33 +1760,17 @@ Category WorkLogWidget::getCurrentCategory()
 
 QString WorkLogWidget::getPriorityString(TaskPriority priority)
 {
-    switch (priority) {
-        case TaskPriority_Low: return "低";
-        case TaskPriority_Medium: return "中";
-        case TaskPriority_High: return "高";
-        default: return "中";
-    }
+    return TaskTableModel::priorityText(priority);
 }
 
 QString WorkLogWidget::getStatusString(TaskStatus status)
 {
-    switch (status) {
-        case TaskStatus_Todo: return "待办";
-        case TaskStatus_InProgress: return "进行中";
-        case TaskStatus_Paused: return "暂停";
-        case TaskStatus_Completed: return "已完成";
-        default: return "待办";
-    }
+    return TaskTableModel::statusText(status);
 }
 
 QString WorkLogWidget::getDurationString(double hours)
 {
-    if (hours < 1.0) {
-        int minutes = static_cast<int>(hours * 60);
-        return QString("%1分钟").arg(minutes);
-    } else {
-        return QString("%1小时").arg(hours, 0, 'f', 1);
-    }
+    return TaskTableModel::durationText(hours);
 }
 
 void WorkLogWidget::showTaskDialog(Task *task)
@@ -2234,7 +2096,6 @@ void WorkLogWidget::showTaskDialog(Task *task)
             //QMessageBox::information(this, "成功", "任务已创建");
         }
 
-        refreshTaskTable();
         updateStatistics();
         refreshCalendarView();
     }
@@ -2257,37 +2118,20 @@ QString WorkLogWidget::generateWeeklyReport(const QDateTime &startDate, const QD
         .arg(start.toString("yyyy.MM.dd"))
         .arg(end.toString("yyyy.MM.dd"));
 
-    QList<Task> tasks = db->getTasksByDateRange(startDate, endDate);
-
-    QHash<QString, QList<Task>> categoryTasks;
-    for (const Task &task : tasks) {
-        if (task.status == TaskStatus_Completed) {
-            // 从内置分类中查找
-            QString categoryName = "未分类";
-            for (const Category &cat : Database::getBuiltinCategories()) {
-                if (cat.id == task.categoryId) {
-                    categoryName = cat.name;
-                    break;
-                }
-            }
-            categoryTasks[categoryName].append(task);
-        }
-    }
+    // 按天缓存的已完成任务，只在范围内有任务变化时重新统计
+    ReportEngine::Summary summary = reportEngine->summarize(start, end);
 
     report += "## 一、本周完成工作\n\n";
 
-    QStringList categoryNames = categoryTasks.keys();
-    std::sort(categoryNames.begin(), categoryNames.end());
-
-    for (const QString &categoryName : categoryNames) {
-        report += QString("### 【%1】\n").arg(categoryName);
+    for (auto it = summary.categoryItems.constBegin(); it != summary.categoryItems.constEnd(); ++it) {
+        report += QString("### 【%1】\n").arg(it.key());
         int index = 1;
-        for (const Task &task : categoryTasks[categoryName]) {
-            report += QString("%1. %2").arg(index).arg(task.title);
-            if (!task.description.isEmpty()) {
-                report += QString(" - %1").arg(task.description);
+        for (const ReportEngine::Item &item : it.value()) {
+            report += QString("%1. %2").arg(index).arg(item.title);
+            if (!item.description.isEmpty()) {
+                report += QString(" - %1").arg(item.description);
             }
-            report += QString("（%1）\n").arg(getDurationString(task.workDuration));
+            report += QString("（%1）\n").arg(getDurationString(item.workDuration));
             index++;
         }
         report += "\n";
@@ -2295,27 +2139,15 @@ QString WorkLogWidget::generateWeeklyReport(const QDateTime &startDate, const QD
 
     report += "## 二、本周工作统计\n\n";
 
-    int totalTasks = 0;
-    double totalHours = 0.0;
-
-    for (const QString &categoryName : categoryNames) {
-        int count = categoryTasks[categoryName].size();
-        double hours = 0.0;
-        for (const Task &task : categoryTasks[categoryName]) {
-            hours += task.workDuration;
-        }
-
+    for (auto it = summary.categoryTotals.constBegin(); it != summary.categoryTotals.constEnd(); ++it) {
         report += QString("- %1类：%2个任务，%3\n")
-            .arg(categoryName)
-            .arg(count)
-            .arg(getDurationString(hours));
-
-        totalTasks += count;
-        totalHours += hours;
+            .arg(it.key())
+            .arg(it.value().taskCount)
+            .arg(getDurationString(it.value().workDuration));
     }
 
-    report += QString("\n- 完成任务总数：%1\n").arg(totalTasks);
-    report += QString("- 总工作时长：%1\n\n").arg(getDurationString(totalHours));
+    report += QString("\n- 完成任务总数：%1\n").arg(summary.totalTasks);
+    report += QString("- 总工作时长：%1\n\n").arg(getDurationString(summary.totalHours));
 
     report += "## 三、本周工作亮点\n\n";
     report += "（待补充）\n\n";
@@ -2325,19 +2157,18 @@ QString WorkLogWidget::generateWeeklyReport(const QDateTime &startDate, const QD
 
     report += "## 五、下周计划\n\n";
 
-    QList<Task> todoTasks = db->getTasksByStatus(TaskStatus_Todo);
-    if (todoTasks.isEmpty()) {
+    QVector<ReportEngine::Item> todoItems = reportEngine->todoItems(10);
+    if (todoItems.isEmpty()) {
         report += "暂无待办任务\n";
     } else {
         int index = 1;
-        for (const Task &task : todoTasks) {
-            report += QString("%1. %2").arg(index).arg(task.title);
-            if (!task.description.isEmpty()) {
-                report += QString(" - %1").arg(task.description);
+        for (const ReportEngine::Item &item : todoItems) {
+            report += QString("%1. %2").arg(index).arg(item.title);
+            if (!item.description.isEmpty()) {
+                report += QString(" - %1").arg(item.description);
             }
             report += "\n";
             index++;
-            if (index > 10) break;
         }
     }
 
@@ -2356,37 +2187,20 @@ QString WorkLogWidget::generateMonthlyReport(const QDateTime &startDate, const Q
         .arg(start.toString("yyyy.MM.dd"))
         .arg(end.toString("yyyy.MM.dd"));
 
-    QList<Task> tasks = db->getTasksByDateRange(startDate, endDate);
-
-    QHash<QString, QList<Task>> categoryTasks;
-    for (const Task &task : tasks) {
-        if (task.status == TaskStatus_Completed) {
-            // 从内置分类中查找
-            QString categoryName = "未分类";
-            for (const Category &cat : Database::getBuiltinCategories()) {
-                if (cat.id == task.categoryId) {
-                    categoryName = cat.name;
-                    break;
-                }
-            }
-            categoryTasks[categoryName].append(task);
-        }
-    }
+    // 按天缓存的已完成任务，只在范围内有任务变化时重新统计
+    ReportEngine::Summary summary = reportEngine->summarize(start, end);
 
     report += "## 一、本月完成工作\n\n";
 
-    QStringList categoryNames = categoryTasks.keys();
-    std::sort(categoryNames.begin(), categoryNames.end());
-
-    for (const QString &categoryName : categoryNames) {
-        report += QString("### 【%1】\n").arg(categoryName);
+    for (auto it = summary.categoryItems.constBegin(); it != summary.categoryItems.constEnd(); ++it) {
+        report += QString("### 【%1】\n").arg(it.key());
         int index = 1;
-        for (const Task &task : categoryTasks[categoryName]) {
-            report += QString("%1. %2").arg(index).arg(task.title);
-            if (!task.description.isEmpty()) {
-                report += QString(" - %1").arg(task.description);
+        for (const ReportEngine::Item &item : it.value()) {
+            report += QString("%1. %2").arg(index).arg(item.title);
+            if (!item.description.isEmpty()) {
+                report += QString(" - %1").arg(item.description);
             }
-            report += QString("（%1）\n").arg(getDurationString(task.workDuration));
+            report += QString("（%1）\n").arg(getDurationString(item.workDuration));
             index++;
         }
         report += "\n";
@@ -2394,27 +2208,15 @@ QString WorkLogWidget::generateMonthlyReport(const QDateTime &startDate, const Q
 
     report += "## 二、本月工作统计\n\n";
 
-    int totalTasks = 0;
-    double totalHours = 0.0;
-
-    for (const QString &categoryName : categoryNames) {
-        int count = categoryTasks[categoryName].size();
-        double hours = 0.0;
-        for (const Task &task : categoryTasks[categoryName]) {
-            hours += task.workDuration;
-        }
-
+    for (auto it = summary.categoryTotals.constBegin(); it != summary.categoryTotals.constEnd(); ++it) {
         report += QString("- %1类：%2个任务，%3\n")
-            .arg(categoryName)
-            .arg(count)
-            .arg(getDurationString(hours));
-
-        totalTasks += count;
-        totalHours += hours;
+            .arg(it.key())
+            .arg(it.value().taskCount)
+            .arg(getDurationString(it.value().workDuration));
     }
 
-    report += QString("\n- 完成任务总数：%1\n").arg(totalTasks);
-    report += QString("- 总工作时长：%1\n\n").arg(getDurationString(totalHours));
+    report += QString("\n- 完成任务总数：%1\n").arg(summary.totalTasks);
+    report += QString("- 总工作时长：%1\n\n").arg(getDurationString(summary.totalHours));
 
     report += "## 三、月度工作亮点\n\n";
     report += "（待补充）\n\n";
@@ -2424,19 +2226,18 @@ QString WorkLogWidget::generateMonthlyReport(const QDateTime &startDate, const Q
 
     report += "## 五、下月计划\n\n";
 
-    QList<Task> todoTasks = db->getTasksByStatus(TaskStatus_Todo);
-    if (todoTasks.isEmpty()) {
+    QVector<ReportEngine::Item> todoItems = reportEngine->todoItems(10);
+    if (todoItems.isEmpty()) {
         report += "暂无待办任务\n";
     } else {
         int index = 1;
-        for (const Task &task : todoTasks) {
-            report += QString("%1. %2").arg(index).arg(task.title);
-            if (!task.description.isEmpty()) {
-                report += QString(" - %1").arg(task.description);
+        for (const ReportEngine::Item &item : todoItems) {
+            report += QString("%1. %2").arg(index).arg(item.title);
+            if (!item.description.isEmpty()) {
+                report += QString(" - %1").arg(item.description);
             }
             report += "\n";
             index++;
-            if (index > 10) break;
         }
     }
 
@@ -2458,38 +2259,20 @@ QString WorkLogWidget::generateQuarterlyReport(const QDateTime &startDate, const
         .arg(start.toString("yyyy.MM.dd"))
         .arg(end.toString("yyyy.MM.dd"));
 
-    QList<Task> tasks = db->getTasksByDateRange(startDate, endDate);
-
-    QHash<QString, QList<Task>> categoryTasks;
-
-    for (const Task &task : tasks) {
-        if (task.status == TaskStatus_Completed) {
-            // 从内置分类中查找
-            QString categoryName = "未分类";
-            for (const Category &cat : Database::getBuiltinCategories()) {
-                if (cat.id == task.categoryId) {
-                    categoryName = cat.name;
-                    break;
-                }
-            }
-            categoryTasks[categoryName].append(task);
-        }
-    }
+    // 按天缓存的已完成任务，只在范围内有任务变化时重新统计
+    ReportEngine::Summary summary = reportEngine->summarize(start, end);
 
     report += "## 一、季度完成工作\n\n";
 
-    QStringList categoryNames = categoryTasks.keys();
-    std::sort(categoryNames.begin(), categoryNames.end());
-
-    for (const QString &categoryName : categoryNames) {
-        report += QString("### 【%1】\n").arg(categoryName);
+    for (auto it = summary.categoryItems.constBegin(); it != summary.categoryItems.constEnd(); ++it) {
+        report += QString("### 【%1】\n").arg(it.key());
         int index = 1;
-        for (const Task &task : categoryTasks[categoryName]) {
-            report += QString("%1. %2").arg(index).arg(task.title);
-            if (!task.description.isEmpty()) {
-                report += QString(" - %1").arg(task.description);
+        for (const ReportEngine::Item &item : it.value()) {
+            report += QString("%1. %2").arg(index).arg(item.title);
+            if (!item.description.isEmpty()) {
+                report += QString(" - %1").arg(item.description);
             }
-            report += QString("（%1）\n").arg(getDurationString(task.workDuration));
+            report += QString("（%1）\n").arg(getDurationString(item.workDuration));
             index++;
         }
         report += "\n";
@@ -2497,27 +2280,15 @@ QString WorkLogWidget::generateQuarterlyReport(const QDateTime &startDate, const
 
     report += "## 二、季度工作统计\n\n";
 
-    int totalTasks = 0;
-    double totalHours = 0.0;
-
-    for (const QString &categoryName : categoryNames) {
-        int count = categoryTasks[categoryName].size();
-        double hours = 0.0;
-        for (const Task &task : categoryTasks[categoryName]) {
-            hours += task.workDuration;
-        }
-
+    for (auto it = summary.categoryTotals.constBegin(); it != summary.categoryTotals.constEnd(); ++it) {
         report += QString("- %1类：%2个任务，%3\n")
-            .arg(categoryName)
-            .arg(count)
-            .arg(getDurationString(hours));
-
-        totalTasks += count;
-        totalHours += hours;
+            .arg(it.key())
+            .arg(it.value().taskCount)
+            .arg(getDurationString(it.value().workDuration));
     }
 
-    report += QString("\n- 完成任务总数：%1\n").arg(totalTasks);
-    report += QString("- 总工作时长：%1\n\n").arg(getDurationString(totalHours));
+    report += QString("\n- 完成任务总数：%1\n").arg(summary.totalTasks);
+    report += QString("- 总工作时长：%1\n\n").arg(getDurationString(summary.totalHours));
 
     report += "## 四、季度工作亮点\n\n";
     report += "（待补充）\n\n";
@@ -2527,41 +2298,24 @@ QString WorkLogWidget::generateQuarterlyReport(const QDateTime &startDate, const
 
     report += "## 六、下季度计划\n\n";
 
-    QList<Task> todoTasks = db->getTasksByStatus(TaskStatus_Todo);
-    if (todoTasks.isEmpty()) {
+    QVector<ReportEngine::Item> todoItems = reportEngine->todoItems(15);
+    if (todoItems.isEmpty()) {
         report += "暂无待办任务\n";
     } else {
         int index = 1;
-        for (const Task &task : todoTasks) {
-            report += QString("%1. %2").arg(index).arg(task.title);
-            if (!task.description.isEmpty()) {
-                report += QString(" - %1").arg(task.description);
+        for (const ReportEngine::Item &item : todoItems) {
+            report += QString("%1. %2").arg(index).arg(item.title);
+            if (!item.description.isEmpty()) {
+                report += QString(" - %1").arg(item.description);
             }
             report += "\n";
             index++;
-            if (index > 15) break;
         }
     }
 
     return report;
 }
 
-bool WorkLogWidget::exportToMarkdown(const QString &content, const QString &fileName)
-{
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox::warning(this, "错误", "无法保存文件");
-        return false;
-    }
-
-    QByteArray utf8Data = content.toUtf8();
-    file.write(utf8Data);
-    file.close();
-
-    QMessageBox::information(this, "成功", "报告已成功导出");
-    return true;
-}
-
 QString WorkLogWidget::generateReportWithAI(const QString &reportType, const QString &reportData)
 {
     QString prompt;
@@ -2619,7 +2373,8 @@ void WorkLogWidget::onAIGenerateReport(QTextEdit *reportEdit, const QString &rep
     onAIGenerateReport(currentModel, reportEdit, reportType, reportData);
 }
 
-void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEdit, const QString &reportType, const QString &reportData)
+void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEdit, const QString &reportType, const QString &reportData,
+                                       const QList<QWidget *> &busyWidgets)
 {
     if (!reportEdit) {
         return;
@@ -2651,9 +2406,34 @@ void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEd
 
     QString prompt = generateReportWithAI(reportType, reportData);
 
+    // AI 分析写入报告的亮点一节（替换到“存在问题与改进”之前）
+    QString highlightsTitle;
+    QString problemsTitle;
+    if (reportType == "季报") {
+        highlightsTitle = "## 四、季度工作亮点";
+        problemsTitle = "## 五、存在问题与改进";
+    } else if (reportType == "月报") {
+        highlightsTitle = "## 三、月度工作亮点";
+        problemsTitle = "## 四、存在问题与改进";
+    } else {
+        highlightsTitle = "## 三、本周工作亮点";
+        problemsTitle = "## 四、存在问题与改进";
+    }
+
+    QString originalReport = reportEdit->toPlainText();
+    int highlightsPos = originalReport.indexOf(highlightsTitle);
+    int problemsPos = originalReport.indexOf(problemsTitle);
+    if (highlightsPos <= 0 || problemsPos <= highlightsPos) {
+        logOperation("ai_generate_report", QString("报告类型: %1, 插入内容失败").arg(reportType));
+        QMessageBox::warning(this, "警告", "无法将AI内容插入报告，请手动编辑");
+        return;
+    }
+    QString beforeHighlights = originalReport.left(highlightsPos) + highlightsTitle + "\n\n";
+    QString afterProblems = "\n\n" + originalReport.mid(problemsPos);
+
     QJsonObject json;
     json["model"] = modelName;
-    json["stream"] = false;
+    json["stream"] = true;
 
     QJsonArray messages;
     QJsonObject msg;
@@ -2675,7 +2455,8 @@ void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEd
         json["parameters"] = QJsonObject({
             {"temperature", 0.7},
             {"max_tokens", 1024},
-            {"result_format", "message"}
+            {"result_format", "message"},
+            {"incremental_output", true}
         });
     }
 
@@ -2705,7 +2486,12 @@ void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEd
     request.setUrl(QUrl(endpoint));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", QString("Bearer %1").arg(keyConfig.apiKey).toUtf8());
+    if (currentModel.startsWith("qwen")) {
+        // DashScope 原生接口通过请求头开启 SSE
+        request.setRawHeader("X-DashScope-SSE", "enable");
+    }
 
+    // 进度框只在等待第一段内容时显示，之后内容直接逐段写入报告
     QProgressDialog *progressDialog = new QProgressDialog("AI正在生成报告分析...", "取消", 0, 0, this);
     progressDialog->setWindowModality(Qt::WindowModal);
     progressDialog->setCancelButton(nullptr);
@@ -2713,9 +2499,25 @@ void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEd
     progressDialog->show();
 
     QPointer<QProgressDialog> progressDialogPtr(progressDialog);
+    QPointer<QTextEdit> reportEditPtr(reportEdit);
+    QList<QPointer<QWidget>> busyWidgetPtrs;
+    for (QWidget *widget : busyWidgets) {
+        widget->setEnabled(false);
+        busyWidgetPtrs.append(widget);
+    }
     QNetworkReply *reply = networkManager->post(request, postData);
     QPointer<QNetworkReply> replyPtr(reply);
+    // 报告窗口关闭后不再需要结果
+    connect(reportEdit, &QObject::destroyed, reply, &QNetworkReply::abort);
+
+    struct ReportStream {
+        AIStreamParser parser;
+        int insertPos;      // 下一段内容在报告中的写入位置，-1 表示尚未收到内容
+    };
+    QSharedPointer<ReportStream> stream(new ReportStream);
+    stream->insertPos = -1;
 
+    // 超时按两次收到数据之间的间隔计算，生成较长的报告时不会因总时长超时
     QTimer *timeoutTimer = new QTimer(this);
     timeoutTimer->setSingleShot(true);
     timeoutTimer->setInterval(AIConfig::instance().getTimeout() * 1000);
@@ -2725,13 +2527,49 @@ void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEd
             replyPtr->abort();
         }
     });
+    timeoutTimer->start();
+
+    auto appendContent = [reportEditPtr, progressDialogPtr, stream, beforeHighlights, afterProblems](const QString &delta) {
+        if (delta.isEmpty() || !reportEditPtr) {
+            return;
+        }
+        if (stream->insertPos < 0) {
+            if (progressDialogPtr) {
+                progressDialogPtr->close();
+            }
+            reportEditPtr->setReadOnly(true);
+            reportEditPtr->setPlainText(beforeHighlights + afterProblems);
+            stream->insertPos = beforeHighlights.length();
+        }
 
-    connect(reply, &QNetworkReply::finished, this, [this, replyPtr, reportEdit, reportType, progressDialogPtr, currentModel, logFileName, timeoutTimer]() {
+        QTextCursor cursor(reportEditPtr->document());
+        cursor.setPosition(stream->insertPos);
+        cursor.insertText(delta);
+        stream->insertPos += delta.length();
+        reportEditPtr->setTextCursor(cursor);
+        reportEditPtr->ensureCursorVisible();
+    };
+
+    connect(reply, &QNetworkReply::readyRead, this, [replyPtr, stream, timeoutTimer, appendContent]() {
+        if (!replyPtr) {
+            return;
+        }
+        timeoutTimer->start();
+        appendContent(stream->parser.feed(replyPtr->readAll()));
+    });
+
+    connect(reply, &QNetworkReply::finished, this, [this, replyPtr, reportEditPtr, reportType, progressDialogPtr, logFileName, timeoutTimer, stream, appendContent, originalReport, busyWidgetPtrs]() {
         if (timeoutTimer) {
             timeoutTimer->stop();
             timeoutTimer->deleteLater();
         }
 
+        for (const QPointer<QWidget> &widget : busyWidgetPtrs) {
+            if (widget) {
+                widget->setEnabled(true);
+            }
+        }
+
         if (progressDialogPtr) {
             progressDialogPtr->close();
         }
@@ -2739,123 +2577,62 @@ void WorkLogWidget::onAIGenerateReport(const QString &model, QTextEdit *reportEd
         if (!replyPtr) {
             return;
         }
+        replyPtr->deleteLater();
 
+        QString rest;
+        if (replyPtr->bytesAvailable() > 0) {
+            rest = stream->parser.feed(replyPtr->readAll());
+        }
+        rest += stream->parser.finish();
+        QString errorMsg;
         if (replyPtr->error() != QNetworkReply::NoError) {
-            QString errorMsg = replyPtr->errorString();
+            errorMsg = replyPtr->errorString();
             if (replyPtr->error() == QNetworkReply::OperationCanceledError) {
                 errorMsg = QString("请求超时（%1秒），请检查网络连接或增加超时时间").arg(AIConfig::instance().getTimeout());
             }
-            QByteArray responseData = replyPtr->readAll();
+        } else if (!stream->parser.errorString().isEmpty()) {
+            errorMsg = stream->parser.errorString();
+        }
 
-            QFile logFile(logFileName);
-            if (logFile.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&logFile);
-                out.setCodec("UTF-8");
+        QFile logFile(logFileName);
+        if (logFile.open(QIODevice::Append | QIODevice::Text)) {
+            QTextStream out(&logFile);
+            out.setCodec("UTF-8");
+            if (errorMsg.isEmpty()) {
+                out << "\n=== AI Report Response ===" << "\n";
+            } else {
                 out << "\n=== AI Report Response (ERROR) ===" << "\n";
                 out << "Error Code: " << replyPtr->error() << "\n";
                 out << "Error: " << errorMsg << "\n";
-                out << "Response:\n" << responseData << "\n\n";
-                logFile.close();
-            }
-            
-            QMessageBox::warning(this, "错误", "AI生成失败：" + errorMsg);
-            return;
-        }
-        
-        QByteArray responseData = replyPtr->readAll();
-        
-        {
-            QFile logFile(logFileName);
-            if (logFile.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&logFile);
-                out.setCodec("UTF-8");
-                out << "\n=== AI Report Response ===" << "\n";
-                out << "Response:\n" << responseData << "\n\n";
-                logFile.close();
             }
+            out << "Response:\n" << stream->parser.rawData() << "\n\n";
+            logFile.close();
         }
-        
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        if (doc.isNull()) {
-            QMessageBox::warning(this, "错误", "AI响应解析失败");
+
+        if (!reportEditPtr) {
             return;
         }
-        
-        QJsonObject rootObj = doc.object();
-        
-        QString content;
-        
-        if (currentModel.startsWith("qwen")) {
-            if (rootObj.contains("output") && rootObj["output"].toObject().contains("choices")) {
-                QJsonArray choices = rootObj["output"].toObject()["choices"].toArray();
-                if (!choices.isEmpty()) {
-                    content = choices[0].toObject()["message"].toObject()["content"].toString();
-                }
-            }
-        } else {
-            QJsonObject choicesObj;
-            if (rootObj.contains("output") && rootObj["output"].toObject().contains("choices")) {
-                choicesObj = rootObj["output"].toObject()["choices"].toArray()[0].toObject();
-            } else if (rootObj.contains("choices")) {
-                choicesObj = rootObj["choices"].toArray()[0].toObject();
-            } else {
-                QMessageBox::warning(this, "错误", "AI返回内容格式错误");
-                return;
+        reportEditPtr->setReadOnly(false);
+
+        if (errorMsg.isEmpty()) {
+            appendContent(rest);
+            if (stream->parser.text().trimmed().isEmpty()) {
+                errorMsg = stream->parser.hasPayload() ? "AI返回内容为空" : "AI响应解析失败";
             }
-            
-            content = choicesObj["message"].toObject()["content"].toString();
         }
-        
-        if (content.isEmpty()) {
-            QMessageBox::warning(this, "错误", "AI返回内容为空");
-            return;
-        }
-        
-        QString currentReport = reportEdit->toPlainText();
-        QString updatedReport;
-        
-        if (reportType == "季报") {
-            int highlightsPos = currentReport.indexOf("## 四、季度工作亮点");
-            if (highlightsPos > 0) {
-                int problemsPos = currentReport.indexOf("## 五、存在问题与改进");
-                if (problemsPos > highlightsPos) {
-                    QString beforeHighlights = currentReport.left(highlightsPos);
-                    QString afterProblems = currentReport.mid(problemsPos);
-                    updatedReport = beforeHighlights + "## 四、季度工作亮点\n\n" + content + "\n\n" + afterProblems;
-                }
-            }
-        } else if (reportType == "月报") {
-            int highlightsPos = currentReport.indexOf("## 三、月度工作亮点");
-            if (highlightsPos > 0) {
-                int problemsPos = currentReport.indexOf("## 四、存在问题与改进");
-                if (problemsPos > highlightsPos) {
-                    QString beforeHighlights = currentReport.left(highlightsPos);
-                    QString afterProblems = currentReport.mid(problemsPos);
-                    updatedReport = beforeHighlights + "## 三、月度工作亮点\n\n" + content + "\n\n" + afterProblems;
-                }
-            }
-        } else {
-            int highlightsPos = currentReport.indexOf("## 三、本周工作亮点");
-            if (highlightsPos > 0) {
-                int problemsPos = currentReport.indexOf("## 四、存在问题与改进");
-                if (problemsPos > highlightsPos) {
-                    QString beforeHighlights = currentReport.left(highlightsPos);
-                    QString afterProblems = currentReport.mid(problemsPos);
-                    updatedReport = beforeHighlights + "## 三、本周工作亮点\n\n" + content + "\n\n" + afterProblems;
-                }
+
+        if (!errorMsg.isEmpty()) {
+            // 失败时去掉已写入的部分内容，恢复原报告
+            if (stream->insertPos >= 0) {
+                reportEditPtr->setPlainText(originalReport);
             }
+            logOperation("ai_generate_report", QString("报告类型: %1, 生成失败: %2").arg(reportType).arg(errorMsg));
+            QMessageBox::warning(this, "错误", "AI生成失败：" + errorMsg);
+            return;
         }
-        
-        if (!updatedReport.isEmpty()) {
-            reportEdit->setPlainText(updatedReport);
-            logOperation("ai_generate_report", QString("报告类型: %1, 成功生成AI分析内容").arg(reportType));
-            QMessageBox::information(this, "成功", "AI报告分析已生成，您可以在此基础上进行编辑修改");
-        } else {
-            logOperation("ai_generate_report", QString("报告类型: %1, 插入内容失败").arg(reportType));
-            QMessageBox::warning(this, "警告", "无法将AI内容插入报告，请手动编辑");
-        }
-        
-        replyPtr->deleteLater();
+
+        logOperation("ai_generate_report", QString("报告类型: %1, 成功生成AI分析内容").arg(reportType));
+        QMessageBox::information(this, "成功", "AI报告分析已生成，您可以在此基础上进行编辑修改");
     });
 }
 
@@ -2959,7 +2736,7 @@ void WorkLogWidget::analyzeTaskWithAI(const QString &model, const QString &title
 
     QJsonObject json;
     json["model"] = modelName;
-    json["stream"] = false;
+    json["stream"] = true;
     
     QJsonArray messages;
     QJsonObject msg;
@@ -2981,7 +2758,8 @@ void WorkLogWidget::analyzeTaskWithAI(const QString &model, const QString &title
         json["parameters"] = QJsonObject({
             {"temperature", 0.7},
             {"max_tokens", 1024},
-            {"result_format", "message"}
+            {"result_format", "message"},
+            {"incremental_output", true}
         });
     }
 
@@ -3011,10 +2789,17 @@ void WorkLogWidget::analyzeTaskWithAI(const QString &model, const QString &title
     request.setUrl(QUrl(endpoint));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", QString("Bearer %1").arg(keyConfig.apiKey).toUtf8());
+    if (currentModel.startsWith("qwen")) {
+        // DashScope 原生接口通过请求头开启 SSE
+        request.setRawHeader("X-DashScope-SSE", "enable");
+    }
 
     QNetworkReply *reply = networkManager->post(request, postData);
     QPointer<QNetworkReply> replyPtr(reply);
+    QSharedPointer<AIStreamParser> parser(new AIStreamParser);
+    QPointer<QLabel> aiStatusLabelPtr(aiStatusLabel);
 
+    // 超时按两次收到数据之间的间隔计算
     QTimer *timeoutTimer = new QTimer(this);
     timeoutTimer->setSingleShot(true);
     timeoutTimer->setInterval(AIConfig::instance().getTimeout() * 1000);
@@ -3024,15 +2809,27 @@ void WorkLogWidget::analyzeTaskWithAI(const QString &model, const QString &title
             replyPtr->abort();
         }
     });
+    timeoutTimer->start();
 
-    connect(reply, &QNetworkReply::finished, this, [this, replyPtr, title, titleEdit, descEdit, categoryCombo, priorityCombo, durationSpin, aiStatusLabel, aiBtn, logFileName, tagsEdit, timeoutTimer]() {
+    // 结果是 JSON，要完整收到后才能填充表单，生成过程中显示已收到的字数
+    connect(reply, &QNetworkReply::readyRead, this, [replyPtr, parser, aiStatusLabelPtr, timeoutTimer]() {
+        if (!replyPtr) {
+            return;
+        }
+        timeoutTimer->start();
+        if (!parser->feed(replyPtr->readAll()).isEmpty() && aiStatusLabelPtr) {
+            aiStatusLabelPtr->setText(QString("🤖 AI分析中...（%1字）").arg(parser->text().length()));
+        }
+    });
+
+    connect(reply, &QNetworkReply::finished, this, [this, replyPtr, parser, title, titleEdit, descEdit, categoryCombo, priorityCombo, durationSpin, aiStatusLabel, aiBtn, logFileName, tagsEdit, timeoutTimer]() {
         if (timeoutTimer) {
             timeoutTimer->stop();
             timeoutTimer->deleteLater();
         }
 
         if (replyPtr) {
-            handleAIResponse(replyPtr, title, titleEdit, descEdit, categoryCombo, priorityCombo, durationSpin, aiStatusLabel, aiBtn, logFileName, tagsEdit);
+            handleAIResponse(replyPtr, title, titleEdit, descEdit, categoryCombo, priorityCombo, durationSpin, aiStatusLabel, aiBtn, parser.data(), logFileName, tagsEdit);
         }
     });
 }
@@ -3193,15 +2990,21 @@ void WorkLogWidget::loadAIKeysToComboBox(QComboBox *comboBox)
 void WorkLogWidget::handleAIResponse(QPointer<QNetworkReply> reply, const QString &title, QLineEdit *titleEdit, 
                                       QTextEdit *descEdit, QComboBox *categoryCombo, QComboBox *priorityCombo,
                                       QDoubleSpinBox *durationSpin, QLabel *aiStatusLabel, QPushButton *aiBtn,
-                                      const QString &logFileName, QLineEdit *tagsEdit)
+                                      AIStreamParser *parser, const QString &logFileName, QLineEdit *tagsEdit)
 {
     if (!reply) {
         return;
     }
+    reply->deleteLater();
     
     if (aiBtn) {
         aiBtn->setEnabled(true);
     }
+
+    if (reply->bytesAvailable() > 0) {
+        parser->feed(reply->readAll());
+    }
+    parser->finish();
     
     if (reply->error() != QNetworkReply::NoError) {
         QString errorMsg = reply->errorString();
@@ -3232,7 +3035,7 @@ void WorkLogWidget::handleAIResponse(QPointer<QNetworkReply> reply, const QStrin
         return;
     }
     
-    QByteArray responseData = reply->readAll();
+    QByteArray responseData = parser->rawData();
     qDebug() << "AI Response:" << responseData;
     
     QFile logFile(logFileName);
@@ -3243,14 +3046,12 @@ void WorkLogWidget::handleAIResponse(QPointer<QNetworkReply> reply, const QStrin
         out << "Time: " << QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") << "\n";
         out << "HTTP Status: " << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() << "\n";
         out << "Response Data:\n" << responseData << "\n";
-        out << "Response JSON:\n" << QJsonDocument::fromJson(responseData).toJson(QJsonDocument::Indented) << "\n";
+        out << "Content:\n" << parser->text() << "\n";
         out << "\n========================================\n\n";
         logFile.close();
     }
     
-    QJsonDocument doc = QJsonDocument::fromJson(responseData);
-    
-    if (doc.isNull()) {
+    if (!parser->hasPayload()) {
         if (aiStatusLabel) {
             aiStatusLabel->setText("⚠️ 解析失败");
         }
@@ -3258,36 +3059,17 @@ void WorkLogWidget::handleAIResponse(QPointer<QNetworkReply> reply, const QStrin
         return;
     }
     
-    QJsonObject rootObj = doc.object();
-    
-    if (rootObj.contains("base_resp")) {
-        int statusCode = rootObj["base_resp"].toObject()["status_code"].toInt();
-        if (statusCode != 0) {
-            QString errorMsg = rootObj["base_resp"].toObject()["status_msg"].toString();
-            if (aiStatusLabel) {
-                aiStatusLabel->setText("❌ API错误: " + errorMsg);
-            }
-            qDebug() << "AI API Error:" << errorMsg;
-            analyzeWithLocalAI(title, titleEdit, descEdit, categoryCombo, priorityCombo, durationSpin, aiStatusLabel, tagsEdit);
-            return;
-        }
-    }
-    
-    QJsonObject choicesObj;
-    
-    if (rootObj.contains("output") && rootObj["output"].toObject().contains("choices")) {
-        choicesObj = rootObj["output"].toObject()["choices"].toArray()[0].toObject();
-    } else if (rootObj.contains("choices")) {
-        choicesObj = rootObj["choices"].toArray()[0].toObject();
-    } else {
+    if (!parser->errorString().isEmpty()) {
+        QString errorMsg = parser->errorString();
         if (aiStatusLabel) {
-            aiStatusLabel->setText("⚠️ 无返回内容");
+            aiStatusLabel->setText("❌ API错误: " + errorMsg);
         }
+        qDebug() << "AI API Error:" << errorMsg;
         analyzeWithLocalAI(title, titleEdit, descEdit, categoryCombo, priorityCombo, durationSpin, aiStatusLabel, tagsEdit);
         return;
     }
     
-    QString content = choicesObj["message"].toObject()["content"].toString();
+    QString content = parser->text();
     
     if (content.isEmpty()) {
         if (aiStatusLabel) {
@@ -3307,8 +3089,6 @@ void WorkLogWidget::handleAIResponse(QPointer<QNetworkReply> reply, const QStrin
             }
         });
     }
-    
-    reply->deleteLater();
 }
 
 void WorkLogWidget::analyzeWithLocalAI(const QString &title, QLineEdit *titleEdit, QTextEdit *descEdit,
@@ -3625,241 +3405,68 @@ void WorkLogWidget::onToday()
     }
 }
 
-bool WorkLogWidget::exportToText(const QString &content, const QString &fileName)
+// 排版和写文件在 ReportExporter 线程中进行，界面只显示进度，可随时取消
+void WorkLogWidget::exportReport(const QString &content, const QString &fileName,
+                                 ReportExporter::Format format, bool openWhenDone, QWidget *dialogParent)
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox::warning(this, "错误", "无法保存文件");
-        return false;
+    bool formatted = format == ReportExporter::Pdf || format == ReportExporter::Word;
+    if (formatted && !checkPermission("export_report")) {
+        QMessageBox::warning(this, "权限不足", "您没有导出报告的权限");
+        return;
     }
 
-    QByteArray utf8Data = content.toUtf8();
-    file.write(utf8Data);
-    file.close();
+    QWidget *parent = dialogParent ? dialogParent : this;
+    QPointer<QWidget> parentPtr(parent);
 
-    QMessageBox::information(this, "成功", "报告已成功导出");
-    return true;
-}
+    ReportExporter *exporter = new ReportExporter(content, fileName, format, this);
 
-bool WorkLogWidget::exportToPDF(const QString &content, const QString &fileName)
-{
-    if (!checkPermission("export_report")) {
-        QMessageBox::warning(this, "权限不足", "您没有导出报告的权限");
-        return false;
-    }
-    
-    QTextDocument document;
-    document.setMarkdown(content);
-    
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(fileName);
-    printer.setPageSize(QPageSize(QPageSize::A4));
-    printer.setPageMargins(QMarginsF(20, 20, 20, 20), QPageLayout::Millimeter);
-    
-    document.print(&printer);
-    
-    logOperation("export_report", QString("格式: PDF, 文件: %1").arg(fileName));
-    QMessageBox::information(this, "成功", "报告已成功导出为PDF");
-    return true;
-}
+    QProgressDialog *progressDialog = new QProgressDialog("正在导出报告...", "取消", 0, 100, parent);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setAttribute(Qt::WA_DeleteOnClose);
+    progressDialog->setMinimumDuration(300);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+    QPointer<QProgressDialog> progressDialogPtr(progressDialog);
 
-bool WorkLogWidget::exportToWord(const QString &content, const QString &fileName)
-{
-    if (!checkPermission("export_report")) {
-        QMessageBox::warning(this, "权限不足", "您没有导出报告的权限");
-        return false;
-    }
-    
-    QAxObject *word = nullptr;
-    QAxObject *documents = nullptr;
-    QAxObject *document = nullptr;
-    QAxObject *selection = nullptr;
-    
-    try {
-        word = new QAxObject("Word.Application", this);
-        if (!word->isNull()) {
-            word->setProperty("Visible", false);
-            
-            documents = word->querySubObject("Documents");
-            if (documents) {
-                document = documents->querySubObject("Add()");
-                if (document) {
-                    selection = word->querySubObject("Selection");
-                    if (selection) {
-                        QTextDocument textDoc;
-                        textDoc.setMarkdown(content);
-                        QTextCursor cursor(&textDoc);
-                        
-                        QAxObject *font = selection->querySubObject("Font");
-                        if (font) {
-                            font->setProperty("Name", "Microsoft YaHei");
-                            font->setProperty("Size", 12);
-                            font->setProperty("NameFarEast", "Microsoft YaHei");
-                        }
-                        
-                        for (QTextBlock block = textDoc.begin(); block != textDoc.end(); block = block.next()) {
-                            QTextBlockFormat blockFormat = block.blockFormat();
-                            QTextCharFormat charFormat = block.charFormat();
-                            
-                            if (block.text().startsWith("## ")) {
-                                selection->querySubObject("ParagraphFormat")->setProperty("Alignment", 0);
-                                QAxObject *headingFont = selection->querySubObject("Font");
-                                if (headingFont) {
-                                    headingFont->setProperty("Size", 16);
-                                    headingFont->setProperty("Bold", true);
-                                }
-                                selection->dynamicCall("TypeText(const QString&)", block.text().mid(3));
-                                selection->dynamicCall("TypeParagraph()");
-                                QAxObject *normalFont = selection->querySubObject("Font");
-                                if (normalFont) {
-                                    normalFont->setProperty("Size", 12);
-                                    normalFont->setProperty("Bold", false);
-                                }
-                            } else if (block.text().startsWith("### ")) {
-                                selection->querySubObject("ParagraphFormat")->setProperty("Alignment", 0);
-                                QAxObject *subHeadingFont = selection->querySubObject("Font");
-                                if (subHeadingFont) {
-                                    subHeadingFont->setProperty("Size", 14);
-                                    subHeadingFont->setProperty("Bold", true);
-                                }
-                                selection->dynamicCall("TypeText(const QString&)", block.text().mid(4));
-                                selection->dynamicCall("TypeParagraph()");
-                                QAxObject *normalFont = selection->querySubObject("Font");
-                                if (normalFont) {
-                                    normalFont->setProperty("Size", 12);
-                                    normalFont->setProperty("Bold", false);
-                                }
-                            } else if (block.text().startsWith("# ")) {
-                                selection->querySubObject("ParagraphFormat")->setProperty("Alignment", 1);
-                                QAxObject *titleFont = selection->querySubObject("Font");
-                                if (titleFont) {
-                                    titleFont->setProperty("Size", 18);
-                                    titleFont->setProperty("Bold", true);
-                                }
-                                selection->dynamicCall("TypeText(const QString&)", block.text().mid(2));
-                                selection->dynamicCall("TypeParagraph()");
-                                QAxObject *normalFont = selection->querySubObject("Font");
-                                if (normalFont) {
-                                    normalFont->setProperty("Size", 12);
-                                    normalFont->setProperty("Bold", false);
-                                }
-                            } else if (block.text().startsWith("- ") || block.text().startsWith("* ")) {
-                                selection->querySubObject("ParagraphFormat")->setProperty("Alignment", 0);
-                                selection->dynamicCall("TypeText(const QString&)", "• " + block.text().mid(2));
-                                selection->dynamicCall("TypeParagraph()");
-                            } else if (!block.text().isEmpty()) {
-                                selection->querySubObject("ParagraphFormat")->setProperty("Alignment", 0);
-                                selection->dynamicCall("TypeText(const QString&)", block.text());
-                                selection->dynamicCall("TypeParagraph()");
-                            }
-                        }
-                        
-                        document->dynamicCall("SaveAs(const QString&, int)", fileName, 16);
-                        
-                        document->dynamicCall("Close(bool)", false);
-                        word->dynamicCall("Quit()");
-                        
-                        logOperation("export_report", QString("格式: Word, 文件: %1").arg(fileName));
-                        QMessageBox::information(this, "成功", "报告已成功导出为Word");
-                        return true;
-                    }
-                }
-            }
-        }
-        
-        if (document) {
-            document->dynamicCall("Close(bool)", false);
-        }
-        if (word) {
-            word->dynamicCall("Quit()");
-        }
-        
-        QMessageBox::warning(this, "错误", "无法创建Word文档，请确保已安装Microsoft Word");
-        return false;
-        
-    } catch (...) {
-        if (document) {
-            document->dynamicCall("Close(bool)", false);
-        }
-        if (word) {
-            word->dynamicCall("Quit()");
+    connect(progressDialog, &QProgressDialog::canceled, exporter, &ReportExporter::cancel);
+    connect(exporter, &ReportExporter::progress, progressDialog, &QProgressDialog::setValue);
+    connect(exporter, &ReportExporter::exportFinished, this,
+            [this, exporter, progressDialogPtr, parentPtr, fileName, format, openWhenDone](bool ok, const QString &error) {
+        if (progressDialogPtr) {
+            // 关闭进度框会发出 canceled，先断开，否则已结束的导出会被当作取消，错误提示不再显示
+            disconnect(progressDialogPtr.data(), &QProgressDialog::canceled, exporter, &ReportExporter::cancel);
+            progressDialogPtr->close();
         }
-        
-        QMessageBox::warning(this, "错误", "导出Word文档时发生错误");
-        return false;
-    }
-}
-
-QString WorkLogWidget::markdownToHTML(const QString &markdown)
-{
-    QString html = markdown;
-    
-    html.replace(QRegularExpression("^# (.+)$"), "<h1>\\1</h1>");
-    html.replace(QRegularExpression("^## (.+)$"), "<h2>\\1</h2>");
-    html.replace(QRegularExpression("^### (.+)$"), "<h3>\\1</h3>");
-    html.replace(QRegularExpression("^#### (.+)$"), "<h4>\\1</h4>");
-    
-    html.replace(QRegularExpression("\\*\\*(.+?)\\*\\*"), "<strong>\\1</strong>");
-    html.replace(QRegularExpression("\\*(.+?)\\*"), "<em>\\1</em>");
-    
-    html.replace(QRegularExpression("^- (.+)$"), "<li>\\1</li>");
-    html.replace(QRegularExpression("^\\d+\\. (.+)$"), "<li>\\1</li>");
-    
-    html.replace(QRegularExpression("```"), "<pre>");
-    
-    html.replace(QRegularExpression("\n\n"), "</p><p>");
-    html.prepend("<p>");
-    html.append("</p>");
-    
-    html.replace(QRegularExpression("<p>(<h[1-6]>)"), "\\1");
-    html.replace(QRegularExpression("(</h[1-6]>)</p>"), "\\1");
-    html.replace(QRegularExpression("<p>(<li>)"), "<ul>\\1");
-    html.replace(QRegularExpression("(</li>)</p>"), "\\1</ul>");
-    
-    html.replace(QRegularExpression("<p></p>"), "");
-    html.replace(QRegularExpression("<ul></ul>"), "");
-    
-    html.replace("\n", "<br>");
-    
-    return html;
-}
+        QWidget *messageParent = parentPtr ? parentPtr.data() : this;
 
-QString WorkLogWidget::getCachedReport(const QString &cacheKey)
-{
-    if (reportCache.contains(cacheKey) && isCacheValid(cacheKey)) {
-        return reportCache[cacheKey];
-    }
-    return QString();
-}
+        if (ok) {
+            QString formatName;
+            switch (format) {
+                case ReportExporter::Pdf: formatName = "PDF"; break;
+                case ReportExporter::Word: formatName = "Word"; break;
+                default: break;
+            }
+            if (!formatName.isEmpty()) {
+                logOperation("export_report", QString("格式: %1, 文件: %2").arg(formatName).arg(fileName));
+                QMessageBox::information(messageParent, "成功", QString("报告已成功导出为%1").arg(formatName));
+            } else {
+                QMessageBox::information(messageParent, "成功", "报告已成功导出");
+            }
+            if (openWhenDone) {
+                QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
+            }
+        } else if (!exporter->isCanceled()) {
+            QMessageBox::warning(messageParent, "错误", error.isEmpty() ? QString("导出报告时发生错误") : error);
+        }
+    });
+    connect(exporter, &QThread::finished, exporter, &QObject::deleteLater);
 
-void WorkLogWidget::cacheReport(const QString &cacheKey, const QString &report)
-{
-    reportCache[cacheKey] = report;
-    lastCacheUpdate = QDateTime::currentDateTime();
+    exporter->start();
 }
 
-bool WorkLogWidget::isCacheValid(const QString &cacheKey, int maxAgeMinutes)
-{
-    if (!reportCache.contains(cacheKey)) {
-        return false;
-    }
-    
-    if (lastCacheUpdate.isNull()) {
-        return false;
-    }
-    
-    QDateTime now = QDateTime::currentDateTime();
-    qint64 secondsDiff = lastCacheUpdate.secsTo(now);
-    qint64 minutesDiff = secondsDiff / 60;
-    
-    return minutesDiff < maxAgeMinutes;
-}
-
-void WorkLogWidget::clearReportCache()
+QString WorkLogWidget::markdownToHTML(const QString &markdown)
 {
-    reportCache.clear();
-    lastCacheUpdate = QDateTime();
+    return ReportExporter::markdownToHtml(markdown);
 }
 
 void WorkLogWidget::logOperation(const QString &operation, const QString &details)
@@ -3964,6 +3571,7 @@ CalendarWidget::CalendarWidget(QWidget *parent)
     , m_scaleAnimation(nullptr)
     , m_taskPopup(nullptr)
     , m_taskPopupLabel(nullptr)
+    , m_staticCacheValid(false)
 {
     m_currentMonth = QDate::currentDate();
     m_selectedDate = QDate::currentDate();
@@ -4013,46 +3621,52 @@ qreal CalendarWidget::hoverScaleProperty() const
 void CalendarWidget::setHoverScaleProperty(qreal value)
 {
     m_hoverScale = value;
-    update();
+    // 动画只影响悬停的格子
+    if (m_hoveredRow >= 0) {
+        update(cellRect(m_hoveredRow, m_hoveredCol));
+    }
 }
 
 void CalendarWidget::setMonth(const QDate &date)
 {
-    m_currentMonth = QDate(date.year(), date.month(), 1);
+    QDate month(date.year(), date.month(), 1);
+    if (month == m_currentMonth && !m_cells.isEmpty()) {
+        return;
+    }
+    m_currentMonth = month;
     updateCells();
-    update();
+    invalidateStaticCache();
 }
 
 void CalendarWidget::setSelectedDate(const QDate &date)
 {
     m_selectedDate = date;
-    update();
+    invalidateStaticCache();
 }
 
-void CalendarWidget::setTaskInfos(const QMap<QDate, QVector<QPair<QString, QPair<TaskStatus, double>>>> &tasks)
+void CalendarWidget::setTaskInfos(const CalendarTaskMap &tasks)
 {
     m_taskInfos.clear();
     // 将任务信息转换为日期矩阵格式
     updateCells();
 
-    // 为每个日期设置任务信息
-    for (auto it = tasks.constBegin(); it != tasks.constEnd(); ++ it) {
-        QDate date = it.key();
+    // 格子按日期顺序排列，直接由日期算出所在的格子
+    QDate firstDate = m_cells[0][0].date;
+    QDate lastDate = m_cells[5][6].date;
+    for (auto it = tasks.lowerBound(firstDate); it != tasks.constEnd() && it.key() <= lastDate; ++it) {
         const QVector<QPair<QString, QPair<TaskStatus, double>>> &taskList = it.value();
-
-        // 找到对应的单元格并设置信息
-        for (int row = 0; row < m_cells.size(); ++row) {
-            for (int col = 0; col < m_cells[row].size(); ++col) {
-                if (m_cells[row][col].date == date && !taskList.isEmpty()) {
-                    m_cells[row][col].taskCount = taskList.size();
-                    m_cells[row][col].firstTaskStatus = taskList.first().second.first;
-                    m_cells[row][col].firstTaskTitle = taskList.first().first;
-                    m_cells[row][col].allTasks = taskList;  // 保存所有任务
-                }
-            }
+        if (taskList.isEmpty()) {
+            continue;
         }
+
+        int offset = static_cast<int>(firstDate.daysTo(it.key()));
+        DayCell &cell = m_cells[offset / 7][offset % 7];
+        cell.taskCount = taskList.size();
+        cell.firstTaskStatus = taskList.first().second.first;
+        cell.firstTaskTitle = taskList.first().first;
+        cell.allTasks = taskList;  // 保存所有任务
     }
-    update();
+    invalidateStaticCache();
 }
 
 void CalendarWidget::updateCells()
@@ -4067,11 +3681,6 @@ void CalendarWidget::updateCells()
     // 获取日历第一个日期（可能来自上月）
     QDate firstDate = m_currentMonth.addDays(-firstDayOfWeek);
 
-    // 获取下月的开始几天
-    int daysInMonth = m_currentMonth.daysInMonth();
-    int totalCells = 42; // 6行 x 7列
-    int nextMonthDay = 1;
-
     for (int i = 0; i < 6; ++i) {
         m_cells[i].resize(7);
         for (int j = 0; j < 7; ++j) {
@@ -4104,14 +3713,53 @@ int CalendarWidget::cellHeight() const
     return (height() - 30) / 6;
 }
 
+QRect CalendarWidget::cellRect(int row, int col) const
+{
+    int w = cellWidth();
+    int h = cellHeight();
+    return QRect(col * w, 30 + row * h, w, h);
+}
+
+void CalendarWidget::invalidateStaticCache()
+{
+    m_staticCacheValid = false;
+    update();
+}
+
 void CalendarWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
     QPainter painter(this);
+
+    // 尺寸、设备像素比或当天日期变化时重建静态内容缓存
+    QDate today = QDate::currentDate();
+    qreal ratio = devicePixelRatioF();
+    QSize cacheSize = size() * ratio;
+    if (!m_staticCacheValid || m_staticCache.size() != cacheSize || m_staticCacheDay != today) {
+        m_staticCache = QPixmap(cacheSize);
+        m_staticCache.setDevicePixelRatio(ratio);
+        m_staticCache.fill(Qt::white);
+        QPainter cachePainter(&m_staticCache);
+        drawCalendar(cachePainter);
+        m_staticCacheValid = true;
+        m_staticCacheDay = today;
+    }
+
+    // 绘制区域已被裁剪为需要更新的部分
+    painter.drawPixmap(0, 0, m_staticCache);
+
+    // 悬停的格子在白底上重新绘制
+    if (m_hoveredRow >= 0 && m_hoveredCol >= 0) {
+        painter.fillRect(cellRect(m_hoveredRow, m_hoveredCol), QColor("#FFFFFF"));
+        drawCell(painter, m_hoveredRow, m_hoveredCol, true, today);
+    }
+}
+
+void CalendarWidget::drawCalendar(QPainter &painter)
+{
     painter.setRenderHint(QPainter::Antialiasing);
 
     int w = cellWidth();
-    int h = cellHeight();
 
     // 绘制外边框和背景 - 强制白色背景
     QRect outerRect = rect();
@@ -4141,146 +3789,159 @@ void CalendarWidget::paintEvent(QPaintEvent *event)
         painter.drawText(weekRect, Qt::AlignCenter, weekDays[i]);
     }
 
-    // 绘制日期格子
+    // 绘制日期格子（不含悬停效果）
     QDate today = QDate::currentDate();  // 循环外获取今天日期
-    painter.setFont(QFont("Microsoft YaHei", 10));
-    painter.setBrush(QBrush());  // 重置画刷，避免继承星期标题的渐变
     for (int i = 0; i < 6; ++i) {
         for (int j = 0; j < 7; ++j) {
-            QRect cellRect(j * w + 1, 30 + i * h + 1, w - 2, h - 2);
-            const DayCell &cell = m_cells[i][j];
-
-            // 背景色 - 使用明确的条件判断
-            QColor bgColor;
-            QColor textColor;
-            QColor borderColor = QColor("#E8E8E8");
-
-            // 先设置默认白色背景
-            bgColor = QColor("#FFFFFF");
-            textColor = QColor("#2C3E50");
-
-            // 选中日期 - 蓝色渐变（优先）
-            bool isSelected = (cell.isCurrentMonth && cell.date == m_selectedDate);
-            if (isSelected) {
-                QLinearGradient selectedGradient(cellRect.topLeft(), cellRect.bottomRight());
-                selectedGradient.setColorAt(0, QColor("#5DADE2"));
-                selectedGradient.setColorAt(1, QColor("#3498DB"));
-                painter.setBrush(selectedGradient);
-                painter.setPen(Qt::NoPen);
-                painter.drawRoundedRect(cellRect, 6, 6);
-                painter.setBrush(QBrush());
-                textColor = QColor("#FFFFFF");
-            }
-            // 今日之前 - 薄荷绿（仅当未选中时）
-            else if (cell.isCurrentMonth && cell.date < today) {
-                bgColor = QColor("#E8F8F5");
-                textColor = QColor("#1D8348");
-                painter.fillRect(cellRect, bgColor);
-            }
-            // 今日之后 - 浅蓝色（仅当未选中时）
-            else if (cell.isCurrentMonth && cell.date > today) {
-                bgColor = QColor("#EBF5FB");
-                textColor = QColor("#2874A6");
-                painter.fillRect(cellRect, bgColor);
-            }
-            // 今天 - 浅蓝色（仅当未选中时）
-            else if (cell.isCurrentMonth && cell.date == today) {
-                bgColor = QColor("#D4E6F1");
-                textColor = QColor("#1A5276");
-                painter.fillRect(cellRect, bgColor);
-            }
-            // 非本月日期 - 浅灰色
-            else if (!cell.isCurrentMonth) {
-                bgColor = QColor("#F4F6F6");
-                textColor = QColor("#BDC3C7");
-                painter.fillRect(cellRect, bgColor);
-            }
-
-            // 绘制网格线（选中日期跳过，避免覆盖圆角效果）
-            if (!isSelected) {
-                painter.setPen(borderColor);
-                painter.drawRect(cellRect);
-            }
-
-            // 绘制悬停效果 - 在选中状态和悬停状态不同时绘制
-            bool isHovered = (i == m_hoveredRow && j == m_hoveredCol);
-            if (isHovered && !isSelected) {
-                // 悬停时绘制金色边框和浅黄色背景
-                painter.setPen(QColor("#F39C12"));  // 金色边框
-                painter.setBrush(QColor("#FEF9E7"));  // 浅黄色背景
-                painter.drawRect(cellRect);
-
-                // 绘制加粗的边框
-                QPen hoverPen(QColor("#E67E22"), 2);
-                painter.setPen(hoverPen);
-                painter.setBrush(QBrush());  // 重置画刷
-                painter.drawRect(cellRect.adjusted(1, 1, -1, -1));
-            }
-
-            // 绘制日期数字
-            painter.setFont(QFont("Microsoft YaHei", 10, QFont::Bold));
-            painter.setPen(textColor);
-
-            QRect dateRect = cellRect.adjusted(5, 3, -5, -3);
-            painter.drawText(dateRect, Qt::AlignTop | Qt::AlignLeft, QString::number(cell.date.day()));
-
-            // 绘制今日标记（橙色圆圈）- 未选中时显示
-            if (cell.isCurrentMonth && cell.date == today && cell.date != m_selectedDate) {
-                painter.setRenderHint(QPainter::Antialiasing);
-                painter.setPen(QColor("#F39C12"));  // 橙色
-                painter.setBrush(Qt::NoBrush);
-                painter.drawEllipse(cellRect.center().x() - 9, cellRect.top() + 3, 18, 18);
-            }
-
-            // 绘制任务信息
-            if (cell.isCurrentMonth && cell.taskCount > 0) {
-                // 任务状态颜色点（圆形）
-                QColor statusColor;
-                switch (cell.firstTaskStatus) {
-                    case TaskStatus_Completed: statusColor = QColor("#27AE60"); break;  // 绿色
-                    case TaskStatus_InProgress: statusColor = QColor("#3498DB"); break;  // 蓝色
-                    case TaskStatus_Paused: statusColor = QColor("#F39C12"); break;  // 橙色
-                    default: statusColor = QColor("#F39C12"); break;
-                }
+            drawCell(painter, i, j, false, today);
+        }
+    }
+}
 
-                painter.setRenderHint(QPainter::Antialiasing);
-                //painter.setBrush(statusColor);
-                painter.setPen(Qt::NoPen);
-                painter.drawEllipse(cellRect.left() + 6, cellRect.bottom() - 14, 6, 6);
+void CalendarWidget::drawCell(QPainter &painter, int row, int col, bool hovered, const QDate &today)
+{
+    if (row >= m_cells.size() || col >= m_cells[row].size()) {
+        return;
+    }
 
-                // 任务标题（截断）
-                QString title = cell.firstTaskTitle;
-                int maxChars = (cell.taskCount > 1) ? 6 : 8;
-                if (title.length() > maxChars) {
-                    title = title.left(maxChars) + "..";
-                }
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(QFont("Microsoft YaHei", 10));
+    painter.setBrush(QBrush());  // 重置画刷，避免继承星期标题的渐变
 
-                painter.setRenderHint(QPainter::Antialiasing, false);
-                painter.setFont(QFont("Microsoft YaHei", 8));
-                // 任务文字颜色
-                if (cell.isCurrentMonth && cell.date == m_selectedDate) {
-                    painter.setPen(QColor("#FFFFFF"));  // 选中时白色
-                } else if (cell.isCurrentMonth && cell.date == today) {
-                    painter.setPen(QColor("#1A5276"));  // 今天深蓝色
-                } else if (!cell.isCurrentMonth) {
-                    painter.setPen(QColor("#BDC3C7"));  // 跨月灰色
-                } else {
-                    painter.setPen(QColor("#2C3E50"));  // 普通日期深蓝灰
-                }
+    QRect cellRect = this->cellRect(row, col).adjusted(1, 1, -1, -1);
+    const DayCell &cell = m_cells[row][col];
+
+    // 背景色 - 使用明确的条件判断
+    QColor bgColor;
+    QColor textColor;
+    QColor borderColor = QColor("#E8E8E8");
+
+    // 先设置默认白色背景
+    bgColor = QColor("#FFFFFF");
+    textColor = QColor("#2C3E50");
+
+    // 选中日期 - 蓝色渐变（优先）
+    bool isSelected = (cell.isCurrentMonth && cell.date == m_selectedDate);
+    if (isSelected) {
+        QLinearGradient selectedGradient(cellRect.topLeft(), cellRect.bottomRight());
+        selectedGradient.setColorAt(0, QColor("#5DADE2"));
+        selectedGradient.setColorAt(1, QColor("#3498DB"));
+        painter.setBrush(selectedGradient);
+        painter.setPen(Qt::NoPen);
+        painter.drawRoundedRect(cellRect, 6, 6);
+        painter.setBrush(QBrush());
+        textColor = QColor("#FFFFFF");
+    }
+    // 今日之前 - 薄荷绿（仅当未选中时）
+    else if (cell.isCurrentMonth && cell.date < today) {
+        bgColor = QColor("#E8F8F5");
+        textColor = QColor("#1D8348");
+        painter.fillRect(cellRect, bgColor);
+    }
+    // 今日之后 - 浅蓝色（仅当未选中时）
+    else if (cell.isCurrentMonth && cell.date > today) {
+        bgColor = QColor("#EBF5FB");
+        textColor = QColor("#2874A6");
+        painter.fillRect(cellRect, bgColor);
+    }
+    // 今天 - 浅蓝色（仅当未选中时）
+    else if (cell.isCurrentMonth && cell.date == today) {
+        bgColor = QColor("#D4E6F1");
+        textColor = QColor("#1A5276");
+        painter.fillRect(cellRect, bgColor);
+    }
+    // 非本月日期 - 浅灰色
+    else if (!cell.isCurrentMonth) {
+        bgColor = QColor("#F4F6F6");
+        textColor = QColor("#BDC3C7");
+        painter.fillRect(cellRect, bgColor);
+    }
+
+    // 绘制网格线（选中日期跳过，避免覆盖圆角效果）
+    if (!isSelected) {
+        painter.setPen(borderColor);
+        painter.drawRect(cellRect);
+    }
+
+    // 绘制悬停效果 - 在选中状态和悬停状态不同时绘制
+    if (hovered && !isSelected) {
+        // 悬停时绘制金色边框和浅黄色背景
+        painter.setPen(QColor("#F39C12"));  // 金色边框
+        painter.setBrush(QColor("#FEF9E7"));  // 浅黄色背景
+        painter.drawRect(cellRect);
+
+        // 绘制加粗的边框
+        QPen hoverPen(QColor("#E67E22"), 2);
+        painter.setPen(hoverPen);
+        painter.setBrush(QBrush());  // 重置画刷
+        painter.drawRect(cellRect.adjusted(1, 1, -1, -1));
+    }
+
+    // 绘制日期数字
+    painter.setFont(QFont("Microsoft YaHei", 10, QFont::Bold));
+    painter.setPen(textColor);
+
+    QRect dateRect = cellRect.adjusted(5, 3, -5, -3);
+    painter.drawText(dateRect, Qt::AlignTop | Qt::AlignLeft, QString::number(cell.date.day()));
+
+    // 绘制今日标记（橙色圆圈）- 未选中时显示
+    if (cell.isCurrentMonth && cell.date == today && cell.date != m_selectedDate) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QColor("#F39C12"));  // 橙色
+        painter.setBrush(Qt::NoBrush);
+        painter.drawEllipse(cellRect.center().x() - 9, cellRect.top() + 3, 18, 18);
+    }
+
+    // 绘制任务信息
+    if (cell.isCurrentMonth && cell.taskCount > 0) {
+        // 任务状态颜色点（圆形）
+        QColor statusColor;
+        switch (cell.firstTaskStatus) {
+            case TaskStatus_Completed: statusColor = QColor("#27AE60"); break;  // 绿色
+            case TaskStatus_InProgress: statusColor = QColor("#3498DB"); break;  // 蓝色
+            case TaskStatus_Paused: statusColor = QColor("#F39C12"); break;  // 橙色
+            default: statusColor = QColor("#F39C12"); break;
+        }
+
+        painter.setRenderHint(QPainter::Antialiasing);
+        //painter.setBrush(statusColor);
+        painter.setPen(Qt::NoPen);
+        painter.drawEllipse(cellRect.left() + 6, cellRect.bottom() - 14, 6, 6);
+
+        // 任务标题（截断）
+        QString title = cell.firstTaskTitle;
+        int maxChars = (cell.taskCount > 1) ? 6 : 8;
+        if (title.length() > maxChars) {
+            title = title.left(maxChars) + "..";
+        }
+
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        painter.setFont(QFont("Microsoft YaHei", 8));
+        // 任务文字颜色
+        if (cell.isCurrentMonth && cell.date == m_selectedDate) {
+            painter.setPen(QColor("#FFFFFF"));  // 选中时白色
+        } else if (cell.isCurrentMonth && cell.date == today) {
+            painter.setPen(QColor("#1A5276"));  // 今天深蓝色
+        } else if (!cell.isCurrentMonth) {
+            painter.setPen(QColor("#BDC3C7"));  // 跨月灰色
+        } else {
+            painter.setPen(QColor("#2C3E50"));  // 普通日期深蓝灰
+        }
 
-                QRect taskRect(cellRect.left() + 14, cellRect.bottom() - 17, w - 20, 14);
-                painter.drawText(taskRect, Qt::AlignLeft | Qt::AlignVCenter, title);
+        QRect taskRect(cellRect.left() + 14, cellRect.bottom() - 17, cellRect.width() - 18, 14);
+        painter.drawText(taskRect, Qt::AlignLeft | Qt::AlignVCenter, title);
 
-                // 如果有更多任务，显示数量
-                if (cell.taskCount > 1) {
-                    QString moreText = QString("+%1").arg(cell.taskCount - 1);
-                    painter.setFont(QFont("Microsoft YaHei", 7));
-                    QRect moreRect(cellRect.right() - 28, cellRect.bottom() - 15, 24, 12);
-                    painter.drawText(moreRect, Qt::AlignRight | Qt::AlignVCenter, moreText);
-                }
-            }
+        // 如果有更多任务，显示数量
+        if (cell.taskCount > 1) {
+            QString moreText = QString("+%1").arg(cell.taskCount - 1);
+            painter.setFont(QFont("Microsoft YaHei", 7));
+            QRect moreRect(cellRect.right() - 28, cellRect.bottom() - 15, 24, 12);
+            painter.drawText(moreRect, Qt::AlignRight | Qt::AlignVCenter, moreText);
         }
     }
+
+    painter.restore();
 }
 
 void CalendarWidget::mousePressEvent(QMouseEvent *event)
@@ -4294,7 +3955,7 @@ void CalendarWidget::mousePressEvent(QMouseEvent *event)
 
         if (row >= 0 && row < 6 && col >= 0 && col < 7) {
             m_selectedDate = m_cells[row][col].date;
-            update();
+            invalidateStaticCache();
             emit dateSelected(m_selectedDate);
         }
     }
@@ -4312,7 +3973,7 @@ void CalendarWidget::mouseDoubleClickEvent(QMouseEvent *event)
 
         if (row >= 0 && row < 6 && col >= 0 && col < 7) {
             m_selectedDate = m_cells[row][col].date;
-            update();
+            invalidateStaticCache();
             emit dateDoubleClicked(m_selectedDate);
         }
     }
@@ -4337,9 +3998,11 @@ void CalendarWidget::leaveEvent(QEvent *event)
         m_scaleAnimation->start();
     }
 
+    if (m_hoveredRow >= 0) {
+        update(cellRect(m_hoveredRow, m_hoveredCol));
+    }
     m_hoveredRow = -1;
     m_hoveredCol = -1;
-    update();
 }
 
 void CalendarWidget::mouseMoveEvent(QMouseEvent *event)
@@ -4363,8 +4026,13 @@ void CalendarWidget::updateHoveredCell(const QPoint &pos)
             // 隐藏之前的弹出框
             hideTaskPopup();
 
+            // 只重绘离开和进入的两个格子
+            if (m_hoveredRow >= 0) {
+                update(cellRect(m_hoveredRow, m_hoveredCol));
+            }
             m_hoveredRow = row;
             m_hoveredCol = col;
+            update(cellRect(row, col));
 
             // 启动放大动画
             if (m_scaleAnimation) {
@@ -4389,6 +4057,7 @@ void CalendarWidget::updateHoveredCell(const QPoint &pos)
                 m_scaleAnimation->setEndValue(1.0);
                 m_scaleAnimation->start();
             }
+            update(cellRect(m_hoveredRow, m_hoveredCol));
         }
         m_hoveredRow = -1;
         m_hoveredCol = -1;
@@ -11,7 +11,7 @@
 #include <QStandardItemModel>
 #include <QItemDelegate>
 #include <QTextEdit>
-#include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
 #include <QListWidget>
 #include <QDateTimeEdit>
@@ -44,7 +44,11 @@
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
 #include "modules/core/database.h"
+#include "modules/core/reportengine.h"
+#include "modules/core/reportexporter.h"
+#include "modules/core/aistreamparser.h"
 #include "modules/user/userapi.h"
+#include "tasktablemodel.h"
 
 // 前向声明
 class CalendarWidget;
@@ -132,7 +136,12 @@ public:
 // 更新分类筛选下拉框显示文本（函数声明）
 void updateCategoryFilterText(QComboBox *comboBox, QStandardItemModel *model);
 
-// 自定义日历Widget - 5行7列显示
+// 日历中每天的任务 (标题, (状态, 工时))
+typedef QMap<QDate, QVector<QPair<QString, QPair<TaskStatus, double>>>> CalendarTaskMap;
+
+// 自定义日历Widget - 6行7列显示
+// 背景、星期标题和所有格子的静态内容绘制到缓存图中，只在月份、任务、选中日期、
+// 尺寸或当天日期变化时重绘；悬停只重绘进出的格子区域
 class CalendarWidget : public QWidget
 {
     Q_OBJECT
@@ -164,6 +173,9 @@ protected:
 
 private:
     void drawCalendar(QPainter &painter);
+    void drawCell(QPainter &painter, int row, int col, bool hovered, const QDate &today);
+    QRect cellRect(int row, int col) const;
+    void invalidateStaticCache();
     QDate m_currentMonth;
     QDate m_selectedDate;
     QVector<QVector<QDate>> m_days; // 5行7列的日期矩阵
@@ -179,6 +191,11 @@ private:
     };
     QVector<QVector<DayCell>> m_cells;
 
+    // 静态内容缓存
+    QPixmap m_staticCache;
+    bool m_staticCacheValid;
+    QDate m_staticCacheDay;     // 绘制缓存时的当天日期，跨天后重绘“今天”标记
+
     // 鼠标悬停相关
     int m_hoveredRow;
     int m_hoveredCol;
@@ -196,7 +213,7 @@ private:
     void updateCells();
 
 public:
-    void setTaskInfos(const QMap<QDate, QVector<QPair<QString, QPair<TaskStatus, double>>>> &tasks);
+    void setTaskInfos(const CalendarTaskMap &tasks);
 };
 
 // 工作日志主Widget
@@ -215,7 +232,7 @@ private slots:
     void onCompleteTask();
     void onPauseTask();
     void onTaskSelectionChanged();
-    void onTaskDoubleClicked(int row, int column);
+    void onTaskDoubleClicked(const QModelIndex &index);
     void onRefreshTasks();
     void onFilterChanged();
     void onGenerateReport();
@@ -249,6 +266,8 @@ private:
     void loadTasks();
     void refreshTaskTable();
     void refreshCalendarView();
+    const CalendarTaskMap &calendarTasksForMonth(const QDate &month);
+    void prefetchCalendarMonths();
     void updateStatistics();
     Task getCurrentTask();
     Category getCurrentCategory();
@@ -259,18 +278,11 @@ private:
     QString generateWeeklyReport(const QDateTime &startDate, const QDateTime &endDate);
     QString generateMonthlyReport(const QDateTime &startDate, const QDateTime &endDate);
     QString generateQuarterlyReport(const QDateTime &startDate, const QDateTime &endDate);
-    bool exportToMarkdown(const QString &content, const QString &fileName);
-    bool exportToText(const QString &content, const QString &fileName);
-    bool exportToPDF(const QString &content, const QString &fileName);
-    bool exportToWord(const QString &content, const QString &fileName);
+    void exportReport(const QString &content, const QString &fileName, ReportExporter::Format format,
+                      bool openWhenDone = false, QWidget *dialogParent = nullptr);
     QString markdownToHTML(const QString &markdown);
-    QString getCachedReport(const QString &cacheKey);
-    void cacheReport(const QString &cacheKey, const QString &report);
-    bool isCacheValid(const QString &cacheKey, int maxAgeMinutes = 30);
-    void clearReportCache();
     void logOperation(const QString &operation, const QString &details);
     bool checkPermission(const QString &permission);
-    void updateTaskRow(int row, const Task &task);
     void analyzeTaskWithAI(const QString &title, QLineEdit *titleEdit, QTextEdit *descEdit, 
                            QComboBox *categoryCombo, QComboBox *priorityCombo, QDoubleSpinBox *durationSpin,
                            QLabel *aiStatusLabel, QPushButton *aiBtn, QLineEdit *tagsEdit = nullptr);
@@ -284,7 +296,7 @@ private:
     QString getAIServiceKey();
     void handleAIResponse(QPointer<QNetworkReply> reply, const QString &title, QLineEdit *titleEdit, QTextEdit *descEdit,
                           QComboBox *categoryCombo, QComboBox *priorityCombo, QDoubleSpinBox *durationSpin,
-                          QLabel *aiStatusLabel, QPushButton *aiBtn, const QString &logFileName,
+                          QLabel *aiStatusLabel, QPushButton *aiBtn, AIStreamParser *parser, const QString &logFileName,
                           QLineEdit *tagsEdit = nullptr);
     void analyzeWithLocalAI(const QString &title, QLineEdit *titleEdit, QTextEdit *descEdit,
                              QComboBox *categoryCombo, QComboBox *priorityCombo, QDoubleSpinBox *durationSpin,
@@ -294,7 +306,9 @@ private:
                          QLineEdit *tagsEdit);
     QString generateReportWithAI(const QString &reportType, const QString &reportData);
     void onAIGenerateReport(QTextEdit *reportEdit, const QString &reportType, const QString &reportData);
-    void onAIGenerateReport(const QString &model, QTextEdit *reportEdit, const QString &reportType, const QString &reportData);
+    // busyWidgets 在生成结束前禁用，如生成和导出按钮
+    void onAIGenerateReport(const QString &model, QTextEdit *reportEdit, const QString &reportType, const QString &reportData,
+                            const QList<QWidget *> &busyWidgets = QList<QWidget *>());
     
     void setSettingsWidget(void *settings);
     QString getCurrentAIModel();
@@ -313,7 +327,9 @@ private:
     QWidget *leftPanel;
     QWidget *rightPanel;
 
-    QTableWidget *taskTable;
+    QTableView *taskTable;
+    TaskTableModel *taskModel;
+    TaskFilterProxyModel *taskProxy;
     QStackedWidget *viewStacker;
     QWidget *calendarViewContainer;
     CalendarWidget *calendarWidget;
@@ -386,15 +402,18 @@ private:
     // 当前日历月份
     QDate currentCalendarMonth;
 
+    // 按月缓存的日历任务，键为每月1日；任务变化时清空，显示某月后在空闲时预取前后两个月
+    QHash<QDate, CalendarTaskMap> calendarMonthCache;
+    bool calendarPrefetchPending;
+
     Task *currentRunningTask;
     QTimer *taskTimer;
     QDateTime taskStartTime;
     
     QNetworkAccessManager *networkManager;
     
-    // 报告缓存
-    QHash<QString, QString> reportCache;
-    QDateTime lastCacheUpdate;
+    // 报告统计数据（按天缓存，随任务修改失效）
+    ReportEngine *reportEngine;
 };
 
 #endif
@@ -144,6 +144,11 @@ db.serialize(() => {
 
 app.use('/admin', express.static(path.join(__dirname, 'admin-panel')));
 
+// 健康检查，客户端据此判断能否连到服务器，不需要登录
+app.get('/api/health', (req, res) => {
+    res.json({ success: true, time: new Date().toISOString() });
+});
+
 app.post('/api/admin/login', (req, res) => {
     const { username, password } = req.body;
     
@@ -760,6 +765,8 @@ app.delete('/api/admin/users/:id/configs', authenticateAdmin, (req, res) => {
                         return res.status(500).json({ success: false, message: '删除配置失败' });
                     }
 
+                    userDbConn.run(`DELETE FROM user_config_hashes WHERE key IN (${placeholders})`, configKeys);
+
                     db.run("INSERT INTO operation_logs (user_id, action, details, ip_address) VALUES (?, ?, ?, ?)",
                         [req.adminId, 'batch_delete_configs', `批量删除用户 ${user.username} 的 ${configKeys.length} 个配置`, req.ip]);
 
@@ -772,6 +779,8 @@ app.delete('/api/admin/users/:id/configs', authenticateAdmin, (req, res) => {
                     return res.status(500).json({ success: false, message: '删除配置失败' });
                 }
 
+                userDbConn.run("DELETE FROM user_config_hashes");
+
                 const deletedCount = this.changes;
 
                 db.run("INSERT INTO operation_logs (user_id, action, details, ip_address) VALUES (?, ?, ?, ?)",
@@ -807,6 +816,8 @@ app.delete('/api/admin/users/:id/config-profiles', authenticateAdmin, (req, res)
                         return res.status(500).json({ success: false, message: '删除设备配置失败' });
                     }
 
+                    userDbConn.run(`DELETE FROM user_config_profile_hashes WHERE config_name IN (${placeholders})`, profileNames);
+
                     db.run("INSERT INTO operation_logs (user_id, action, details, ip_address) VALUES (?, ?, ?, ?)",
                         [req.adminId, 'batch_delete_profiles', `批量删除用户 ${user.username} 的 ${profileNames.length} 个设备配置`, req.ip]);
 
@@ -819,6 +830,8 @@ app.delete('/api/admin/users/:id/config-profiles', authenticateAdmin, (req, res)
                     return res.status(500).json({ success: false, message: '删除设备配置失败' });
                 }
 
+                userDbConn.run("DELETE FROM user_config_profile_hashes");
+
                 const deletedCount = this.changes;
 
                 db.run("INSERT INTO operation_logs (user_id, action, details, ip_address) VALUES (?, ?, ?, ?)",
@@ -1129,29 +1142,57 @@ app.get('/api/config/get', authenticateToken, (req, res) => {
             }
         });
 
-        res.json({ success: true, configs: configObj });
+        // 附带各段的内容哈希，客户端据此判断哪些段无需再上传
+        userDbConn.all("SELECT key, hash FROM user_config_hashes", [], (err, rows) => {
+            const sectionHashes = {};
+            (rows || []).forEach(row => {
+                if (Object.prototype.hasOwnProperty.call(configObj, row.key)) {
+                    sectionHashes[row.key] = row.hash;
+                }
+            });
+            res.json({ success: true, configs: configObj, sectionHashes: sectionHashes });
+        });
     });
 });
 
 // 用户保存配置到默认配置（保持向后兼容）
+// sectionHashes 为各段的内容哈希（可选）：哈希与已保存的相同的段不再写入，在 notModified 中返回
 app.post('/api/config/save', authenticateToken, (req, res) => {
-    const { configs } = req.body;
+    const { configs, sectionHashes } = req.body;
 
     if (!configs) {
         return res.status(400).json({ success: false, error: '配置数据不能为空' });
     }
 
+    const hashes = (sectionHashes && typeof sectionHashes === 'object') ? sectionHashes : {};
+
     // 使用用户独立数据库
     const userDbConn = userDb.getUserDb(req.userId);
 
-    userDbConn.serialize(() => {
-        for (const [key, value] of Object.entries(configs)) {
-            const valueStr = typeof value === 'object' ? JSON.stringify(value) : String(value);
-            userDbConn.run(`INSERT OR REPLACE INTO user_configs (key, value, updated_at) VALUES (?, ?, CURRENT_TIMESTAMP)`,
-                [key, valueStr]);
-        }
+    userDbConn.all("SELECT key, hash FROM user_config_hashes", [], (err, rows) => {
+        const storedHashes = {};
+        (rows || []).forEach(row => { storedHashes[row.key] = row.hash; });
 
-        res.json({ success: true, message: '配置保存成功' });
+        const notModified = [];
+        userDbConn.serialize(() => {
+            for (const [key, value] of Object.entries(configs)) {
+                if (hashes[key] && storedHashes[key] === hashes[key]) {
+                    notModified.push(key);
+                    continue;
+                }
+
+                const valueStr = typeof value === 'object' ? JSON.stringify(value) : String(value);
+                userDbConn.run(`INSERT OR REPLACE INTO user_configs (key, value, updated_at) VALUES (?, ?, CURRENT_TIMESTAMP)`,
+                    [key, valueStr]);
+                if (hashes[key]) {
+                    userDbConn.run("INSERT OR REPLACE INTO user_config_hashes (key, hash) VALUES (?, ?)", [key, hashes[key]]);
+                } else {
+                    userDbConn.run("DELETE FROM user_config_hashes WHERE key = ?", [key]);
+                }
+            }
+
+            res.json({ success: true, message: '配置保存成功', notModified: notModified, sectionHashes: hashes });
+        });
     });
 });
 
@@ -1195,6 +1236,8 @@ app.post('/api/config/frpc/save', authenticateToken, (req, res) => {
             if (err) {
                 return res.status(500).json({ success: false, error: '保存FRPC配置失败' });
             }
+            // 内容已变化，旧的哈希作废
+            userDbConn.run("DELETE FROM user_config_hashes WHERE key = 'frpc'");
             res.json({ success: true, message: 'FRPC配置保存成功' });
         });
 });
@@ -1253,6 +1296,8 @@ app.post('/api/config/profiles', authenticateToken, (req, res) => {
                 return res.status(500).json({ success: false, error: '创建配置失败: ' + err.message });
             }
 
+            userDbConn.run("DELETE FROM user_config_profile_hashes WHERE config_name = ?", [config_name]);
+
             res.json({ success: true, message: '配置创建成功', config_name: config_name });
         });
 });
@@ -1270,12 +1315,22 @@ app.get('/api/config/profiles/:config_name', authenticateToken, (req, res) => {
             return res.status(404).json({ success: false, error: '配置不存在' });
         }
 
+        let configs;
         try {
-            const configs = JSON.parse(profile.configs);
-            res.json({ success: true, configs: configs, config_name: profile.config_name, created_at: profile.created_at, updated_at: profile.updated_at });
+            configs = JSON.parse(profile.configs);
         } catch (e) {
-            res.status(500).json({ success: false, error: '解析配置失败' });
+            return res.status(500).json({ success: false, error: '解析配置失败' });
         }
+
+        userDbConn.get("SELECT hashes FROM user_config_profile_hashes WHERE config_name = ?", [decodedName], (err, row) => {
+            let sectionHashes = {};
+            try {
+                sectionHashes = row ? JSON.parse(row.hashes) : {};
+            } catch (e) {
+                sectionHashes = {};
+            }
+            res.json({ success: true, configs: configs, sectionHashes: sectionHashes, config_name: profile.config_name, created_at: profile.created_at, updated_at: profile.updated_at });
+        });
     });
 });
 
@@ -1301,6 +1356,8 @@ app.put('/api/config/profiles/:config_name', authenticateToken, (req, res) => {
                 return res.status(500).json({ success: false, error: '更新配置失败' });
             }
 
+            userDbConn.run("DELETE FROM user_config_profile_hashes WHERE config_name = ?", [decodedName]);
+
             res.json({ success: true, message: '配置更新成功', config_name: decodedName });
         });
 });
@@ -1318,13 +1375,15 @@ app.delete('/api/config/profiles/:config_name', authenticateToken, (req, res) =>
             return res.status(500).json({ success: false, error: '删除配置失败' });
         }
 
+        userDbConn.run("DELETE FROM user_config_profile_hashes WHERE config_name = ?", [decodedName]);
+
         res.json({ success: true, message: '配置删除成功', config_name: decodedName });
     });
 });
 
 // 上传配置（兼容旧接口）
 app.post('/api/config/upload', authenticateToken, (req, res) => {
-    const { configs, config_name } = req.body;
+    const { configs, config_name, sectionHashes } = req.body;
 
     if (!configs) {
         return res.status(400).json({ success: false, error: '配置数据不能为空' });
@@ -1335,20 +1394,80 @@ app.post('/api/config/upload', authenticateToken, (req, res) => {
         return res.status(400).json({ success: false, error: '请指定配置名称（如：台式机、笔记本）' });
     }
 
-    const configsStr = JSON.stringify(configs);
-
     // 使用用户独立数据库
     const userDbConn = userDb.getUserDb(req.userId);
 
-    userDbConn.run(`INSERT OR REPLACE INTO user_config_profiles (config_name, configs, created_at, updated_at) VALUES (?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP)`,
-        [config_name, configsStr],
-        function(err) {
-            if (err) {
-                return res.status(500).json({ success: false, error: '上传配置失败: ' + err.message });
+    // 未附带 sectionHashes 的旧客户端：整体覆盖
+    if (!sectionHashes || typeof sectionHashes !== 'object') {
+        const configsStr = JSON.stringify(configs);
+        userDbConn.run(`INSERT OR REPLACE INTO user_config_profiles (config_name, configs, created_at, updated_at) VALUES (?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP)`,
+            [config_name, configsStr],
+            function(err) {
+                if (err) {
+                    return res.status(500).json({ success: false, error: '上传配置失败: ' + err.message });
+                }
+
+                userDbConn.run("DELETE FROM user_config_profile_hashes WHERE config_name = ?", [config_name]);
+                res.json({ success: true, message: '配置上传成功', config_name: config_name });
+            });
+        return;
+    }
+
+    // 分段上传：sectionHashes 列出备份应包含的全部段，configs 只含变化的段，
+    // 其余段沿用已保存的内容（哈希必须一致），缺失时返回 409 让客户端完整重传
+    userDbConn.get("SELECT configs FROM user_config_profiles WHERE config_name = ?", [config_name], (err, profile) => {
+        if (err) {
+            return res.status(500).json({ success: false, error: '上传配置失败: ' + err.message });
+        }
+
+        userDbConn.get("SELECT hashes FROM user_config_profile_hashes WHERE config_name = ?", [config_name], (err, row) => {
+            let existing = {};
+            let storedHashes = {};
+            try {
+                existing = profile ? JSON.parse(profile.configs) : {};
+                storedHashes = row ? JSON.parse(row.hashes) : {};
+            } catch (e) {
+                existing = {};
+                storedHashes = {};
             }
 
-            res.json({ success: true, message: '配置上传成功', config_name: config_name });
+            const merged = {};
+            const missingSections = [];
+            let modified = false;
+            for (const [key, hash] of Object.entries(sectionHashes)) {
+                if (Object.prototype.hasOwnProperty.call(configs, key)) {
+                    merged[key] = configs[key];
+                    modified = modified || storedHashes[key] !== hash;
+                } else if (storedHashes[key] === hash && Object.prototype.hasOwnProperty.call(existing, key)) {
+                    merged[key] = existing[key];
+                } else {
+                    missingSections.push(key);
+                }
+            }
+
+            if (missingSections.length > 0) {
+                return res.status(409).json({ success: false, error: '部分配置需要重新上传', missingSections: missingSections });
+            }
+
+            // 内容和段都没有变化，不必写入
+            const sameSections = Object.keys(existing).length === Object.keys(merged).length;
+            if (profile && !modified && sameSections) {
+                return res.json({ success: true, message: '配置未修改', config_name: config_name, notModified: true, sectionHashes: sectionHashes });
+            }
+
+            userDbConn.serialize(() => {
+                userDbConn.run(`INSERT OR REPLACE INTO user_config_profiles (config_name, configs, created_at, updated_at) VALUES (?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP)`,
+                    [config_name, JSON.stringify(merged)]);
+                userDbConn.run("INSERT OR REPLACE INTO user_config_profile_hashes (config_name, hashes) VALUES (?, ?)",
+                    [config_name, JSON.stringify(sectionHashes)], (err) => {
+                        if (err) {
+                            return res.status(500).json({ success: false, error: '上传配置失败: ' + err.message });
+                        }
+                        res.json({ success: true, message: '配置上传成功', config_name: config_name, sectionHashes: sectionHashes });
+                    });
+            });
         });
+    });
 });
 
 // 工作日志自动同步 - 上传/同步工作日志（跟随账号）
@@ -1409,6 +1528,23 @@ app.post('/api/config/tasks/sync', authenticateToken, (req, res) => {
     });
 });
 
+// user_tasks 的一行转换为客户端使用的任务格式，seq 为服务器分配的修改序号
+function taskRowToJson(row) {
+    return {
+        id: row.task_id,
+        title: row.title,
+        description: row.description,
+        categoryId: row.category_id,
+        priority: row.priority,
+        status: row.status,
+        workDuration: row.work_duration,
+        completionTime: row.completion_time,
+        tags: JSON.parse(row.tags || '[]'),
+        updatedAt: row.updated_at,
+        seq: row.id
+    };
+}
+
 // 获取工作日志（跟随账号）
 app.get('/api/config/tasks/get', authenticateToken, (req, res) => {
     const userDbConn = userDb.getUserDb(req.userId);
@@ -1419,20 +1555,10 @@ app.get('/api/config/tasks/get', authenticateToken, (req, res) => {
         }
 
         // 转换为前端需要的格式
-        const tasks = rows.map(row => ({
-            id: row.task_id,
-            title: row.title,
-            description: row.description,
-            categoryId: row.category_id,
-            priority: row.priority,
-            status: row.status,
-            workDuration: row.work_duration,
-            completionTime: row.completion_time,
-            tags: JSON.parse(row.tags || '[]'),
-            updatedAt: row.updated_at
-        }));
-
-        res.json({ success: true, tasks: tasks });
+        const tasks = rows.map(taskRowToJson);
+        const cursor = rows.reduce((max, row) => Math.max(max, row.id), 0);
+
+        res.json({ success: true, tasks: tasks, cursor: cursor });
     });
 });
 
@@ -1483,41 +1609,43 @@ app.post('/api/config/tasks/incremental', authenticateToken, (req, res) => {
 });
 
 // 增量同步：下载任务
+// user_tasks 以 INSERT OR REPLACE 写入，每次写入都会得到新的自增行号，行号即服务器分配的修改序号。
+// 客户端传入上次收到的 cursor（sinceSeq），只返回之后写入的任务；与客户端的时钟和 updatedAt 无关，
+// 其他设备离线修改后补传的任务同样会被下载。未传 sinceSeq 的旧客户端仍按 updated_at 筛选
 app.get('/api/config/tasks/incremental', authenticateToken, (req, res) => {
     const lastSyncTime = req.query.lastSyncTime;
+    const sinceSeq = parseInt(req.query.sinceSeq, 10);
 
     const userDbConn = userDb.getUserDb(req.userId);
 
-    // 只获取上次同步时间之后修改的任务
-    let query = "SELECT * FROM user_tasks";
-    let params = [];
-
-    if (lastSyncTime) {
-        query += " WHERE updated_at > ?";
-        params.push(lastSyncTime);
-    }
-
-    query += " ORDER BY updated_at DESC";
-
-    userDbConn.all(query, params, (err, rows) => {
+    // 先取当前最大序号作为本次的 cursor，查询只返回不超过它的任务，期间新写入的留给下一次
+    userDbConn.get("SELECT COALESCE(MAX(id), 0) AS maxSeq FROM user_tasks", [], (err, seqRow) => {
         if (err) {
             return res.status(500).json({ success: false, error: '获取工作日志失败: ' + err.message });
         }
 
-        const tasks = rows.map(row => ({
-            id: row.task_id,
-            title: row.title,
-            description: row.description,
-            categoryId: row.category_id,
-            priority: row.priority,
-            status: row.status,
-            workDuration: row.work_duration,
-            completionTime: row.completion_time,
-            tags: JSON.parse(row.tags || '[]'),
-            updatedAt: row.updated_at
-        }));
-
-        res.json({ success: true, tasks: tasks });
+        const cursor = seqRow.maxSeq;
+        let query = "SELECT * FROM user_tasks WHERE id <= ?";
+        let params = [cursor];
+
+        if (!isNaN(sinceSeq)) {
+            query += " AND id > ? ORDER BY id";
+            params.push(sinceSeq);
+        } else {
+            if (lastSyncTime) {
+                query += " AND updated_at > ?";
+                params.push(lastSyncTime);
+            }
+            query += " ORDER BY updated_at DESC";
+        }
+
+        userDbConn.all(query, params, (err, rows) => {
+            if (err) {
+                return res.status(500).json({ success: false, error: '获取工作日志失败: ' + err.message });
+            }
+
+            res.json({ success: true, tasks: rows.map(taskRowToJson), cursor: cursor });
+        });
     });
 });
 
@@ -1533,6 +1661,8 @@ app.delete('/api/config/:key', authenticateToken, (req, res) => {
             return res.status(500).json({ success: false, error: '删除配置失败' });
         }
 
+        userDbConn.run("DELETE FROM user_config_hashes WHERE key = ?", [key]);
+
         res.json({ success: true, message: '配置删除成功' });
     });
 });
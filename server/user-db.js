@@ -55,6 +55,17 @@ function getUserDb(userId) {
             updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
         )`);
 
+        // 配置分段的内容哈希（由客户端计算），用于判断未修改的段
+        userDb.run(`CREATE TABLE IF NOT EXISTS user_config_hashes (
+            key TEXT PRIMARY KEY,
+            hash TEXT NOT NULL
+        )`);
+
+        userDb.run(`CREATE TABLE IF NOT EXISTS user_config_profile_hashes (
+            config_name TEXT PRIMARY KEY,
+            hashes TEXT NOT NULL
+        )`);
+
         // 工作日志自动同步表（跟随账号）
         userDb.run(`CREATE TABLE IF NOT EXISTS user_tasks (
             id INTEGER PRIMARY KEY AUTOINCREMENT,